@@ -37,14 +37,49 @@ extern const unsigned char version_string[];
 }  // namespace graphics
 }  // namespace shotamatsuda
 
+#include "shotamatsuda/graphics/arena_resource.h"
+#include "shotamatsuda/graphics/cache.h"
 #include "shotamatsuda/graphics/channel.h"
 #include "shotamatsuda/graphics/color.h"
 #include "shotamatsuda/graphics/depth.h"
+#include "shotamatsuda/graphics/fill_rule.h"
+#include "shotamatsuda/graphics/hash.h"
+#include "shotamatsuda/graphics/linear_gradient.h"
+#include "shotamatsuda/graphics/memory_resource.h"
+#include "shotamatsuda/graphics/pack.h"
 #include "shotamatsuda/graphics/conic.h"
+#include "shotamatsuda/graphics/conic_packet.h"
+#include "shotamatsuda/graphics/conic_subdivider.h"
+#include "shotamatsuda/graphics/coverage.h"
+#include "shotamatsuda/graphics/coverage_spans.h"
 #include "shotamatsuda/graphics/command.h"
 #include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/command_view.h"
+#include "shotamatsuda/graphics/curve_bounds.h"
+#include "shotamatsuda/graphics/curve_measure.h"
+#include "shotamatsuda/graphics/curve_stepper.h"
+#include "shotamatsuda/graphics/dasher.h"
+#include "shotamatsuda/graphics/flattener.h"
+#include "shotamatsuda/graphics/flattening_iterator.h"
+#include "shotamatsuda/graphics/painter.h"
 #include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/path_iterator.h"
+#include "shotamatsuda/graphics/path_measure.h"
+#include "shotamatsuda/graphics/path_normalization.h"
+#include "shotamatsuda/graphics/path_pool.h"
+#include "shotamatsuda/graphics/point_bounds.h"
+#include "shotamatsuda/graphics/polylines.h"
+#include "shotamatsuda/graphics/polymorphic_allocator.h"
+#include "shotamatsuda/graphics/rasterizer.h"
+#include "shotamatsuda/graphics/reversed_path_view.h"
 #include "shotamatsuda/graphics/path_direction.h"
+#include "shotamatsuda/graphics/segment_index.h"
 #include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/graphics/simd.h"
+#include "shotamatsuda/graphics/stroke_cap.h"
+#include "shotamatsuda/graphics/stroke_join.h"
+#include "shotamatsuda/graphics/stroker.h"
+#include "shotamatsuda/graphics/thread_pool.h"
+#include "shotamatsuda/graphics/tiled_rasterizer.h"
 
 #endif  // SHOTA_GRAPHICS_H_
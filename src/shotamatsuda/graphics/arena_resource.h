@@ -0,0 +1,187 @@
+//
+//  shotamatsuda/graphics/arena_resource.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_ARENA_RESOURCE_H_
+#define SHOTA_GRAPHICS_ARENA_RESOURCE_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "shotamatsuda/graphics/memory_resource.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+// A bump allocator for scratch geometry. Deallocation is a no-op, and reset()
+// reclaims every allocation at once while keeping the memory for reuse, so a
+// per-frame shape costs no heap allocations once the arena has warmed up.
+// Objects allocated from an arena must be destroyed before it is reset, and an
+// arena must not be shared between threads.
+class ArenaResource final : public MemoryResource {
+ public:
+  explicit ArenaResource(std::size_t initial_size = 64 * 1024,
+                         MemoryResource *upstream = defaultResource());
+  ~ArenaResource() override;
+
+  // Disallow copy semantics
+  ArenaResource(const ArenaResource&) = delete;
+  ArenaResource& operator=(const ArenaResource&) = delete;
+
+  // Mutators
+  void reset();
+  void release();
+
+  // Attributes
+  std::size_t capacity() const;
+  std::size_t size() const { return size_; }
+  MemoryResource * upstream() const { return upstream_; }
+
+ protected:
+  void * doAllocate(std::size_t size, std::size_t alignment) override;
+  void doDeallocate(void *pointer,
+                    std::size_t size,
+                    std::size_t alignment) override {}
+  bool doIsEqual(const MemoryResource& other) const override {
+    return this == &other;
+  }
+
+ private:
+  struct Chunk {
+    Chunk *next;
+    std::size_t size;
+  };
+
+  void allocateChunk(std::size_t size);
+  void deallocateChunks();
+
+ private:
+  MemoryResource *upstream_;
+  std::size_t initial_size_;
+  std::size_t size_;
+  Chunk *chunks_;
+  char *current_;
+  char *end_;
+};
+
+#pragma mark -
+
+inline ArenaResource::ArenaResource(std::size_t initial_size,
+                                    MemoryResource *upstream)
+    : upstream_(upstream),
+      initial_size_(std::max<std::size_t>(initial_size, 1)),
+      size_(),
+      chunks_(),
+      current_(),
+      end_() {
+  assert(upstream_);
+}
+
+inline ArenaResource::~ArenaResource() {
+  deallocateChunks();
+}
+
+#pragma mark Mutators
+
+inline void ArenaResource::reset() {
+  // Coalesce the chunks used by the last cycle into a single chunk, so that
+  // the next cycle of the same size is served without touching upstream.
+  if (chunks_ && chunks_->next) {
+    const auto total = capacity();
+    deallocateChunks();
+    allocateChunk(total);
+  } else if (chunks_) {
+    current_ = reinterpret_cast<char *>(chunks_ + 1);
+  }
+  size_ = 0;
+}
+
+inline void ArenaResource::release() {
+  deallocateChunks();
+  size_ = 0;
+}
+
+#pragma mark Attributes
+
+inline std::size_t ArenaResource::capacity() const {
+  std::size_t result{};
+  for (auto chunk = chunks_; chunk; chunk = chunk->next) {
+    result += chunk->size;
+  }
+  return result;
+}
+
+#pragma mark Allocation
+
+inline void * ArenaResource::doAllocate(std::size_t size,
+                                        std::size_t alignment) {
+  assert(alignment && !(alignment & (alignment - 1)));
+  auto address = reinterpret_cast<std::uintptr_t>(current_);
+  auto aligned = (address + alignment - 1) & ~(alignment - 1);
+  if (!current_ || aligned + size > reinterpret_cast<std::uintptr_t>(end_)) {
+    const auto previous = chunks_ ? chunks_->size : initial_size_ / 2;
+    allocateChunk(std::max(previous * 2, size + alignment));
+    address = reinterpret_cast<std::uintptr_t>(current_);
+    aligned = (address + alignment - 1) & ~(alignment - 1);
+  }
+  current_ = reinterpret_cast<char *>(aligned + size);
+  size_ += size;
+  return reinterpret_cast<void *>(aligned);
+}
+
+inline void ArenaResource::allocateChunk(std::size_t size) {
+  const auto bytes = sizeof(Chunk) + size;
+  const auto chunk = static_cast<Chunk *>(
+      upstream_->allocate(bytes, alignof(std::max_align_t)));
+  chunk->next = chunks_;
+  chunk->size = size;
+  chunks_ = chunk;
+  current_ = reinterpret_cast<char *>(chunk + 1);
+  end_ = current_ + size;
+}
+
+inline void ArenaResource::deallocateChunks() {
+  while (chunks_) {
+    const auto next = chunks_->next;
+    upstream_->deallocate(chunks_, sizeof(Chunk) + chunks_->size,
+                          alignof(std::max_align_t));
+    chunks_ = next;
+  }
+  current_ = nullptr;
+  end_ = nullptr;
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::ArenaResource;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_ARENA_RESOURCE_H_
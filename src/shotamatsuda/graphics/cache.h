@@ -0,0 +1,138 @@
+//
+//  shotamatsuda/graphics/cache.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_CACHE_H_
+#define SHOTA_GRAPHICS_CACHE_H_
+
+#include <atomic>
+
+namespace shotamatsuda {
+namespace graphics {
+
+// Holds a lazily computed value. Const accessors may fill the cache from
+// several threads at once: each computes the value, the first to finish
+// stores it, and later calls return the stored value. Setting or resetting
+// the cache requires exclusive access, as any other mutation does.
+template <class T>
+class Cache final {
+ public:
+  using Type = T;
+
+ public:
+  Cache();
+
+  // Copy semantics
+  Cache(const Cache& other);
+  Cache& operator=(const Cache& other);
+
+  // Accessing the value
+  template <class Function>
+  T get(Function function) const;
+  const T * find() const;
+  void set(const T& value);
+  void reset();
+
+ private:
+  enum class State { INVALID, BUSY, VALID };
+
+ private:
+  mutable std::atomic<State> state_;
+  mutable T value_;
+};
+
+#pragma mark -
+
+template <class T>
+inline Cache<T>::Cache() : state_(State::INVALID), value_() {}
+
+template <class T>
+inline Cache<T>::Cache(const Cache& other)
+    : state_(State::INVALID),
+      value_() {
+  if (const auto value = other.find()) {
+    set(*value);
+  }
+}
+
+template <class T>
+inline Cache<T>& Cache<T>::operator=(const Cache& other) {
+  if (&other != this) {
+    if (const auto value = other.find()) {
+      set(*value);
+    } else {
+      reset();
+    }
+  }
+  return *this;
+}
+
+#pragma mark Accessing the value
+
+template <class T>
+template <class Function>
+inline T Cache<T>::get(Function function) const {
+  if (const auto value = find()) {
+    return *value;
+  }
+  const T value = function();
+  auto expected = State::INVALID;
+  if (state_.compare_exchange_strong(expected, State::BUSY,
+                                     std::memory_order_acquire)) {
+    value_ = value;
+    state_.store(State::VALID, std::memory_order_release);
+  }
+  return value;
+}
+
+template <class T>
+inline const T * Cache<T>::find() const {
+  if (state_.load(std::memory_order_acquire) == State::VALID) {
+    return &value_;
+  }
+  return nullptr;
+}
+
+template <class T>
+inline void Cache<T>::set(const T& value) {
+  value_ = value;
+  state_.store(State::VALID, std::memory_order_release);
+}
+
+template <class T>
+inline void Cache<T>::reset() {
+  state_.store(State::INVALID, std::memory_order_relaxed);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::Cache;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_CACHE_H_
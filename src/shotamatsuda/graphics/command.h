@@ -29,9 +29,12 @@
 #define SHOTA_GRAPHICS_COMMAND_H_
 
 #include <cassert>
+#include <cstddef>
+#include <functional>
 #include <ostream>
 
 #include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/hash.h"
 #include "shotamatsuda/math/promotion.h"
 #include "shotamatsuda/math/vector.h"
 
@@ -61,6 +64,10 @@ class Command final {
   Command(const Command&) = default;
   Command& operator=(const Command&) = default;
 
+  // Move semantics
+  Command(Command&&) = default;
+  Command& operator=(Command&&) = default;
+
   // Properties
   const CommandType& type() const { return type_; }
   CommandType& type() { return type_; }
@@ -70,8 +77,8 @@ class Command final {
   Vec2<T>& control1() { return control1_; }
   const Vec2<T>& control2() const { return control2_; }
   Vec2<T>& control2() { return control2_; }
-  const T& weight() const { return weight_; }
-  T& weight() { return weight_; }
+  const math::Promote<T>& weight() const { return weight_; }
+  math::Promote<T>& weight() { return weight_; }
   const Vec2<T>& point() const { return point_; }
   Vec2<T>& point() { return point_; }
 
@@ -198,4 +205,23 @@ namespace gfx = graphics;
 
 }  // namespace shotamatsuda
 
+namespace std {
+
+template <class T, int D>
+struct hash<shotamatsuda::graphics::Command<T, D>> {
+  std::size_t operator()(
+      const shotamatsuda::graphics::Command<T, D>& command) const {
+    using shotamatsuda::graphics::hashCombine;
+    std::size_t seed{};
+    hashCombine(seed, command.type());
+    hashCombine(seed, command.control1());
+    hashCombine(seed, command.control2());
+    hashCombine(seed, command.weight());
+    hashCombine(seed, command.point());
+    return seed;
+  }
+};
+
+}  // namespace std
+
 #endif  // SHOTA_GRAPHICS_COMMAND_H_
@@ -29,12 +29,14 @@
 #define SHOTA_GRAPHICS_COMMAND_TYPE_H_
 
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <ostream>
 
 namespace shotamatsuda {
 namespace graphics {
 
-enum class CommandType {
+enum class CommandType : std::uint8_t {
   MOVE,
   LINE,
   QUADRATIC,
@@ -43,6 +45,27 @@ enum class CommandType {
   CLOSE
 };
 
+// Returns the number of points a command of the given type stores, including
+// its end point.
+inline std::size_t pointCount(CommandType type) {
+  switch (type) {
+    case CommandType::MOVE:
+    case CommandType::LINE:
+      return 1;
+    case CommandType::QUADRATIC:
+    case CommandType::CONIC:
+      return 2;
+    case CommandType::CUBIC:
+      return 3;
+    case CommandType::CLOSE:
+      return 0;
+    default:
+      assert(false);
+      break;
+  }
+  return 0;
+}
+
 inline std::ostream& operator<<(std::ostream& os, CommandType type) {
   switch (type) {
     case CommandType::MOVE: os << "move"; break;
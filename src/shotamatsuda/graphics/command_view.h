@@ -0,0 +1,204 @@
+//
+//  shotamatsuda/graphics/command_view.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_COMMAND_VIEW_H_
+#define SHOTA_GRAPHICS_COMMAND_VIEW_H_
+
+#include <cassert>
+#include <cstddef>
+#include <ostream>
+
+#include "shotamatsuda/graphics/command.h"
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+// A non-owning, read-only view of a command packed into a path's arrays. It
+// refers to exactly the points its type consumes, and to a weight only when
+// it is a conic. Views are invalidated by any mutation of the path.
+template <class T, int D>
+class CommandView final {
+ public:
+  using Type = T;
+  static constexpr const int dimensions = D;
+
+ public:
+  CommandView(CommandType type,
+              const Vec2<T> *points,
+              const math::Promote<T> *weight = nullptr);
+
+  // Copy semantics
+  CommandView(const CommandView&) = default;
+  CommandView& operator=(const CommandView&) = default;
+
+  // Move semantics
+  CommandView(CommandView&&) = default;
+  CommandView& operator=(CommandView&&) = default;
+
+  // Conversion
+  operator Command<T, D>() const;
+
+  // Properties
+  CommandType type() const { return type_; }
+  const Vec2<T>& control() const;
+  const Vec2<T>& control1() const;
+  const Vec2<T>& control2() const;
+  math::Promote<T> weight() const { return weight_ ? *weight_ : 0; }
+  const Vec2<T>& point() const;
+  const Vec2<T> * points() const { return points_; }
+
+  // Allows an iterator to return a view from operator->
+  const CommandView * operator->() const { return this; }
+
+ private:
+  CommandType type_;
+  const Vec2<T> *points_;
+  const math::Promote<T> *weight_;
+};
+
+// Comparison
+template <class T, class U, int D>
+bool operator==(const CommandView<T, D>& lhs, const CommandView<U, D>& rhs);
+template <class T, class U, int D>
+bool operator!=(const CommandView<T, D>& lhs, const CommandView<U, D>& rhs);
+
+template <class T>
+using CommandView2 = CommandView<T, 2>;
+
+#pragma mark -
+
+template <class T, int D>
+inline CommandView<T, D>::CommandView(CommandType type,
+                                      const Vec2<T> *points,
+                                      const math::Promote<T> *weight)
+    : type_(type),
+      points_(points),
+      weight_(weight) {
+  assert(points_ || type_ == CommandType::CLOSE);
+  assert(weight_ || type_ != CommandType::CONIC);
+}
+
+#pragma mark Conversion
+
+template <class T, int D>
+inline CommandView<T, D>::operator Command<T, D>() const {
+  switch (type_) {
+    case CommandType::MOVE:
+    case CommandType::LINE:
+      return Command<T, D>(type_, points_[0]);
+    case CommandType::QUADRATIC:
+      return Command<T, D>(type_, points_[0], points_[1]);
+    case CommandType::CONIC:
+      return Command<T, D>(type_, points_[0], points_[1], *weight_);
+    case CommandType::CUBIC:
+      return Command<T, D>(type_, points_[0], points_[1], points_[2]);
+    case CommandType::CLOSE:
+      break;
+    default:
+      assert(false);
+      break;
+  }
+  return Command<T, D>(type_);
+}
+
+#pragma mark Properties
+
+template <class T, int D>
+inline const Vec2<T>& CommandView<T, D>::control() const {
+  assert(type_ == CommandType::QUADRATIC || type_ == CommandType::CONIC);
+  return points_[0];
+}
+
+template <class T, int D>
+inline const Vec2<T>& CommandView<T, D>::control1() const {
+  assert(pointCount(type_) > 1);
+  return points_[0];
+}
+
+template <class T, int D>
+inline const Vec2<T>& CommandView<T, D>::control2() const {
+  assert(type_ == CommandType::CUBIC);
+  return points_[1];
+}
+
+template <class T, int D>
+inline const Vec2<T>& CommandView<T, D>::point() const {
+  // A close consumes no points. Yield the zero point that Command holds for
+  // it, rather than reading outside of the command.
+  if (type_ == CommandType::CLOSE) {
+    static const Vec2<T> zero;
+    return zero;
+  }
+  return points_[pointCount(type_) - 1];
+}
+
+#pragma mark Comparison
+
+template <class T, class U, int D>
+inline bool operator==(const CommandView<T, D>& lhs,
+                       const CommandView<U, D>& rhs) {
+  if (lhs.type() != rhs.type()) {
+    return false;
+  }
+  if (lhs.type() == CommandType::CONIC && lhs.weight() != rhs.weight()) {
+    return false;
+  }
+  for (std::size_t i{}; i < pointCount(lhs.type()); ++i) {
+    if (lhs.points()[i] != rhs.points()[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class T, class U, int D>
+inline bool operator!=(const CommandView<T, D>& lhs,
+                       const CommandView<U, D>& rhs) {
+  return !(lhs == rhs);
+}
+
+#pragma mark Stream
+
+template <class T, int D>
+inline std::ostream& operator<<(std::ostream& os,
+                                const CommandView<T, D>& other) {
+  return os << static_cast<Command<T, D>>(other);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::CommandView;
+using graphics::CommandView2;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_COMMAND_VIEW_H_
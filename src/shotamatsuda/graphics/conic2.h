@@ -36,10 +36,13 @@
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <functional>
 #include <iterator>
 #include <utility>
 #include <vector>
 
+#include "shotamatsuda/graphics/hash.h"
 #include "shotamatsuda/math/promotion.h"
 #include "shotamatsuda/math/vector.h"
 
@@ -60,6 +63,7 @@ class Conic<T, 2> final {
   using Type = T;
   using Point = Vec2<T>;
   static constexpr const int dimensions = 2;
+  static constexpr const unsigned int max_subdivision = 5;
 
  public:
   Conic();
@@ -72,12 +76,16 @@ class Conic<T, 2> final {
   Conic(const Conic&) = default;
   Conic& operator=(const Conic&) = default;
 
+  // Move semantics
+  Conic(Conic&&) = default;
+  Conic& operator=(Conic&&) = default;
+
   // Subdivision
   std::vector<Point> quadratics() const;
   std::vector<Point> quadratics(math::Promote<T> tolerance) const;
-
- private:
-  std::vector<Point> subdivide(unsigned int level) const;
+  unsigned int subdivision(math::Promote<T> tolerance) const;
+  template <class OutputIterator>
+  OutputIterator subdivide(unsigned int level, OutputIterator result) const;
   std::pair<Conic, Conic> chop() const;
 
  public:
@@ -98,6 +106,9 @@ bool operator==(const Conic2<T>& lhs, const Conic2<U>& rhs);
 template <class T, class U>
 bool operator!=(const Conic2<T>& lhs, const Conic2<U>& rhs);
 
+template <class T>
+constexpr const unsigned int Conic<T, 2>::max_subdivision;
+
 using Conic2i = Conic2<int>;
 using Conic2f = Conic2<float>;
 using Conic2d = Conic2<double>;
@@ -131,39 +142,70 @@ inline bool operator!=(const Conic2<T>& lhs, const Conic2<U>& rhs) {
 
 template <class T>
 inline std::vector<Vec2<T>> Conic<T, 2>::quadratics() const {
-  return subdivide(1);
+  std::vector<Vec2<T>> result(4);
+  subdivide(1, std::begin(result));
+  return result;
 }
 
 template <class T>
 inline std::vector<Vec2<T>> Conic<T, 2>::quadratics(
     math::Promote<T> tolerance) const {
-  unsigned int subdivision{};
-  if (tolerance >= 0) {
-    static const unsigned int max_subdivision = 5;
-    const auto k = (weight - 1) / (4 * (weight + 1));
-    const auto x = k * (a.x - 2 * b.x + c.x);
-    const auto y = k * (a.y - 2 * b.y + c.y);
-    auto error = std::sqrt(x * x + y * y);
-    for (; subdivision < max_subdivision && error > tolerance; ++subdivision) {
-      error *= 0.25;
-    }
+  const auto level = subdivision(tolerance);
+  std::vector<Vec2<T>> result(std::size_t(2) << level);
+  subdivide(level, std::begin(result));
+  return result;
+}
+
+template <class T>
+inline unsigned int Conic<T, 2>::subdivision(
+    math::Promote<T> tolerance) const {
+  if (tolerance < 0) {
+    return 0;
+  }
+  const auto k = (weight - 1) / (4 * (weight + 1));
+  const auto x = k * (a.x - 2 * b.x + c.x);
+  const auto y = k * (a.y - 2 * b.y + c.y);
+  const auto error = std::sqrt(x * x + y * y);
+  if (!(error > tolerance)) {
+    return 0;
   }
-  return subdivide(subdivision);
+  // Each subdivision divides the error by 4, so the level is the ceiling of
+  // log4(error / tolerance), which is read off the binary exponent.
+  const auto ratio = error / tolerance;
+  if (!std::isfinite(ratio)) {
+    return max_subdivision;
+  }
+  int exponent;
+  const auto mantissa = std::frexp(ratio, &exponent);
+  if (mantissa == 0.5) {
+    --exponent;
+  }
+  return std::min((static_cast<unsigned int>(exponent) + 1) / 2,
+                  max_subdivision);
 }
 
 template <class T>
-inline std::vector<Vec2<T>> Conic<T, 2>::subdivide(unsigned int level) const {
-  if (level) {
-    const auto pair = chop();
-    const auto first = pair.first.subdivide(--level);
-    const auto second = pair.second.subdivide(level);
-    std::vector<Vec2<T>> result;
-    std::move(std::begin(first), std::end(first), std::back_inserter(result));
-    std::move(std::begin(second), std::end(second), std::back_inserter(result));
-    return std::move(result);
-  } else {
-    return std::vector<Vec2<T>>{b, c};
+template <class OutputIterator>
+inline OutputIterator Conic<T, 2>::subdivide(unsigned int level,
+                                             OutputIterator result) const {
+  // Walk the subdivision tree depth first with an explicit stack, which
+  // never holds more than one conic per level plus the one being split.
+  level = std::min(level, max_subdivision);
+  std::array<std::pair<Conic, unsigned int>, max_subdivision + 1> stack;
+  auto top = std::begin(stack);
+  *top++ = std::make_pair(*this, level);
+  while (top != std::begin(stack)) {
+    const auto entry = *--top;
+    if (entry.second) {
+      const auto pair = entry.first.chop();
+      *top++ = std::make_pair(pair.second, entry.second - 1);
+      *top++ = std::make_pair(pair.first, entry.second - 1);
+    } else {
+      *result++ = entry.first.b;
+      *result++ = entry.first.c;
+    }
   }
+  return result;
 }
 
 template <class T>
@@ -188,4 +230,19 @@ using graphics::Conic2d;
 
 }  // namespace shotamatsuda
 
+namespace std {
+
+template <class T>
+struct hash<shotamatsuda::graphics::Conic2<T>> {
+  std::size_t operator()(const shotamatsuda::graphics::Conic2<T>& conic) const {
+    using shotamatsuda::graphics::hashCombine;
+    std::size_t seed{};
+    hashCombine(seed, std::begin(conic.points), std::end(conic.points));
+    hashCombine(seed, conic.weight);
+    return seed;
+  }
+};
+
+}  // namespace std
+
 #endif  // SHOTA_GRAPHICS_CONIC2_H_
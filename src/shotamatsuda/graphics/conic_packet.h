@@ -0,0 +1,209 @@
+//
+//  shotamatsuda/graphics/conic_packet.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_CONIC_PACKET_H_
+#define SHOTA_GRAPHICS_CONIC_PACKET_H_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+#include "shotamatsuda/graphics/conic.h"
+#include "shotamatsuda/graphics/pack.h"
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class ConicPacket;
+
+template <class T>
+using ConicPacket2 = ConicPacket<T, 2>;
+
+// Holds as many conics as a Pack has lanes, one array per coordinate, and
+// subdivides all of them at once to the same level. Every chop of the packet
+// takes a single vector square root for all of its lanes. The arithmetic is
+// done in the promoted type, so integer conics are rounded only on output.
+template <class T>
+class ConicPacket<T, 2> final {
+ public:
+  using Type = T;
+  using Scalar = math::Promote<T>;
+  static constexpr const int dimensions = 2;
+  static constexpr const std::size_t size = Pack<Scalar>::size;
+
+ public:
+  ConicPacket();
+
+  // Copy semantics
+  ConicPacket(const ConicPacket&) = default;
+  ConicPacket& operator=(const ConicPacket&) = default;
+
+  // Lanes
+  void set(std::size_t lane, const Conic2<T>& conic);
+
+  // Subdivision
+  void subdivide(unsigned int level,
+                 Vec2<T> *const *outputs,
+                 std::size_t count) const;
+
+ private:
+  struct Lanes {
+    Pack<Scalar> ax;
+    Pack<Scalar> ay;
+    Pack<Scalar> bx;
+    Pack<Scalar> by;
+    Pack<Scalar> cx;
+    Pack<Scalar> cy;
+    Pack<Scalar> weight;
+  };
+
+  static std::pair<Lanes, Lanes> chop(const Lanes& lanes);
+
+ private:
+  Scalar ax_[size];
+  Scalar ay_[size];
+  Scalar bx_[size];
+  Scalar by_[size];
+  Scalar cx_[size];
+  Scalar cy_[size];
+  Scalar weight_[size];
+};
+
+using ConicPacket2f = ConicPacket2<float>;
+using ConicPacket2d = ConicPacket2<double>;
+
+#pragma mark -
+
+template <class T>
+inline ConicPacket<T, 2>::ConicPacket() {
+  std::fill(std::begin(ax_), std::end(ax_), Scalar());
+  std::fill(std::begin(ay_), std::end(ay_), Scalar());
+  std::fill(std::begin(bx_), std::end(bx_), Scalar());
+  std::fill(std::begin(by_), std::end(by_), Scalar());
+  std::fill(std::begin(cx_), std::end(cx_), Scalar());
+  std::fill(std::begin(cy_), std::end(cy_), Scalar());
+  std::fill(std::begin(weight_), std::end(weight_), Scalar(1));
+}
+
+#pragma mark Lanes
+
+template <class T>
+inline void ConicPacket<T, 2>::set(std::size_t lane, const Conic2<T>& conic) {
+  assert(lane < size);
+  ax_[lane] = conic.a.x;
+  ay_[lane] = conic.a.y;
+  bx_[lane] = conic.b.x;
+  by_[lane] = conic.b.y;
+  cx_[lane] = conic.c.x;
+  cy_[lane] = conic.c.y;
+  weight_[lane] = conic.weight;
+}
+
+#pragma mark Subdivision
+
+template <class T>
+inline void ConicPacket<T, 2>::subdivide(unsigned int level,
+                                         Vec2<T> *const *outputs,
+                                         std::size_t count) const {
+  assert(count <= size);
+  static constexpr const auto max_subdivision = Conic2<T>::max_subdivision;
+  level = std::min(level, max_subdivision);
+
+  // Walk the subdivision tree depth first as Conic2::subdivide does, with the
+  // lanes in lockstep, so that every lane writes to the same offset.
+  using P = Pack<Scalar>;
+  std::array<std::pair<Lanes, unsigned int>, max_subdivision + 1> stack;
+  auto top = std::begin(stack);
+  *top++ = std::make_pair(Lanes{P::load(ax_), P::load(ay_),
+                                P::load(bx_), P::load(by_),
+                                P::load(cx_), P::load(cy_),
+                                P::load(weight_)}, level);
+  Scalar bx[size];
+  Scalar by[size];
+  Scalar cx[size];
+  Scalar cy[size];
+  std::size_t offset{};
+  while (top != std::begin(stack)) {
+    const auto entry = *--top;
+    if (entry.second) {
+      const auto pair = chop(entry.first);
+      *top++ = std::make_pair(pair.second, entry.second - 1);
+      *top++ = std::make_pair(pair.first, entry.second - 1);
+      continue;
+    }
+    entry.first.bx.store(bx);
+    entry.first.by.store(by);
+    entry.first.cx.store(cx);
+    entry.first.cy.store(cy);
+    for (std::size_t lane{}; lane < count; ++lane) {
+      auto output = outputs[lane] + offset;
+      output[0] = Vec2<T>(static_cast<T>(bx[lane]), static_cast<T>(by[lane]));
+      output[1] = Vec2<T>(static_cast<T>(cx[lane]), static_cast<T>(cy[lane]));
+    }
+    offset += 2;
+  }
+}
+
+template <class T>
+inline std::pair<typename ConicPacket<T, 2>::Lanes,
+                 typename ConicPacket<T, 2>::Lanes>
+ConicPacket<T, 2>::chop(const Lanes& lanes) {
+  using P = Pack<Scalar>;
+  const auto one = P(1);
+  const auto half = P(0.5);
+  const auto scale = one / (one + lanes.weight);
+  const auto weight = sqrt((one + lanes.weight) * half);
+  const auto wbx = lanes.weight * lanes.bx;
+  const auto wby = lanes.weight * lanes.by;
+  const auto mx = (lanes.ax + wbx + wbx + lanes.cx) * scale * half;
+  const auto my = (lanes.ay + wby + wby + lanes.cy) * scale * half;
+  return std::make_pair(
+      Lanes{lanes.ax, lanes.ay,
+            (lanes.ax + wbx) * scale, (lanes.ay + wby) * scale,
+            mx, my, weight},
+      Lanes{mx, my,
+            (wbx + lanes.cx) * scale, (wby + lanes.cy) * scale,
+            lanes.cx, lanes.cy, weight});
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::ConicPacket;
+using graphics::ConicPacket2;
+using graphics::ConicPacket2f;
+using graphics::ConicPacket2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_CONIC_PACKET_H_
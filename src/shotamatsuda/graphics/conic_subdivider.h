@@ -0,0 +1,137 @@
+//
+//  shotamatsuda/graphics/conic_subdivider.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_CONIC_SUBDIVIDER_H_
+#define SHOTA_GRAPHICS_CONIC_SUBDIVIDER_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "shotamatsuda/graphics/conic.h"
+#include "shotamatsuda/graphics/conic_packet.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class ConicSubdivider;
+
+template <class T>
+using ConicSubdivider2 = ConicSubdivider<T, 2>;
+
+// Buckets conics by subdivision level into packets, and subdivides a packet
+// as soon as it fills up. Each conic writes its quadratics to the output it
+// was added with, which must stay valid until the conic has been written,
+// that is until the next flush at the latest. The destructor flushes any
+// conics that remain.
+template <class T>
+class ConicSubdivider<T, 2> final {
+ public:
+  using Type = T;
+  static constexpr const int dimensions = 2;
+
+ public:
+  ConicSubdivider();
+  ~ConicSubdivider();
+
+  // Disallow copy semantics
+  ConicSubdivider(const ConicSubdivider&) = delete;
+  ConicSubdivider& operator=(const ConicSubdivider&) = delete;
+
+  // Subdivision
+  void add(const Conic2<T>& conic, unsigned int level, Vec2<T> *output);
+  void flush();
+
+ private:
+  struct Bucket {
+    ConicPacket2<T> packet;
+    std::array<Vec2<T> *, ConicPacket2<T>::size> outputs;
+    std::size_t count;
+  };
+
+ private:
+  std::array<Bucket, Conic2<T>::max_subdivision + 1> buckets_;
+};
+
+using ConicSubdivider2f = ConicSubdivider2<float>;
+using ConicSubdivider2d = ConicSubdivider2<double>;
+
+#pragma mark -
+
+template <class T>
+inline ConicSubdivider<T, 2>::ConicSubdivider() {
+  for (auto& bucket : buckets_) {
+    bucket.count = 0;
+  }
+}
+
+template <class T>
+inline ConicSubdivider<T, 2>::~ConicSubdivider() {
+  flush();
+}
+
+#pragma mark Subdivision
+
+template <class T>
+inline void ConicSubdivider<T, 2>::add(const Conic2<T>& conic,
+                                       unsigned int level,
+                                       Vec2<T> *output) {
+  level = std::min<unsigned int>(level, Conic2<T>::max_subdivision);
+  auto& bucket = buckets_[level];
+  bucket.packet.set(bucket.count, conic);
+  bucket.outputs[bucket.count] = output;
+  if (++bucket.count == ConicPacket2<T>::size) {
+    bucket.packet.subdivide(level, bucket.outputs.data(), bucket.count);
+    bucket.count = 0;
+  }
+}
+
+template <class T>
+inline void ConicSubdivider<T, 2>::flush() {
+  for (unsigned int level{}; level < buckets_.size(); ++level) {
+    auto& bucket = buckets_[level];
+    if (bucket.count) {
+      bucket.packet.subdivide(level, bucket.outputs.data(), bucket.count);
+      bucket.count = 0;
+    }
+  }
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::ConicSubdivider;
+using graphics::ConicSubdivider2;
+using graphics::ConicSubdivider2f;
+using graphics::ConicSubdivider2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_CONIC_SUBDIVIDER_H_
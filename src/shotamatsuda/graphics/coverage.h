@@ -0,0 +1,144 @@
+//
+//  shotamatsuda/graphics/coverage.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_COVERAGE_H_
+#define SHOTA_GRAPHICS_COVERAGE_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "shotamatsuda/graphics/fill_rule.h"
+#include "shotamatsuda/graphics/simd.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+// Returns the coverage of a pixel whose accumulated signed area is the given
+// one. The even-odd rule folds the area into a triangle wave, which is exact
+// wherever edges do not overlap within a pixel.
+inline float coverage(float area, FillRule rule) {
+  auto result = std::abs(area);
+  if (rule == FillRule::EVEN_ODD) {
+    result -= 2 * std::trunc(result / 2);
+    return 1 - std::abs(1 - result);
+  }
+  return std::min(result, 1.f);
+}
+
+// Sums a row of signed area deltas from the left and writes the 8-bit
+// coverage of each pixel. The prefix sum runs on four pixels at a time where
+// SSE2 or NEON is available, so the result may differ from the scalar sum by
+// rounding.
+inline void accumulateCoverage(const float *areas,
+                               std::size_t size,
+                               FillRule rule,
+                               std::uint8_t *result) {
+  assert((areas && result) || !size);
+  std::size_t i{};
+  float sum{};
+#if SHOTA_HAS_SSE2
+  const auto even_odd = rule == FillRule::EVEN_ODD;
+  const auto zero = _mm_setzero_ps();
+  const auto one = _mm_set1_ps(1);
+  const auto half = _mm_set1_ps(0.5);
+  const auto two = _mm_set1_ps(2);
+  const auto scale = _mm_set1_ps(255);
+  const auto magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  auto offset = zero;
+  for (; i + 4 <= size; i += 4) {
+    auto x = _mm_loadu_ps(areas + i);
+    x = _mm_add_ps(x, _mm_castsi128_ps(
+        _mm_slli_si128(_mm_castps_si128(x), 4)));
+    x = _mm_add_ps(x, _mm_castsi128_ps(
+        _mm_slli_si128(_mm_castps_si128(x), 8)));
+    x = _mm_add_ps(x, offset);
+    offset = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+    auto c = _mm_and_ps(x, magnitude);
+    if (even_odd) {
+      const auto t = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(c, half)));
+      c = _mm_sub_ps(c, _mm_mul_ps(t, two));
+      c = _mm_sub_ps(one, _mm_and_ps(_mm_sub_ps(one, c), magnitude));
+    } else {
+      c = _mm_min_ps(c, one);
+    }
+    auto v = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, scale), half));
+    v = _mm_packs_epi32(v, v);
+    v = _mm_packus_epi16(v, v);
+    const auto bytes = _mm_cvtsi128_si32(v);
+    std::memcpy(result + i, &bytes, 4);
+  }
+  sum = _mm_cvtss_f32(offset);
+#elif SHOTA_HAS_NEON
+  const auto even_odd = rule == FillRule::EVEN_ODD;
+  const auto zero = vdupq_n_f32(0);
+  const auto one = vdupq_n_f32(1);
+  const auto half = vdupq_n_f32(0.5);
+  const auto two = vdupq_n_f32(2);
+  const auto scale = vdupq_n_f32(255);
+  auto offset = zero;
+  for (; i + 4 <= size; i += 4) {
+    auto x = vld1q_f32(areas + i);
+    x = vaddq_f32(x, vextq_f32(zero, x, 3));
+    x = vaddq_f32(x, vextq_f32(zero, x, 2));
+    x = vaddq_f32(x, offset);
+    offset = vdupq_n_f32(vgetq_lane_f32(x, 3));
+    auto c = vabsq_f32(x);
+    if (even_odd) {
+      const auto t = vcvtq_f32_s32(vcvtq_s32_f32(vmulq_f32(c, half)));
+      c = vsubq_f32(c, vmulq_f32(t, two));
+      c = vsubq_f32(one, vabsq_f32(vsubq_f32(one, c)));
+    } else {
+      c = vminq_f32(c, one);
+    }
+    const auto v = vcvtq_u32_f32(vaddq_f32(vmulq_f32(c, scale), half));
+    const auto n = vmovn_u32(v);
+    std::uint8_t bytes[8];
+    vst1_u8(bytes, vmovn_u16(vcombine_u16(n, n)));
+    std::memcpy(result + i, bytes, 4);
+  }
+  sum = vgetq_lane_f32(offset, 0);
+#endif
+  for (; i < size; ++i) {
+    sum += areas[i];
+    result[i] = static_cast<std::uint8_t>(coverage(sum, rule) * 255 + 0.5f);
+  }
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::accumulateCoverage;
+using graphics::coverage;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_COVERAGE_H_
@@ -0,0 +1,235 @@
+//
+//  shotamatsuda/graphics/coverage_spans.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_COVERAGE_SPANS_H_
+#define SHOTA_GRAPHICS_COVERAGE_SPANS_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace shotamatsuda {
+namespace graphics {
+
+// Run-length encoded coverage, stored as the spans of each row in order of x
+// with the offset of the first span of each row. A solid span covers all of
+// its pixels with a single value, while other spans keep one value per pixel
+// in a shared array, so that only the pixels along edges take memory per
+// pixel. Pixels without coverage have no spans. Clearing keeps the capacity,
+// as Polylines does.
+class CoverageSpans final {
+ public:
+  struct Span final {
+    int x;
+    int length;
+    bool solid;
+    std::size_t covers;
+  };
+
+  using Spans = std::vector<Span>;
+  using Covers = std::vector<std::uint8_t>;
+  using Offsets = std::vector<std::size_t>;
+
+  // Runs of equal coverage at least this long are stored as solid spans.
+  static constexpr const int min_solid_length = 4;
+
+ public:
+  CoverageSpans() = default;
+
+  // Copy semantics
+  CoverageSpans(const CoverageSpans&) = default;
+  CoverageSpans& operator=(const CoverageSpans&) = default;
+
+  // Move semantics
+  CoverageSpans(CoverageSpans&&) = default;
+  CoverageSpans& operator=(CoverageSpans&&) = default;
+
+  // Mutators
+  void reserve(std::size_t spans, std::size_t covers, std::size_t rows);
+  void clear();
+
+  // Attributes
+  bool empty() const { return offsets_.empty(); }
+  std::size_t size() const { return offsets_.size(); }
+
+  // Adding spans
+  void addRow();
+  void addSolid(int x, int length, std::uint8_t coverage);
+  void addCovers(int x, const std::uint8_t *covers, int length);
+
+  // Rows
+  const Spans& spans() const { return spans_; }
+  const Covers& covers() const { return covers_; }
+  const Offsets& offsets() const { return offsets_; }
+  const Span * row(std::size_t index) const;
+  std::size_t rowSize(std::size_t index) const;
+  const std::uint8_t * covers(const Span& span) const;
+
+  // Decoding
+  void fill(std::uint8_t *mask, std::ptrdiff_t stride) const;
+
+ private:
+  Span * last();
+  void appendCovers(int x, const std::uint8_t *covers, int length);
+
+ private:
+  Spans spans_;
+  Covers covers_;
+  Offsets offsets_;
+};
+
+#pragma mark -
+
+inline void CoverageSpans::reserve(std::size_t spans,
+                                   std::size_t covers,
+                                   std::size_t rows) {
+  spans_.reserve(spans);
+  covers_.reserve(covers);
+  offsets_.reserve(rows);
+}
+
+inline void CoverageSpans::clear() {
+  spans_.clear();
+  covers_.clear();
+  offsets_.clear();
+}
+
+#pragma mark Adding spans
+
+inline void CoverageSpans::addRow() {
+  offsets_.emplace_back(spans_.size());
+}
+
+// Extends the last span of the row instead when it is solid with the same
+// coverage and ends where this one begins.
+inline void CoverageSpans::addSolid(int x, int length, std::uint8_t coverage) {
+  assert(!empty());
+  if (!coverage || length <= 0) {
+    return;
+  }
+  const auto span = last();
+  if (span && span->solid && span->x + span->length == x &&
+      covers_[span->covers] == coverage) {
+    span->length += length;
+    return;
+  }
+  spans_.push_back({x, length, true, covers_.size()});
+  covers_.emplace_back(coverage);
+}
+
+// Encodes a run of per-pixel coverage, skipping pixels without coverage and
+// storing long runs of equal coverage as solid spans.
+inline void CoverageSpans::addCovers(int x,
+                                     const std::uint8_t *covers,
+                                     int length) {
+  assert(!empty());
+  assert(covers || length <= 0);
+  for (auto i = 0; i < length;) {
+    const auto coverage = covers[i];
+    auto j = i + 1;
+    while (j < length && covers[j] == coverage) {
+      ++j;
+    }
+    if (coverage && j - i >= min_solid_length) {
+      addSolid(x + i, j - i, coverage);
+    } else if (coverage) {
+      appendCovers(x + i, covers + i, j - i);
+    }
+    i = j;
+  }
+}
+
+inline CoverageSpans::Span * CoverageSpans::last() {
+  if (spans_.size() == offsets_.back()) {
+    return nullptr;
+  }
+  return &spans_.back();
+}
+
+inline void CoverageSpans::appendCovers(int x,
+                                        const std::uint8_t *covers,
+                                        int length) {
+  const auto span = last();
+  if (span && !span->solid && span->x + span->length == x) {
+    span->length += length;
+  } else {
+    spans_.push_back({x, length, false, covers_.size()});
+  }
+  covers_.insert(std::end(covers_), covers, covers + length);
+}
+
+#pragma mark Rows
+
+inline const CoverageSpans::Span * CoverageSpans::row(
+    std::size_t index) const {
+  assert(index < size());
+  return spans_.data() + offsets_[index];
+}
+
+inline std::size_t CoverageSpans::rowSize(std::size_t index) const {
+  assert(index < size());
+  const auto end = index + 1 < size() ? offsets_[index + 1] : spans_.size();
+  return end - offsets_[index];
+}
+
+inline const std::uint8_t * CoverageSpans::covers(const Span& span) const {
+  return covers_.data() + span.covers;
+}
+
+#pragma mark Decoding
+
+// Writes the coverage of every span into the mask, leaving the pixels
+// without spans untouched.
+inline void CoverageSpans::fill(std::uint8_t *mask,
+                                std::ptrdiff_t stride) const {
+  assert(mask || spans_.empty());
+  for (std::size_t y{}; y < size(); ++y) {
+    const auto first = row(y);
+    for (auto span = first; span != first + rowSize(y); ++span) {
+      const auto destination =
+          mask + static_cast<std::ptrdiff_t>(y) * stride + span->x;
+      const auto source = covers(*span);
+      if (span->solid) {
+        std::fill(destination, destination + span->length, *source);
+      } else {
+        std::copy(source, source + span->length, destination);
+      }
+    }
+  }
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::CoverageSpans;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_COVERAGE_SPANS_H_
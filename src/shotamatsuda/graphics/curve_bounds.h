@@ -0,0 +1,320 @@
+//
+//  shotamatsuda/graphics/curve_bounds.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_CURVE_BOUNDS_H_
+#define SHOTA_GRAPHICS_CURVE_BOUNDS_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+#include "shotamatsuda/graphics/pack.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class CurveBounds;
+
+template <class T>
+using CurveBounds2 = CurveBounds<T, 2>;
+
+// Finds the extrema of quadratic, conic and cubic segments in batches.
+// Segments are gathered into the lanes of a Pack, one coordinate at a time,
+// and each full batch solves the roots of the derivatives and evaluates the
+// curves at them without branching. Quadratics are raised to cubics, which
+// have the same extrema, so that both share the batches.
+//
+// The result covers every extremum inside the segments, and may include the
+// start points of the segments, which lie inside their bounds anyway. The end
+// points are left to the caller.
+template <class T>
+class CurveBounds<T, 2> final {
+ public:
+  using Type = T;
+  static constexpr const int dimensions = 2;
+
+ public:
+  CurveBounds();
+
+  // Copy semantics
+  CurveBounds(const CurveBounds&) = default;
+  CurveBounds& operator=(const CurveBounds&) = default;
+
+  // Adding segments
+  template <class U>
+  void addQuadratic(const Vec2<U>& p0, const Vec2<U>& p1, const Vec2<U>& p2);
+  template <class U>
+  void addCubic(const Vec2<U>& p0,
+                const Vec2<U>& p1,
+                const Vec2<U>& p2,
+                const Vec2<U>& p3);
+  template <class U>
+  void addConic(const Vec2<U>& p0,
+                const Vec2<U>& p1,
+                const Vec2<U>& p2,
+                T weight);
+
+  // Result
+  bool find(Vec2<T> *min, Vec2<T> *max);
+  void reset();
+
+ private:
+  static constexpr const std::size_t size = Pack<T>::size;
+
+  void flush();
+  static void pad(T (&coefficients)[4][size], std::size_t count);
+  static void solveCubics(const T (&coefficients)[4][size],
+                          Pack<T> *lower,
+                          Pack<T> *upper);
+  static void solveConics(const T (&coefficients)[4][size],
+                          Pack<T> *lower,
+                          Pack<T> *upper);
+
+ private:
+  T x_[4][size];
+  T y_[4][size];
+  T conic_x_[4][size];
+  T conic_y_[4][size];
+  std::size_t count_;
+  std::size_t conic_count_;
+  bool empty_;
+  Pack<T> min_x_;
+  Pack<T> min_y_;
+  Pack<T> max_x_;
+  Pack<T> max_y_;
+};
+
+using CurveBounds2f = CurveBounds2<float>;
+using CurveBounds2d = CurveBounds2<double>;
+
+#pragma mark -
+
+template <class T>
+inline CurveBounds<T, 2>::CurveBounds() {
+  reset();
+}
+
+template <class T>
+inline void CurveBounds<T, 2>::reset() {
+  count_ = 0;
+  conic_count_ = 0;
+  empty_ = true;
+  min_x_ = min_y_ = Pack<T>(std::numeric_limits<T>::infinity());
+  max_x_ = max_y_ = Pack<T>(-std::numeric_limits<T>::infinity());
+}
+
+#pragma mark Adding segments
+
+template <class T>
+template <class U>
+inline void CurveBounds<T, 2>::addQuadratic(const Vec2<U>& p0,
+                                            const Vec2<U>& p1,
+                                            const Vec2<U>& p2) {
+  const Vec2<T> a(p0.x, p0.y);
+  const Vec2<T> b(p1.x, p1.y);
+  const Vec2<T> c(p2.x, p2.y);
+  addCubic(a, a + (b - a) * 2 / 3, c + (b - c) * 2 / 3, c);
+}
+
+template <class T>
+template <class U>
+inline void CurveBounds<T, 2>::addCubic(const Vec2<U>& p0,
+                                        const Vec2<U>& p1,
+                                        const Vec2<U>& p2,
+                                        const Vec2<U>& p3) {
+  x_[0][count_] = p0.x;
+  x_[1][count_] = p1.x;
+  x_[2][count_] = p2.x;
+  x_[3][count_] = p3.x;
+  y_[0][count_] = p0.y;
+  y_[1][count_] = p1.y;
+  y_[2][count_] = p2.y;
+  y_[3][count_] = p3.y;
+  empty_ = false;
+  if (++count_ == size) {
+    flush();
+  }
+}
+
+template <class T>
+template <class U>
+inline void CurveBounds<T, 2>::addConic(const Vec2<U>& p0,
+                                        const Vec2<U>& p1,
+                                        const Vec2<U>& p2,
+                                        T weight) {
+  conic_x_[0][conic_count_] = p0.x;
+  conic_x_[1][conic_count_] = p1.x;
+  conic_x_[2][conic_count_] = p2.x;
+  conic_x_[3][conic_count_] = weight;
+  conic_y_[0][conic_count_] = p0.y;
+  conic_y_[1][conic_count_] = p1.y;
+  conic_y_[2][conic_count_] = p2.y;
+  conic_y_[3][conic_count_] = weight;
+  empty_ = false;
+  if (++conic_count_ == size) {
+    flush();
+  }
+}
+
+#pragma mark Result
+
+template <class T>
+inline bool CurveBounds<T, 2>::find(Vec2<T> *min, Vec2<T> *max) {
+  flush();
+  if (empty_) {
+    return false;
+  }
+  T lanes[4][size];
+  min_x_.store(lanes[0]);
+  min_y_.store(lanes[1]);
+  max_x_.store(lanes[2]);
+  max_y_.store(lanes[3]);
+  min->x = *std::min_element(std::begin(lanes[0]), std::end(lanes[0]));
+  min->y = *std::min_element(std::begin(lanes[1]), std::end(lanes[1]));
+  max->x = *std::max_element(std::begin(lanes[2]), std::end(lanes[2]));
+  max->y = *std::max_element(std::begin(lanes[3]), std::end(lanes[3]));
+  return true;
+}
+
+template <class T>
+inline void CurveBounds<T, 2>::flush() {
+  if (count_) {
+    pad(x_, count_);
+    pad(y_, count_);
+    solveCubics(x_, &min_x_, &max_x_);
+    solveCubics(y_, &min_y_, &max_y_);
+    count_ = 0;
+  }
+  if (conic_count_) {
+    pad(conic_x_, conic_count_);
+    pad(conic_y_, conic_count_);
+    solveConics(conic_x_, &min_x_, &max_x_);
+    solveConics(conic_y_, &min_y_, &max_y_);
+    conic_count_ = 0;
+  }
+}
+
+template <class T>
+inline void CurveBounds<T, 2>::pad(T (&coefficients)[4][size],
+                                   std::size_t count) {
+  // Unused lanes repeat the first segment, which leaves the result as is.
+  for (auto lane = count; lane < size; ++lane) {
+    for (auto& row : coefficients) {
+      row[lane] = row[0];
+    }
+  }
+}
+
+template <class T>
+inline void CurveBounds<T, 2>::solveCubics(
+    const T (&coefficients)[4][size],
+    Pack<T> *lower,
+    Pack<T> *upper) {
+  using P = Pack<T>;
+  const auto p0 = P::load(coefficients[0]);
+  const auto p1 = P::load(coefficients[1]);
+  const auto p2 = P::load(coefficients[2]);
+  const auto p3 = P::load(coefficients[3]);
+
+  // The derivative divided by 3 is a t^2 + b t + c. Its roots are taken from
+  // q = -(b + sign(b) sqrt(b^2 - 4ac)) / 2 as q / a and c / q, which stays
+  // accurate when b^2 dominates and yields the root of the linear case when a
+  // is zero. Divisions by zero produce roots outside (0, 1), and a negative
+  // discriminant is clamped, which yields a point on the curve at worst.
+  const auto d0 = p1 - p0;
+  const auto d1 = p2 - p1;
+  const auto d2 = p3 - p2;
+  const auto a = d0 - P(2) * d1 + d2;
+  const auto b = P(2) * (d1 - d0);
+  const auto c = d0;
+  const auto zero = P(0);
+  const auto one = P(1);
+  const auto s = sqrt(max(b * b - P(4) * a * c, zero));
+  const auto q = P(-0.5) * select(b < zero, b - s, b + s);
+  const P roots[] = {q / a, c / q};
+  for (auto t : roots) {
+    // Roots outside the segment evaluate at its start point instead.
+    t = select((t > zero) & (t < one), t, zero);
+    const auto mt = one - t;
+    const auto value = (mt * mt * mt * p0 +
+                        P(3) * mt * t * (mt * p1 + t * p2) +
+                        t * t * t * p3);
+    *lower = min(*lower, value);
+    *upper = max(*upper, value);
+  }
+}
+
+template <class T>
+inline void CurveBounds<T, 2>::solveConics(
+    const T (&coefficients)[4][size],
+    Pack<T> *lower,
+    Pack<T> *upper) {
+  using P = Pack<T>;
+  const auto p0 = P::load(coefficients[0]);
+  const auto p1 = P::load(coefficients[1]);
+  const auto p2 = P::load(coefficients[2]);
+  const auto w = P::load(coefficients[3]);
+
+  // The numerator of the derivative of the rational quadratic is, up to a
+  // positive factor, a t^2 + b t + c with the coefficients below, as in
+  // Skia's conic_deriv_coeff. Its roots are solved as for cubics.
+  const auto p20 = p2 - p0;
+  const auto p10 = p1 - p0;
+  const auto wp10 = w * p10;
+  const auto a = w * p20 - p20;
+  const auto b = p20 - P(2) * wp10;
+  const auto c = wp10;
+  const auto zero = P(0);
+  const auto one = P(1);
+  const auto s = sqrt(max(b * b - P(4) * a * c, zero));
+  const auto q = P(-0.5) * select(b < zero, b - s, b + s);
+  const P roots[] = {q / a, c / q};
+  for (auto t : roots) {
+    t = select((t > zero) & (t < one), t, zero);
+    const auto mt = one - t;
+    const auto wt = P(2) * w * mt * t;
+    const auto value = ((mt * mt * p0 + wt * p1 + t * t * p2) /
+                        (mt * mt + wt + t * t));
+    *lower = min(*lower, value);
+    *upper = max(*upper, value);
+  }
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::CurveBounds;
+using graphics::CurveBounds2;
+using graphics::CurveBounds2f;
+using graphics::CurveBounds2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_CURVE_BOUNDS_H_
@@ -0,0 +1,425 @@
+//
+//  shotamatsuda/graphics/curve_measure.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_CURVE_MEASURE_H_
+#define SHOTA_GRAPHICS_CURVE_MEASURE_H_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/conic.h"
+#include "shotamatsuda/graphics/flattener.h"
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class CurveMeasure;
+
+template <class T>
+using CurveMeasure2 = CurveMeasure<T, 2>;
+
+// Measures the arc length of a single segment of a path, and maps distances
+// along it back to parameters. The segment is sampled at as many equal
+// parameter steps as Flattener would split it into, so that the chords
+// deviate from it by at most the tolerance, and the cumulative lengths of the
+// chords form a table that is searched and interpolated. The table is kept
+// between segments, so measuring allocates nothing once it has grown.
+//
+// Parts of the segment between two parameters are extracted as curves of the
+// same kind, by blossoming the control points, so that curves stay curves.
+template <class T>
+class CurveMeasure<T, 2> final {
+ public:
+  using Type = T;
+  using Scalar = math::Promote<T>;
+  static constexpr const int dimensions = 2;
+
+ public:
+  explicit CurveMeasure(Scalar tolerance = 0.25);
+
+  // Copy semantics
+  CurveMeasure(const CurveMeasure&) = default;
+  CurveMeasure& operator=(const CurveMeasure&) = default;
+
+  // Move semantics
+  CurveMeasure(CurveMeasure&&) = default;
+  CurveMeasure& operator=(CurveMeasure&&) = default;
+
+  // Mutators
+  void setLine(const Vec2<T>& p0, const Vec2<T>& p1);
+  void setQuadratic(const Vec2<T>& p0, const Vec2<T>& p1, const Vec2<T>& p2);
+  void setConic(const Conic2<T>& conic);
+  void setCubic(const Vec2<T>& p0,
+                const Vec2<T>& p1,
+                const Vec2<T>& p2,
+                const Vec2<T>& p3);
+
+  // Attributes
+  Scalar tolerance() const { return tolerance_; }
+  CommandType type() const { return type_; }
+  Scalar length() const { return lengths_.back(); }
+  const std::vector<Scalar>& lengths() const { return lengths_; }
+
+  // Measuring
+  Scalar parameter(Scalar distance) const;
+  Vec2<Scalar> point(Scalar t) const;
+  Vec2<Scalar> derivative(Scalar t) const;
+
+  // Evaluation
+  static Vec2<Scalar> point(CommandType type,
+                            const Vec2<Scalar> *points,
+                            Scalar weight,
+                            Scalar t);
+  static Vec2<Scalar> derivative(CommandType type,
+                                 const Vec2<Scalar> *points,
+                                 Scalar weight,
+                                 Scalar t);
+
+  // Extraction
+  void addSegment(Scalar t0, Scalar t1, Path2<T> *path) const;
+
+ private:
+  void measure(unsigned int count);
+  static Vec2<Scalar> blossom(const Vec2<Scalar> *p, Scalar u, Scalar v);
+  static Vec2<Scalar> blossom(const Vec2<Scalar> *p,
+                              Scalar u,
+                              Scalar v,
+                              Scalar w);
+  static std::array<Scalar, 3> homogeneousBlossom(const Vec2<Scalar> *p,
+                                                  Scalar weight,
+                                                  Scalar u,
+                                                  Scalar v);
+  static Vec2<Scalar> promote(const Vec2<T>& point);
+  static Vec2<T> demote(const Vec2<Scalar>& point);
+
+ private:
+  Scalar tolerance_;
+  CommandType type_;
+  std::array<Vec2<Scalar>, 4> points_;
+  Scalar weight_;
+  std::vector<Scalar> lengths_;
+};
+
+using CurveMeasure2i = CurveMeasure2<int>;
+using CurveMeasure2f = CurveMeasure2<float>;
+using CurveMeasure2d = CurveMeasure2<double>;
+
+#pragma mark -
+
+template <class T>
+inline CurveMeasure<T, 2>::CurveMeasure(Scalar tolerance)
+    : tolerance_(tolerance),
+      type_(CommandType::LINE),
+      weight_(1),
+      lengths_(2) {}
+
+#pragma mark Mutators
+
+template <class T>
+inline void CurveMeasure<T, 2>::setLine(const Vec2<T>& p0,
+                                        const Vec2<T>& p1) {
+  type_ = CommandType::LINE;
+  points_[0] = promote(p0);
+  points_[1] = promote(p1);
+  measure(1);
+}
+
+template <class T>
+inline void CurveMeasure<T, 2>::setQuadratic(const Vec2<T>& p0,
+                                             const Vec2<T>& p1,
+                                             const Vec2<T>& p2) {
+  type_ = CommandType::QUADRATIC;
+  points_[0] = promote(p0);
+  points_[1] = promote(p1);
+  points_[2] = promote(p2);
+  measure(Flattener2<T>(tolerance_).segments(p0, p1, p2));
+}
+
+// The segment count of the control polygon as a quadratic is only an
+// estimate for a conic, which is exact for weights no greater than 1.
+template <class T>
+inline void CurveMeasure<T, 2>::setConic(const Conic2<T>& conic) {
+  type_ = CommandType::CONIC;
+  points_[0] = promote(conic.a);
+  points_[1] = promote(conic.b);
+  points_[2] = promote(conic.c);
+  weight_ = conic.weight;
+  const auto count = Flattener2<T>(tolerance_).segments(
+      conic.a, conic.b, conic.c);
+  measure(weight_ > 1 ? std::min(count * 2, Flattener2<T>::max_segments)
+                      : count);
+}
+
+template <class T>
+inline void CurveMeasure<T, 2>::setCubic(const Vec2<T>& p0,
+                                         const Vec2<T>& p1,
+                                         const Vec2<T>& p2,
+                                         const Vec2<T>& p3) {
+  type_ = CommandType::CUBIC;
+  points_[0] = promote(p0);
+  points_[1] = promote(p1);
+  points_[2] = promote(p2);
+  points_[3] = promote(p3);
+  measure(Flattener2<T>(tolerance_).segments(p0, p1, p2, p3));
+}
+
+template <class T>
+inline void CurveMeasure<T, 2>::measure(unsigned int count) {
+  assert(count);
+  lengths_.resize(count + 1);
+  lengths_.front() = 0;
+  auto previous = points_[0];
+  for (unsigned int i = 1; i <= count; ++i) {
+    const auto next = point(Scalar(i) / count);
+    const auto chord = next - previous;
+    lengths_[i] = lengths_[i - 1] +
+                  std::sqrt(chord.x * chord.x + chord.y * chord.y);
+    previous = next;
+  }
+}
+
+#pragma mark Measuring
+
+// Finds the chord the distance falls on, and interpolates the parameter
+// linearly along it.
+template <class T>
+inline math::Promote<T> CurveMeasure<T, 2>::parameter(
+    Scalar distance) const {
+  const auto count = lengths_.size() - 1;
+  if (!(distance > 0)) {
+    return 0;
+  }
+  if (!(distance < lengths_.back())) {
+    return 1;
+  }
+  const auto upper = std::upper_bound(
+      std::begin(lengths_), std::end(lengths_), distance);
+  const auto index = std::distance(std::begin(lengths_), upper) - 1;
+  const auto chord = *upper - lengths_[index];
+  const auto fraction = chord > 0 ? (distance - lengths_[index]) / chord : 0;
+  return (index + fraction) / count;
+}
+
+template <class T>
+inline Vec2<math::Promote<T>> CurveMeasure<T, 2>::point(Scalar t) const {
+  return point(type_, points_.data(), weight_, t);
+}
+
+template <class T>
+inline Vec2<math::Promote<T>> CurveMeasure<T, 2>::derivative(
+    Scalar t) const {
+  return derivative(type_, points_.data(), weight_, t);
+}
+
+#pragma mark Evaluation
+
+// The points are those of a segment of the type, including its start.
+template <class T>
+inline Vec2<math::Promote<T>> CurveMeasure<T, 2>::point(
+    CommandType type,
+    const Vec2<Scalar> *points,
+    Scalar weight,
+    Scalar t) {
+  assert(points);
+  switch (type) {
+    case CommandType::LINE:
+      return points[0] + (points[1] - points[0]) * t;
+    case CommandType::QUADRATIC:
+      return blossom(points, t, t);
+    case CommandType::CONIC: {
+      const auto point = homogeneousBlossom(points, weight, t, t);
+      return Vec2<Scalar>(point[0] / point[2], point[1] / point[2]);
+    }
+    case CommandType::CUBIC:
+      return blossom(points, t, t, t);
+    default:
+      assert(false);
+      break;
+  }
+  return Vec2<Scalar>();
+}
+
+// The derivative of a polynomial of degree n is n times the difference of
+// its blossoms with a last argument of 1 and 0, and that of a conic follows
+// from the quotient rule on its homogeneous form.
+template <class T>
+inline Vec2<math::Promote<T>> CurveMeasure<T, 2>::derivative(
+    CommandType type,
+    const Vec2<Scalar> *points,
+    Scalar weight,
+    Scalar t) {
+  assert(points);
+  switch (type) {
+    case CommandType::LINE:
+      return points[1] - points[0];
+    case CommandType::QUADRATIC:
+      return (blossom(points, t, 1) - blossom(points, t, 0)) * 2;
+    case CommandType::CONIC: {
+      const auto point = homogeneousBlossom(points, weight, t, t);
+      const auto end = homogeneousBlossom(points, weight, t, 1);
+      const auto start = homogeneousBlossom(points, weight, t, 0);
+      const auto dx = 2 * (end[0] - start[0]);
+      const auto dy = 2 * (end[1] - start[1]);
+      const auto dw = 2 * (end[2] - start[2]);
+      const auto w2 = point[2] * point[2];
+      return Vec2<Scalar>((dx * point[2] - point[0] * dw) / w2,
+                          (dy * point[2] - point[1] * dw) / w2);
+    }
+    case CommandType::CUBIC:
+      return (blossom(points, t, t, 1) - blossom(points, t, t, 0)) * 3;
+    default:
+      assert(false);
+      break;
+  }
+  return Vec2<Scalar>();
+}
+
+#pragma mark Extraction
+
+// Appends the part between the parameters to the path, which is expected to
+// end at the point at t0. The control points of a polynomial part are the
+// blossoms of the segment at the parameters, and those of a conic part are
+// the blossoms of its homogeneous form, normalized back to end weights of 1.
+template <class T>
+inline void CurveMeasure<T, 2>::addSegment(Scalar t0,
+                                           Scalar t1,
+                                           Path2<T> *path) const {
+  assert(path);
+  const auto p = points_.data();
+  switch (type_) {
+    case CommandType::LINE:
+      path->lineTo(demote(point(t1)));
+      break;
+    case CommandType::QUADRATIC:
+      path->quadraticTo(demote(blossom(p, t0, t1)),
+                        demote(blossom(p, t1, t1)));
+      break;
+    case CommandType::CONIC: {
+      const auto start = homogeneousBlossom(p, weight_, t0, t0);
+      const auto control = homogeneousBlossom(p, weight_, t0, t1);
+      const auto end = homogeneousBlossom(p, weight_, t1, t1);
+      path->conicTo(
+          demote(Vec2<Scalar>(control[0] / control[2],
+                              control[1] / control[2])),
+          demote(Vec2<Scalar>(end[0] / end[2], end[1] / end[2])),
+          control[2] / std::sqrt(start[2] * end[2]));
+      break;
+    }
+    case CommandType::CUBIC:
+      path->cubicTo(demote(blossom(p, t0, t0, t1)),
+                    demote(blossom(p, t0, t1, t1)),
+                    demote(blossom(p, t1, t1, t1)));
+      break;
+    default:
+      assert(false);
+      break;
+  }
+}
+
+#pragma mark Blossoms
+
+template <class T>
+inline Vec2<math::Promote<T>> CurveMeasure<T, 2>::blossom(
+    const Vec2<Scalar> *p,
+    Scalar u,
+    Scalar v) {
+  const auto a = p[0] + (p[1] - p[0]) * u;
+  const auto b = p[1] + (p[2] - p[1]) * u;
+  return a + (b - a) * v;
+}
+
+template <class T>
+inline Vec2<math::Promote<T>> CurveMeasure<T, 2>::blossom(
+    const Vec2<Scalar> *p,
+    Scalar u,
+    Scalar v,
+    Scalar w) {
+  const auto a = p[0] + (p[1] - p[0]) * u;
+  const auto b = p[1] + (p[2] - p[1]) * u;
+  const auto c = p[2] + (p[3] - p[2]) * u;
+  const auto d = a + (b - a) * v;
+  const auto e = b + (c - b) * v;
+  return d + (e - d) * w;
+}
+
+// Blossoms a conic as a quadratic in homogeneous coordinates, in which its
+// control point is scaled by its weight.
+template <class T>
+inline std::array<math::Promote<T>, 3>
+    CurveMeasure<T, 2>::homogeneousBlossom(const Vec2<Scalar> *p,
+                                           Scalar weight,
+                                           Scalar u,
+                                           Scalar v) {
+  const std::array<std::array<Scalar, 3>, 3> h{{
+    {{p[0].x, p[0].y, 1}},
+    {{p[1].x * weight, p[1].y * weight, weight}},
+    {{p[2].x, p[2].y, 1}}
+  }};
+  std::array<Scalar, 3> result;
+  for (auto i = 0; i < 3; ++i) {
+    const auto a = h[0][i] + (h[1][i] - h[0][i]) * u;
+    const auto b = h[1][i] + (h[2][i] - h[1][i]) * u;
+    result[i] = a + (b - a) * v;
+  }
+  return result;
+}
+
+#pragma mark Conversion
+
+template <class T>
+inline Vec2<math::Promote<T>> CurveMeasure<T, 2>::promote(
+    const Vec2<T>& point) {
+  return Vec2<Scalar>(point.x, point.y);
+}
+
+template <class T>
+inline Vec2<T> CurveMeasure<T, 2>::demote(const Vec2<Scalar>& point) {
+  return Vec2<T>(point.x, point.y);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::CurveMeasure;
+using graphics::CurveMeasure2;
+using graphics::CurveMeasure2i;
+using graphics::CurveMeasure2f;
+using graphics::CurveMeasure2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_CURVE_MEASURE_H_
@@ -0,0 +1,172 @@
+//
+//  shotamatsuda/graphics/curve_stepper.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_CURVE_STEPPER_H_
+#define SHOTA_GRAPHICS_CURVE_STEPPER_H_
+
+#include <cassert>
+
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class CurveStepper;
+
+template <class T>
+using CurveStepper2 = CurveStepper<T, 2>;
+
+// Steps along a quadratic or cubic in a number of equal parameter increments
+// by forward differencing, which takes a few additions per point. The last
+// step yields the end point of the curve exactly.
+template <class T>
+class CurveStepper<T, 2> final {
+ public:
+  using Type = T;
+  using Scalar = math::Promote<T>;
+  static constexpr const int dimensions = 2;
+
+ public:
+  CurveStepper();
+
+  // Copy semantics
+  CurveStepper(const CurveStepper&) = default;
+  CurveStepper& operator=(const CurveStepper&) = default;
+
+  // Mutators
+  void setQuadratic(const Vec2<T>& p0,
+                    const Vec2<T>& p1,
+                    const Vec2<T>& p2,
+                    unsigned int count);
+  void setCubic(const Vec2<T>& p0,
+                const Vec2<T>& p1,
+                const Vec2<T>& p2,
+                const Vec2<T>& p3,
+                unsigned int count);
+
+  // Attributes
+  bool empty() const { return !remaining_; }
+  unsigned int remaining() const { return remaining_; }
+
+  // Stepping
+  Vec2<T> next();
+
+ private:
+  static Vec2<Scalar> promote(const Vec2<T>& point);
+
+ private:
+  Vec2<Scalar> point_;
+  Vec2<Scalar> d1_;
+  Vec2<Scalar> d2_;
+  Vec2<Scalar> d3_;
+  Vec2<T> end_;
+  unsigned int remaining_;
+};
+
+using CurveStepper2i = CurveStepper2<int>;
+using CurveStepper2f = CurveStepper2<float>;
+using CurveStepper2d = CurveStepper2<double>;
+
+#pragma mark -
+
+template <class T>
+inline CurveStepper<T, 2>::CurveStepper() : remaining_() {}
+
+#pragma mark Mutators
+
+template <class T>
+inline void CurveStepper<T, 2>::setQuadratic(const Vec2<T>& p0,
+                                             const Vec2<T>& p1,
+                                             const Vec2<T>& p2,
+                                             unsigned int count) {
+  assert(count);
+  const auto h = Scalar(1) / count;
+  const auto a = promote(p0) - promote(p1) * 2 + promote(p2);
+  const auto b = (promote(p1) - promote(p0)) * 2;
+  point_ = promote(p0);
+  d1_ = a * (h * h) + b * h;
+  d2_ = a * (2 * h * h);
+  d3_ = Vec2<Scalar>();
+  end_ = p2;
+  remaining_ = count;
+}
+
+template <class T>
+inline void CurveStepper<T, 2>::setCubic(const Vec2<T>& p0,
+                                         const Vec2<T>& p1,
+                                         const Vec2<T>& p2,
+                                         const Vec2<T>& p3,
+                                         unsigned int count) {
+  assert(count);
+  const auto h = Scalar(1) / count;
+  const auto a = promote(p3) - promote(p2) * 3 + promote(p1) * 3 -
+                 promote(p0);
+  const auto b = (promote(p2) - promote(p1) * 2 + promote(p0)) * 3;
+  const auto c = (promote(p1) - promote(p0)) * 3;
+  point_ = promote(p0);
+  d1_ = a * (h * h * h) + b * (h * h) + c * h;
+  d2_ = a * (6 * h * h * h) + b * (2 * h * h);
+  d3_ = a * (6 * h * h * h);
+  end_ = p3;
+  remaining_ = count;
+}
+
+#pragma mark Stepping
+
+template <class T>
+inline Vec2<T> CurveStepper<T, 2>::next() {
+  assert(remaining_);
+  if (!--remaining_) {
+    return end_;
+  }
+  point_ += d1_;
+  d1_ += d2_;
+  d2_ += d3_;
+  return Vec2<T>(static_cast<T>(point_.x), static_cast<T>(point_.y));
+}
+
+template <class T>
+inline Vec2<math::Promote<T>> CurveStepper<T, 2>::promote(
+    const Vec2<T>& point) {
+  return Vec2<Scalar>(point.x, point.y);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::CurveStepper;
+using graphics::CurveStepper2;
+using graphics::CurveStepper2i;
+using graphics::CurveStepper2f;
+using graphics::CurveStepper2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_CURVE_STEPPER_H_
@@ -0,0 +1,344 @@
+//
+//  shotamatsuda/graphics/dasher.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_DASHER_H_
+#define SHOTA_GRAPHICS_DASHER_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/conic.h"
+#include "shotamatsuda/graphics/curve_measure.h"
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class Dasher;
+
+template <class T>
+using Dasher2 = Dasher<T, 2>;
+
+// Splits paths into dashes along a pattern of alternating on and off
+// intervals, starting the phase distance into the pattern at every contour,
+// as SVG does. A pattern of odd length is repeated to make it even. Each dash
+// becomes an open path of the shape, and the segments it covers are chopped
+// at the parameters of its ends with CurveMeasure, so that curves stay curves
+// and no more segments are produced than the dashes cross. A pattern without
+// any length leaves the paths as they are. On a closed contour that is on
+// where it starts and ends, the last dash continues into the first, as a
+// single dash across the start point.
+template <class T>
+class Dasher<T, 2> final {
+ public:
+  using Type = T;
+  using Scalar = math::Promote<T>;
+  static constexpr const int dimensions = 2;
+
+ public:
+  explicit Dasher(const std::vector<Scalar>& intervals,
+                  Scalar phase = 0,
+                  Scalar tolerance = 0.25);
+
+  // Copy semantics
+  Dasher(const Dasher&) = default;
+  Dasher& operator=(const Dasher&) = default;
+
+  // Move semantics
+  Dasher(Dasher&&) = default;
+  Dasher& operator=(Dasher&&) = default;
+
+  // Attributes
+  const std::vector<Scalar>& intervals() const { return intervals_; }
+  Scalar phase() const { return phase_; }
+  Scalar tolerance() const { return measure_.tolerance(); }
+  void setPattern(const std::vector<Scalar>& intervals, Scalar phase = 0);
+
+  // Dashing
+  void dash(const Path2<T>& path, Shape2<T> *shape);
+  void dash(const Shape2<T>& shape, Shape2<T> *result);
+
+ private:
+  void begin();
+  void addSegment(Shape2<T> *shape);
+  void join(Path2<T> *last, Shape2<T> *shape);
+
+ private:
+  std::vector<Scalar> intervals_;
+  Scalar phase_;
+  Scalar period_;
+  CurveMeasure2<T> measure_;
+
+  // State of the contour being dashed
+  std::size_t index_;
+  Scalar remaining_;
+  Path2<T> *dash_;
+  Path2<T> *first_;
+  Path2<T> *last_;
+  bool leading_;
+};
+
+using Dasher2i = Dasher2<int>;
+using Dasher2f = Dasher2<float>;
+using Dasher2d = Dasher2<double>;
+
+#pragma mark -
+
+template <class T>
+inline Dasher<T, 2>::Dasher(const std::vector<Scalar>& intervals,
+                            Scalar phase,
+                            Scalar tolerance)
+    : measure_(tolerance),
+      index_(),
+      remaining_(),
+      dash_(),
+      first_(),
+      last_(),
+      leading_() {
+  setPattern(intervals, phase);
+}
+
+#pragma mark Attributes
+
+template <class T>
+inline void Dasher<T, 2>::setPattern(const std::vector<Scalar>& intervals,
+                                     Scalar phase) {
+  assert(std::all_of(std::begin(intervals), std::end(intervals),
+                     [](Scalar interval) { return interval >= 0; }));
+  intervals_ = intervals;
+  if (intervals_.size() % 2) {
+    intervals_.insert(std::end(intervals_),
+                      std::begin(intervals), std::end(intervals));
+  }
+  phase_ = phase;
+  period_ = std::accumulate(std::begin(intervals_), std::end(intervals_),
+                            Scalar());
+}
+
+#pragma mark Dashing
+
+template <class T>
+inline void Dasher<T, 2>::dash(const Path2<T>& path, Shape2<T> *shape) {
+  assert(shape);
+  if (!(period_ > 0) || !std::isfinite(period_)) {
+    shape->addPath(path);
+    return;
+  }
+  bool open{};
+  Vec2<T> start;
+  auto point = path.points().data();
+  auto weight = path.weights().data();
+  for (const auto& type : path.verbs()) {
+    // A command following a close continues from the last point, as it does
+    // in the path.
+    if (type != CommandType::MOVE && type != CommandType::CLOSE && !open) {
+      start = point[-1];
+      begin();
+      open = true;
+    }
+    switch (type) {
+      case CommandType::MOVE:
+        start = point[0];
+        begin();
+        open = true;
+        break;
+      case CommandType::LINE:
+        measure_.setLine(point[-1], point[0]);
+        addSegment(shape);
+        break;
+      case CommandType::QUADRATIC:
+        measure_.setQuadratic(point[-1], point[0], point[1]);
+        addSegment(shape);
+        break;
+      case CommandType::CONIC:
+        measure_.setConic(Conic2<T>(point[-1], point[0], point[1],
+                                    *weight++));
+        addSegment(shape);
+        break;
+      case CommandType::CUBIC:
+        measure_.setCubic(point[-1], point[0], point[1], point[2]);
+        addSegment(shape);
+        break;
+      case CommandType::CLOSE:
+        if (open) {
+          if (point[-1] != start) {
+            measure_.setLine(point[-1], start);
+            addSegment(shape);
+          }
+          if (first_ && (dash_ || last_)) {
+            join(dash_ ? dash_ : last_, shape);
+          }
+          open = false;
+        }
+        break;
+      default:
+        assert(false);
+        break;
+    }
+    point += pointCount(type);
+  }
+}
+
+template <class T>
+inline void Dasher<T, 2>::dash(const Shape2<T>& shape, Shape2<T> *result) {
+  for (const auto& path : shape.paths()) {
+    dash(path, result);
+  }
+}
+
+// Moves the pattern to the phase at the start of a contour.
+template <class T>
+inline void Dasher<T, 2>::begin() {
+  auto phase = std::fmod(phase_, period_);
+  if (phase < 0) {
+    phase += period_;
+  }
+  index_ = 0;
+  while (!(phase < intervals_[index_]) && index_ + 1 < intervals_.size()) {
+    phase -= intervals_[index_++];
+  }
+  remaining_ = intervals_[index_] - phase;
+  dash_ = nullptr;
+  first_ = nullptr;
+  last_ = nullptr;
+  leading_ = !(index_ % 2);
+}
+
+// Walks the segment in the measure through the intervals it spans, extending
+// the current dash over the ones that are on. Dashes of zero length are kept
+// as a segment back to their start, so that they can still be capped. A dash
+// that ends exactly where the segment does is remembered until the contour
+// moves on, as it still meets the first dash if the contour closes there.
+template <class T>
+inline void Dasher<T, 2>::addSegment(Shape2<T> *shape) {
+  const auto length = measure_.length();
+  if (length > 0) {
+    last_ = nullptr;
+  }
+  Scalar position{};
+  for (;;) {
+    const auto finished = position + remaining_ <= length;
+    const auto end = finished ? position + remaining_ : length;
+    if (!(index_ % 2) && (end > position || !remaining_)) {
+      const auto t0 = measure_.parameter(position);
+      if (!dash_) {
+        dash_ = &shape->addPath(Path2<T>(shape->allocator()));
+        const auto start = measure_.point(t0);
+        dash_->moveTo(Vec2<T>(start.x, start.y));
+        if (leading_) {
+          first_ = dash_;
+          leading_ = false;
+        }
+      }
+      measure_.addSegment(t0, measure_.parameter(end), dash_);
+    }
+    if (!finished) {
+      remaining_ -= length - position;
+      return;
+    }
+    position = end;
+    if (!(index_ % 2)) {
+      if (dash_ && end == length) {
+        last_ = dash_;
+      }
+      dash_ = nullptr;
+    }
+    index_ = (index_ + 1) % intervals_.size();
+    remaining_ = intervals_[index_];
+  }
+}
+
+// Appends the first dash of the closed contour to the last one, and moves the
+// result into the place of the first. A dash that runs around the whole
+// contour is closed instead.
+template <class T>
+inline void Dasher<T, 2>::join(Path2<T> *last, Shape2<T> *shape) {
+  assert(last && shape);
+  assert(first_);
+  if (last == first_) {
+    last->close();
+    return;
+  }
+  auto point = first_->points().data();
+  auto weight = first_->weights().data();
+  for (const auto& type : first_->verbs()) {
+    switch (type) {
+      case CommandType::MOVE:
+        break;
+      case CommandType::LINE:
+        last->lineTo(point[0]);
+        break;
+      case CommandType::QUADRATIC:
+        last->quadraticTo(point[0], point[1]);
+        break;
+      case CommandType::CONIC:
+        last->conicTo(point[0], point[1], *weight++);
+        break;
+      case CommandType::CUBIC:
+        last->cubicTo(point[0], point[1], point[2]);
+        break;
+      default:
+        assert(false);
+        break;
+    }
+    point += pointCount(type);
+  }
+  // The last dash is the last path of the shape, and accessing the paths
+  // discards the caches that include the first.
+  auto& paths = shape->paths();
+  assert(last == &paths.back());
+  *first_ = std::move(paths.back());
+  paths.pop_back();
+  dash_ = nullptr;
+  first_ = nullptr;
+  last_ = nullptr;
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::Dasher;
+using graphics::Dasher2;
+using graphics::Dasher2i;
+using graphics::Dasher2f;
+using graphics::Dasher2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_DASHER_H_
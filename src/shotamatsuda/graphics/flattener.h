@@ -0,0 +1,280 @@
+//
+//  shotamatsuda/graphics/flattener.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_FLATTENER_H_
+#define SHOTA_GRAPHICS_FLATTENER_H_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/conic.h"
+#include "shotamatsuda/graphics/curve_stepper.h"
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/polylines.h"
+#include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class Flattener;
+
+template <class T>
+using Flattener2 = Flattener<T, 2>;
+
+// Flattens paths into polylines that deviate from them by at most the
+// tolerance. Each curve is split into as many segments of equal parameter
+// length as its second differences require, which adapts the count to the
+// curvature and size of the curve, and the points are stepped along by
+// forward differencing with CurveStepper. Conics are first subdivided into
+// quadratics within half the tolerance, and the quadratics are flattened
+// within the other half.
+template <class T>
+class Flattener<T, 2> final {
+ public:
+  using Type = T;
+  using Scalar = math::Promote<T>;
+  static constexpr const int dimensions = 2;
+  static constexpr const unsigned int max_segments = 1024;
+
+ public:
+  explicit Flattener(Scalar tolerance = 0.25);
+
+  // Copy semantics
+  Flattener(const Flattener&) = default;
+  Flattener& operator=(const Flattener&) = default;
+
+  // Attributes
+  Scalar tolerance() const { return tolerance_; }
+
+  // Flattening
+  void flatten(const Path2<T>& path, Polylines2<T> *polylines) const;
+  void flatten(const Shape2<T>& shape, Polylines2<T> *polylines) const;
+
+  // Segment counts
+  unsigned int segments(const Vec2<T>& p0,
+                        const Vec2<T>& p1,
+                        const Vec2<T>& p2) const;
+  unsigned int segments(const Vec2<T>& p0,
+                        const Vec2<T>& p1,
+                        const Vec2<T>& p2,
+                        const Vec2<T>& p3) const;
+
+  // Curves
+  void addQuadratic(const Vec2<T>& p0,
+                    const Vec2<T>& p1,
+                    const Vec2<T>& p2,
+                    Polylines2<T> *polylines) const;
+  void addConic(const Conic2<T>& conic, Polylines2<T> *polylines) const;
+  void addCubic(const Vec2<T>& p0,
+                const Vec2<T>& p1,
+                const Vec2<T>& p2,
+                const Vec2<T>& p3,
+                Polylines2<T> *polylines) const;
+
+ private:
+  static unsigned int segments(Scalar squared_count);
+  static Vec2<Scalar> promote(const Vec2<T>& point);
+
+ private:
+  Scalar tolerance_;
+};
+
+using Flattener2i = Flattener2<int>;
+using Flattener2f = Flattener2<float>;
+using Flattener2d = Flattener2<double>;
+
+#pragma mark -
+
+template <class T>
+constexpr const unsigned int Flattener<T, 2>::max_segments;
+
+template <class T>
+inline Flattener<T, 2>::Flattener(Scalar tolerance) : tolerance_(tolerance) {}
+
+#pragma mark Flattening
+
+template <class T>
+inline void Flattener<T, 2>::flatten(const Path2<T>& path,
+                                     Polylines2<T> *polylines) const {
+  assert(polylines);
+  bool open{};
+  auto point = path.points().data();
+  auto weight = path.weights().data();
+  for (const auto& type : path.verbs()) {
+    // A command following a close continues from the last point, as it does
+    // in the path.
+    if (type != CommandType::MOVE && type != CommandType::CLOSE && !open) {
+      polylines->moveTo(point[-1]);
+      open = true;
+    }
+    switch (type) {
+      case CommandType::MOVE:
+        polylines->moveTo(point[0]);
+        open = true;
+        break;
+      case CommandType::LINE:
+        polylines->lineTo(point[0]);
+        break;
+      case CommandType::QUADRATIC:
+        addQuadratic(point[-1], point[0], point[1], polylines);
+        break;
+      case CommandType::CONIC:
+        addConic(Conic2<T>(point[-1], point[0], point[1], *weight++),
+                 polylines);
+        break;
+      case CommandType::CUBIC:
+        addCubic(point[-1], point[0], point[1], point[2], polylines);
+        break;
+      case CommandType::CLOSE:
+        if (open) {
+          polylines->close();
+          open = false;
+        }
+        break;
+      default:
+        assert(false);
+        break;
+    }
+    point += pointCount(type);
+  }
+}
+
+template <class T>
+inline void Flattener<T, 2>::flatten(const Shape2<T>& shape,
+                                     Polylines2<T> *polylines) const {
+  for (const auto& path : shape.paths()) {
+    flatten(path, polylines);
+  }
+}
+
+#pragma mark Segment counts
+
+// A chord over a parameter interval of length h deviates from a curve by at
+// most h^2 / 8 times the largest second derivative over the interval. The
+// second derivative of a quadratic is 2 * (p0 - 2 * p1 + p2).
+template <class T>
+inline unsigned int Flattener<T, 2>::segments(const Vec2<T>& p0,
+                                              const Vec2<T>& p1,
+                                              const Vec2<T>& p2) const {
+  const auto d = promote(p0) - promote(p1) * 2 + promote(p2);
+  return segments(d.length() / (4 * tolerance_));
+}
+
+// The second derivative of a cubic is the interpolation of
+// 6 * (p0 - 2 * p1 + p2) and 6 * (p1 - 2 * p2 + p3), which bounds it.
+template <class T>
+inline unsigned int Flattener<T, 2>::segments(const Vec2<T>& p0,
+                                              const Vec2<T>& p1,
+                                              const Vec2<T>& p2,
+                                              const Vec2<T>& p3) const {
+  const auto d1 = promote(p0) - promote(p1) * 2 + promote(p2);
+  const auto d2 = promote(p1) - promote(p2) * 2 + promote(p3);
+  const auto d = std::max(d1.lengthSquared(), d2.lengthSquared());
+  return segments(3 * std::sqrt(d) / (4 * tolerance_));
+}
+
+template <class T>
+inline unsigned int Flattener<T, 2>::segments(Scalar squared_count) {
+  if (!(squared_count > 1)) {
+    return 1;
+  }
+  const auto count = std::ceil(std::sqrt(squared_count));
+  if (!(count < max_segments)) {
+    return max_segments;
+  }
+  return static_cast<unsigned int>(count);
+}
+
+#pragma mark Curves
+
+template <class T>
+inline void Flattener<T, 2>::addQuadratic(const Vec2<T>& p0,
+                                          const Vec2<T>& p1,
+                                          const Vec2<T>& p2,
+                                          Polylines2<T> *polylines) const {
+  assert(polylines);
+  CurveStepper2<T> stepper;
+  stepper.setQuadratic(p0, p1, p2, segments(p0, p1, p2));
+  while (!stepper.empty()) {
+    polylines->lineTo(stepper.next());
+  }
+}
+
+template <class T>
+inline void Flattener<T, 2>::addConic(const Conic2<T>& conic,
+                                      Polylines2<T> *polylines) const {
+  const Flattener half(tolerance_ / 2);
+  const auto level = conic.subdivision(half.tolerance_);
+  std::array<Vec2<T>, 2U << Conic2<T>::max_subdivision> quadratics;
+  const auto end = conic.subdivide(level, std::begin(quadratics));
+  auto previous = conic.a;
+  for (auto control = std::begin(quadratics); control != end; control += 2) {
+    half.addQuadratic(previous, control[0], control[1], polylines);
+    previous = control[1];
+  }
+}
+
+template <class T>
+inline void Flattener<T, 2>::addCubic(const Vec2<T>& p0,
+                                      const Vec2<T>& p1,
+                                      const Vec2<T>& p2,
+                                      const Vec2<T>& p3,
+                                      Polylines2<T> *polylines) const {
+  assert(polylines);
+  CurveStepper2<T> stepper;
+  stepper.setCubic(p0, p1, p2, p3, segments(p0, p1, p2, p3));
+  while (!stepper.empty()) {
+    polylines->lineTo(stepper.next());
+  }
+}
+
+#pragma mark Conversion
+
+template <class T>
+inline Vec2<math::Promote<T>> Flattener<T, 2>::promote(const Vec2<T>& point) {
+  return Vec2<Scalar>(point.x, point.y);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::Flattener;
+using graphics::Flattener2;
+using graphics::Flattener2i;
+using graphics::Flattener2f;
+using graphics::Flattener2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_FLATTENER_H_
@@ -0,0 +1,348 @@
+//
+//  shotamatsuda/graphics/flattening_iterator.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_FLATTENING_ITERATOR_H_
+#define SHOTA_GRAPHICS_FLATTENING_ITERATOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+
+#include "shotamatsuda/graphics/command.h"
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/conic.h"
+#include "shotamatsuda/graphics/curve_stepper.h"
+#include "shotamatsuda/graphics/flattener.h"
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+// Flattens the commands of a path or shape on demand, yielding the same
+// moves, lines and closes as Flattener::flatten writes, one at a time. Only
+// the state of the curve being stepped along is kept, so the memory used is
+// constant however large the path is. Each quadratic piece of a conic is
+// found by chopping the conic down to it, which repeats the arithmetic of
+// Conic::subdivide exactly.
+template <class Iterator>
+class FlatteningIterator final {
+ public:
+  using Type = typename std::iterator_traits<Iterator>::value_type::Type;
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Command2<Type>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const Command2<Type> *;
+  using reference = const Command2<Type>&;
+
+ public:
+  FlatteningIterator();
+  FlatteningIterator(Iterator first,
+                     Iterator last,
+                     const Flattener2<Type>& flattener);
+
+  // Copy semantics
+  FlatteningIterator(const FlatteningIterator&) = default;
+  FlatteningIterator& operator=(const FlatteningIterator&) = default;
+
+  // Move semantics
+  FlatteningIterator(FlatteningIterator&&) = default;
+  FlatteningIterator& operator=(FlatteningIterator&&) = default;
+
+  // Comparison
+  bool operator==(const FlatteningIterator& other) const;
+  bool operator!=(const FlatteningIterator& other) const;
+
+  // Iterator
+  reference operator*() const { return command_; }
+  pointer operator->() const { return &command_; }
+  FlatteningIterator& operator++();
+  FlatteningIterator operator++(int);
+
+ private:
+  void advance();
+  void stepConic();
+
+ private:
+  Iterator current_;
+  Iterator last_;
+  Flattener2<Type> flattener_;
+  Command2<Type> command_;
+  CurveStepper2<Type> stepper_;
+  Conic2<Type> conic_;
+  unsigned int level_;
+  unsigned int piece_;
+  unsigned int pieces_;
+  Vec2<Type> previous_;
+  bool open_;
+  bool done_;
+};
+
+// A range of the flattened commands between two command iterators.
+template <class Iterator>
+class FlatteningView final {
+ public:
+  using Type = typename std::iterator_traits<Iterator>::value_type::Type;
+  using ConstIterator = FlatteningIterator<Iterator>;
+
+ public:
+  FlatteningView(Iterator first,
+                 Iterator last,
+                 const Flattener2<Type>& flattener);
+
+  // Copy semantics
+  FlatteningView(const FlatteningView&) = default;
+  FlatteningView& operator=(const FlatteningView&) = default;
+
+  // Iterator
+  ConstIterator begin() const;
+  ConstIterator end() const;
+
+ private:
+  Iterator first_;
+  Iterator last_;
+  Flattener2<Type> flattener_;
+};
+
+template <class T>
+FlatteningView<typename Path2<T>::ConstIterator> flattened(
+    const Path2<T>& path,
+    const Flattener2<T>& flattener = Flattener2<T>());
+template <class T>
+FlatteningView<typename Shape2<T>::ConstIterator> flattened(
+    const Shape2<T>& shape,
+    const Flattener2<T>& flattener = Flattener2<T>());
+
+#pragma mark -
+
+template <class Iterator>
+inline FlatteningIterator<Iterator>::FlatteningIterator()
+    : current_(),
+      last_(),
+      command_(CommandType::CLOSE),
+      level_(),
+      piece_(),
+      pieces_(),
+      open_(),
+      done_(true) {}
+
+template <class Iterator>
+inline FlatteningIterator<Iterator>::FlatteningIterator(
+    Iterator first,
+    Iterator last,
+    const Flattener2<Type>& flattener)
+    : current_(first),
+      last_(last),
+      flattener_(flattener),
+      command_(CommandType::CLOSE),
+      level_(),
+      piece_(),
+      pieces_(),
+      open_(),
+      done_() {
+  advance();
+}
+
+#pragma mark Comparison
+
+template <class Iterator>
+inline bool FlatteningIterator<Iterator>::operator==(
+    const FlatteningIterator& other) const {
+  if (done_ || other.done_) {
+    return done_ == other.done_;
+  }
+  return current_ == other.current_ &&
+         stepper_.remaining() == other.stepper_.remaining() &&
+         piece_ == other.piece_ &&
+         open_ == other.open_;
+}
+
+template <class Iterator>
+inline bool FlatteningIterator<Iterator>::operator!=(
+    const FlatteningIterator& other) const {
+  return !(*this == other);
+}
+
+#pragma mark Iterator
+
+template <class Iterator>
+inline FlatteningIterator<Iterator>&
+FlatteningIterator<Iterator>::operator++() {
+  assert(!done_);
+  advance();
+  return *this;
+}
+
+template <class Iterator>
+inline FlatteningIterator<Iterator>
+FlatteningIterator<Iterator>::operator++(int) {
+  FlatteningIterator result(*this);
+  ++*this;
+  return result;
+}
+
+template <class Iterator>
+inline void FlatteningIterator<Iterator>::advance() {
+  if (stepper_.empty() && piece_ < pieces_) {
+    stepConic();
+  }
+  if (!stepper_.empty()) {
+    command_ = Command2<Type>(CommandType::LINE, stepper_.next());
+    return;
+  }
+  while (current_ != last_) {
+    const auto command = *current_;
+    const auto type = command.type();
+    // A command following a close continues from the last point, as it does
+    // in the path. The command itself is visited on the next advance.
+    if (type != CommandType::MOVE && type != CommandType::CLOSE && !open_) {
+      command_ = Command2<Type>(CommandType::MOVE, previous_);
+      open_ = true;
+      return;
+    }
+    ++current_;
+    switch (type) {
+      case CommandType::MOVE:
+        command_ = Command2<Type>(CommandType::MOVE, command.point());
+        open_ = true;
+        break;
+      case CommandType::LINE:
+        command_ = Command2<Type>(CommandType::LINE, command.point());
+        break;
+      case CommandType::QUADRATIC:
+        stepper_.setQuadratic(previous_, command.control(), command.point(),
+                              flattener_.segments(previous_,
+                                                  command.control(),
+                                                  command.point()));
+        command_ = Command2<Type>(CommandType::LINE, stepper_.next());
+        break;
+      case CommandType::CONIC:
+        conic_ = Conic2<Type>(previous_, command.control(), command.point(),
+                              command.weight());
+        level_ = conic_.subdivision(flattener_.tolerance() / 2);
+        piece_ = 0;
+        pieces_ = 1U << level_;
+        stepConic();
+        command_ = Command2<Type>(CommandType::LINE, stepper_.next());
+        break;
+      case CommandType::CUBIC:
+        stepper_.setCubic(previous_, command.control1(), command.control2(),
+                          command.point(),
+                          flattener_.segments(previous_,
+                                              command.control1(),
+                                              command.control2(),
+                                              command.point()));
+        command_ = Command2<Type>(CommandType::LINE, stepper_.next());
+        break;
+      case CommandType::CLOSE:
+        if (!open_) {
+          continue;
+        }
+        command_ = Command2<Type>(CommandType::CLOSE);
+        open_ = false;
+        break;
+      default:
+        assert(false);
+        continue;
+    }
+    if (type != CommandType::CLOSE) {
+      previous_ = command.point();
+    }
+    return;
+  }
+  done_ = true;
+}
+
+// Chops the conic down to the next of its quadratic pieces, following the
+// bits of the piece's index from the top, and starts stepping along it
+// within half the tolerance.
+template <class Iterator>
+inline void FlatteningIterator<Iterator>::stepConic() {
+  assert(piece_ < pieces_);
+  auto conic = conic_;
+  for (auto bit = level_; bit--;) {
+    const auto pair = conic.chop();
+    conic = (piece_ >> bit) & 1 ? pair.second : pair.first;
+  }
+  ++piece_;
+  const Flattener2<Type> half(flattener_.tolerance() / 2);
+  stepper_.setQuadratic(conic.a, conic.b, conic.c,
+                        half.segments(conic.a, conic.b, conic.c));
+}
+
+#pragma mark -
+
+template <class Iterator>
+inline FlatteningView<Iterator>::FlatteningView(
+    Iterator first,
+    Iterator last,
+    const Flattener2<Type>& flattener)
+    : first_(first),
+      last_(last),
+      flattener_(flattener) {}
+
+#pragma mark Iterator
+
+template <class Iterator>
+inline FlatteningIterator<Iterator> FlatteningView<Iterator>::begin() const {
+  return ConstIterator(first_, last_, flattener_);
+}
+
+template <class Iterator>
+inline FlatteningIterator<Iterator> FlatteningView<Iterator>::end() const {
+  return ConstIterator();
+}
+
+#pragma mark -
+
+template <class T>
+inline FlatteningView<typename Path2<T>::ConstIterator> flattened(
+    const Path2<T>& path,
+    const Flattener2<T>& flattener) {
+  return FlatteningView<typename Path2<T>::ConstIterator>(
+      path.begin(), path.end(), flattener);
+}
+
+template <class T>
+inline FlatteningView<typename Shape2<T>::ConstIterator> flattened(
+    const Shape2<T>& shape,
+    const Flattener2<T>& flattener) {
+  return FlatteningView<typename Shape2<T>::ConstIterator>(
+      shape.begin(), shape.end(), flattener);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::FlatteningIterator;
+using graphics::FlatteningView;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_FLATTENING_ITERATOR_H_
@@ -0,0 +1,72 @@
+//
+//  shotamatsuda/graphics/hash.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_HASH_H_
+#define SHOTA_GRAPHICS_HASH_H_
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+// Mixes the hash of the given value into the seed, in the same manner as
+// boost::hash_combine.
+template <class T>
+inline void hashCombine(std::size_t& seed, const T& value) {
+  using Value = std::conditional_t<
+      std::is_enum<T>::value, std::underlying_type<T>, std::decay<T>>;
+  const std::hash<typename Value::type> hasher;
+  seed ^= (hasher(static_cast<typename Value::type>(value)) +
+           0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+template <class T>
+inline void hashCombine(std::size_t& seed, const Vec2<T>& value) {
+  hashCombine(seed, value.x);
+  hashCombine(seed, value.y);
+}
+
+template <class InputIterator>
+inline void hashCombine(std::size_t& seed,
+                        InputIterator first,
+                        InputIterator last) {
+  for (; first != last; ++first) {
+    hashCombine(seed, *first);
+  }
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_HASH_H_
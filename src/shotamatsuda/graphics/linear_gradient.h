@@ -0,0 +1,203 @@
+//
+//  shotamatsuda/graphics/linear_gradient.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_LINEAR_GRADIENT_H_
+#define SHOTA_GRAPHICS_LINEAR_GRADIENT_H_
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <vector>
+
+#include "shotamatsuda/graphics/color4.h"
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class LinearGradient;
+
+template <class T>
+using LinearGradient2 = LinearGradient<T, 2>;
+
+// A gradient along the line from the start point to the end point, with
+// colors at offsets between zero at the start and one at the end. Points
+// project onto the line, and offsets beyond the first and last stops take
+// their colors. Colors are interpolated with premultiplied alpha, so that
+// fading into a transparent stop does not darken the other color.
+template <class T>
+class LinearGradient<T, 2> final {
+ public:
+  using Type = T;
+  using Scalar = math::Promote<T>;
+  static constexpr const int dimensions = 2;
+
+  struct Stop final {
+    float offset;
+    Color4f color;
+  };
+
+  using Stops = std::vector<Stop>;
+
+ public:
+  LinearGradient();
+  LinearGradient(const Vec2<T>& start, const Vec2<T>& end);
+
+  // Copy semantics
+  LinearGradient(const LinearGradient&) = default;
+  LinearGradient& operator=(const LinearGradient&) = default;
+
+  // Move semantics
+  LinearGradient(LinearGradient&&) = default;
+  LinearGradient& operator=(LinearGradient&&) = default;
+
+  // Mutators
+  void set(const Vec2<T>& start, const Vec2<T>& end);
+  template <class U>
+  void addStop(float offset, const Color4<U>& color);
+  void clearStops() { stops_.clear(); }
+
+  // Attributes
+  const Vec2<T>& start() const { return start_; }
+  const Vec2<T>& end() const { return end_; }
+  const Stops& stops() const { return stops_; }
+
+  // Evaluation
+  Scalar offset(const Vec2<Scalar>& point) const;
+  Color4f color(float offset) const;
+
+ private:
+  static Color4f premultiply(const Color4f& color);
+
+ private:
+  Vec2<T> start_;
+  Vec2<T> end_;
+  Stops stops_;
+};
+
+using LinearGradient2i = LinearGradient2<int>;
+using LinearGradient2f = LinearGradient2<float>;
+using LinearGradient2d = LinearGradient2<double>;
+
+#pragma mark -
+
+template <class T>
+inline LinearGradient<T, 2>::LinearGradient() : start_(), end_() {}
+
+template <class T>
+inline LinearGradient<T, 2>::LinearGradient(const Vec2<T>& start,
+                                            const Vec2<T>& end)
+    : start_(start),
+      end_(end) {}
+
+#pragma mark Mutators
+
+template <class T>
+inline void LinearGradient<T, 2>::set(const Vec2<T>& start,
+                                      const Vec2<T>& end) {
+  start_ = start;
+  end_ = end;
+}
+
+// Stops are kept in order of offset, and a stop at the same offset as others
+// goes after them, which makes a hard transition.
+template <class T>
+template <class U>
+inline void LinearGradient<T, 2>::addStop(float offset,
+                                          const Color4<U>& color) {
+  offset = std::min(std::max(offset, 0.f), 1.f);
+  const auto position = std::upper_bound(
+      std::begin(stops_), std::end(stops_), offset,
+      [](float offset, const Stop& stop) { return offset < stop.offset; });
+  stops_.insert(position, Stop{offset, Color4f(color)});
+}
+
+#pragma mark Evaluation
+
+// Returns the offset of the point along the gradient, which is zero at the
+// start and one at the end, without clamping. A gradient whose end points
+// coincide has an offset of zero everywhere.
+template <class T>
+inline math::Promote<T> LinearGradient<T, 2>::offset(
+    const Vec2<Scalar>& point) const {
+  const auto dx = Scalar(end_.x) - start_.x;
+  const auto dy = Scalar(end_.y) - start_.y;
+  const auto length_squared = dx * dx + dy * dy;
+  if (!length_squared) {
+    return 0;
+  }
+  return ((point.x - start_.x) * dx + (point.y - start_.y) * dy) /
+         length_squared;
+}
+
+template <class T>
+inline Color4f LinearGradient<T, 2>::color(float offset) const {
+  if (stops_.empty()) {
+    return Color4f();
+  }
+  if (!(offset > stops_.front().offset)) {
+    return stops_.front().color;
+  }
+  if (!(offset < stops_.back().offset)) {
+    return stops_.back().color;
+  }
+  const auto next = std::upper_bound(
+      std::begin(stops_), std::end(stops_), offset,
+      [](float offset, const Stop& stop) { return offset < stop.offset; });
+  const auto previous = std::prev(next);
+  const auto factor =
+      (offset - previous->offset) / (next->offset - previous->offset);
+  const auto result = premultiply(previous->color).lerp(
+      premultiply(next->color), factor);
+  if (!result.a) {
+    return result;
+  }
+  return Color4f(result.r / result.a, result.g / result.a,
+                 result.b / result.a, result.a);
+}
+
+template <class T>
+inline Color4f LinearGradient<T, 2>::premultiply(const Color4f& color) {
+  return Color4f(color.r * color.a, color.g * color.a, color.b * color.a,
+                 color.a);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::LinearGradient;
+using graphics::LinearGradient2;
+using graphics::LinearGradient2i;
+using graphics::LinearGradient2f;
+using graphics::LinearGradient2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_LINEAR_GRADIENT_H_
@@ -0,0 +1,137 @@
+//
+//  shotamatsuda/graphics/memory_resource.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_MEMORY_RESOURCE_H_
+#define SHOTA_GRAPHICS_MEMORY_RESOURCE_H_
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+namespace shotamatsuda {
+namespace graphics {
+
+// Mirrors std::pmr::memory_resource, which is not available before C++17.
+class MemoryResource {
+ public:
+  virtual ~MemoryResource() = default;
+
+  // Allocation
+  void * allocate(std::size_t size,
+                  std::size_t alignment = alignof(std::max_align_t));
+  void deallocate(void *pointer,
+                  std::size_t size,
+                  std::size_t alignment = alignof(std::max_align_t));
+
+  // Comparison
+  bool isEqual(const MemoryResource& other) const;
+
+ protected:
+  virtual void * doAllocate(std::size_t size, std::size_t alignment) = 0;
+  virtual void doDeallocate(void *pointer,
+                            std::size_t size,
+                            std::size_t alignment) = 0;
+  virtual bool doIsEqual(const MemoryResource& other) const = 0;
+};
+
+// Comparison
+bool operator==(const MemoryResource& lhs, const MemoryResource& rhs);
+bool operator!=(const MemoryResource& lhs, const MemoryResource& rhs);
+
+// Returns a resource that forwards to global operator new and delete.
+MemoryResource * newDeleteResource();
+
+// Returns the resource used by allocators that are not given one.
+MemoryResource * defaultResource();
+
+#pragma mark -
+
+class NewDeleteResource final : public MemoryResource {
+ protected:
+  void * doAllocate(std::size_t size, std::size_t alignment) override {
+    assert(alignment <= alignof(std::max_align_t));
+    return ::operator new(size);
+  }
+
+  void doDeallocate(void *pointer,
+                    std::size_t size,
+                    std::size_t alignment) override {
+    ::operator delete(pointer);
+  }
+
+  bool doIsEqual(const MemoryResource& other) const override {
+    return this == &other;
+  }
+};
+
+#pragma mark Allocation
+
+inline void * MemoryResource::allocate(std::size_t size,
+                                       std::size_t alignment) {
+  return doAllocate(size, alignment);
+}
+
+inline void MemoryResource::deallocate(void *pointer,
+                                       std::size_t size,
+                                       std::size_t alignment) {
+  doDeallocate(pointer, size, alignment);
+}
+
+#pragma mark Comparison
+
+inline bool MemoryResource::isEqual(const MemoryResource& other) const {
+  return doIsEqual(other);
+}
+
+inline bool operator==(const MemoryResource& lhs, const MemoryResource& rhs) {
+  return &lhs == &rhs || lhs.isEqual(rhs);
+}
+
+inline bool operator!=(const MemoryResource& lhs, const MemoryResource& rhs) {
+  return !(lhs == rhs);
+}
+
+#pragma mark Resources
+
+inline MemoryResource * newDeleteResource() {
+  static NewDeleteResource resource;
+  return &resource;
+}
+
+inline MemoryResource * defaultResource() {
+  return newDeleteResource();
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::MemoryResource;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_MEMORY_RESOURCE_H_
@@ -0,0 +1,441 @@
+//
+//  shotamatsuda/graphics/pack.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_PACK_H_
+#define SHOTA_GRAPHICS_PACK_H_
+
+#include <cmath>
+#include <cstddef>
+
+#include "shotamatsuda/graphics/simd.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+// A register's worth of lanes, with the handful of arithmetic the curve
+// kernels need. Float and double packs use the widest instruction set that
+// simd.h detects, and other types, or targets without one, fall back to a
+// single lane so that the kernels need no scalar variant.
+template <class T>
+class Pack final {
+ public:
+  using Type = T;
+  using Mask = bool;
+  static constexpr const std::size_t size = 1;
+
+ public:
+  Pack() = default;
+  explicit Pack(T value) : value_(value) {}
+
+  // Memory
+  static Pack load(const T *data) { return Pack(*data); }
+  void store(T *data) const { *data = value_; }
+
+  // Arithmetic
+  friend Pack operator+(Pack a, Pack b) { return Pack(a.value_ + b.value_); }
+  friend Pack operator-(Pack a, Pack b) { return Pack(a.value_ - b.value_); }
+  friend Pack operator*(Pack a, Pack b) { return Pack(a.value_ * b.value_); }
+  friend Pack operator/(Pack a, Pack b) { return Pack(a.value_ / b.value_); }
+  friend Pack sqrt(Pack a) { return Pack(std::sqrt(a.value_)); }
+  friend Pack min(Pack a, Pack b) { return b.value_ < a.value_ ? b : a; }
+  friend Pack max(Pack a, Pack b) { return a.value_ < b.value_ ? b : a; }
+
+  // Comparison
+  friend Mask operator<(Pack a, Pack b) { return a.value_ < b.value_; }
+  friend Mask operator>(Pack a, Pack b) { return a.value_ > b.value_; }
+  friend Pack select(Mask mask, Pack a, Pack b) { return mask ? a : b; }
+
+ private:
+  T value_;
+};
+
+#if SHOTA_HAS_AVX
+
+template <>
+class Pack<float> final {
+ public:
+  using Type = float;
+  struct Mask {
+    __m256 value;
+    friend Mask operator&(Mask a, Mask b) {
+      return {_mm256_and_ps(a.value, b.value)};
+    }
+  };
+  static constexpr const std::size_t size = 8;
+
+ public:
+  Pack() = default;
+  explicit Pack(float value) : value_(_mm256_set1_ps(value)) {}
+  explicit Pack(__m256 value) : value_(value) {}
+
+  // Memory
+  static Pack load(const float *data) { return Pack(_mm256_loadu_ps(data)); }
+  void store(float *data) const { _mm256_storeu_ps(data, value_); }
+
+  // Arithmetic
+  friend Pack operator+(Pack a, Pack b) {
+    return Pack(_mm256_add_ps(a.value_, b.value_));
+  }
+  friend Pack operator-(Pack a, Pack b) {
+    return Pack(_mm256_sub_ps(a.value_, b.value_));
+  }
+  friend Pack operator*(Pack a, Pack b) {
+    return Pack(_mm256_mul_ps(a.value_, b.value_));
+  }
+  friend Pack operator/(Pack a, Pack b) {
+    return Pack(_mm256_div_ps(a.value_, b.value_));
+  }
+  friend Pack sqrt(Pack a) { return Pack(_mm256_sqrt_ps(a.value_)); }
+  friend Pack min(Pack a, Pack b) {
+    return Pack(_mm256_min_ps(a.value_, b.value_));
+  }
+  friend Pack max(Pack a, Pack b) {
+    return Pack(_mm256_max_ps(a.value_, b.value_));
+  }
+
+  // Comparison
+  friend Mask operator<(Pack a, Pack b) {
+    return {_mm256_cmp_ps(a.value_, b.value_, _CMP_LT_OQ)};
+  }
+  friend Mask operator>(Pack a, Pack b) {
+    return {_mm256_cmp_ps(a.value_, b.value_, _CMP_GT_OQ)};
+  }
+  friend Pack select(Mask mask, Pack a, Pack b) {
+    return Pack(_mm256_blendv_ps(b.value_, a.value_, mask.value));
+  }
+
+ private:
+  __m256 value_;
+};
+
+template <>
+class Pack<double> final {
+ public:
+  using Type = double;
+  struct Mask {
+    __m256d value;
+    friend Mask operator&(Mask a, Mask b) {
+      return {_mm256_and_pd(a.value, b.value)};
+    }
+  };
+  static constexpr const std::size_t size = 4;
+
+ public:
+  Pack() = default;
+  explicit Pack(double value) : value_(_mm256_set1_pd(value)) {}
+  explicit Pack(__m256d value) : value_(value) {}
+
+  // Memory
+  static Pack load(const double *data) {
+    return Pack(_mm256_loadu_pd(data));
+  }
+  void store(double *data) const { _mm256_storeu_pd(data, value_); }
+
+  // Arithmetic
+  friend Pack operator+(Pack a, Pack b) {
+    return Pack(_mm256_add_pd(a.value_, b.value_));
+  }
+  friend Pack operator-(Pack a, Pack b) {
+    return Pack(_mm256_sub_pd(a.value_, b.value_));
+  }
+  friend Pack operator*(Pack a, Pack b) {
+    return Pack(_mm256_mul_pd(a.value_, b.value_));
+  }
+  friend Pack operator/(Pack a, Pack b) {
+    return Pack(_mm256_div_pd(a.value_, b.value_));
+  }
+  friend Pack sqrt(Pack a) { return Pack(_mm256_sqrt_pd(a.value_)); }
+  friend Pack min(Pack a, Pack b) {
+    return Pack(_mm256_min_pd(a.value_, b.value_));
+  }
+  friend Pack max(Pack a, Pack b) {
+    return Pack(_mm256_max_pd(a.value_, b.value_));
+  }
+
+  // Comparison
+  friend Mask operator<(Pack a, Pack b) {
+    return {_mm256_cmp_pd(a.value_, b.value_, _CMP_LT_OQ)};
+  }
+  friend Mask operator>(Pack a, Pack b) {
+    return {_mm256_cmp_pd(a.value_, b.value_, _CMP_GT_OQ)};
+  }
+  friend Pack select(Mask mask, Pack a, Pack b) {
+    return Pack(_mm256_blendv_pd(b.value_, a.value_, mask.value));
+  }
+
+ private:
+  __m256d value_;
+};
+
+#elif SHOTA_HAS_SSE2
+
+template <>
+class Pack<float> final {
+ public:
+  using Type = float;
+  struct Mask {
+    __m128 value;
+    friend Mask operator&(Mask a, Mask b) {
+      return {_mm_and_ps(a.value, b.value)};
+    }
+  };
+  static constexpr const std::size_t size = 4;
+
+ public:
+  Pack() = default;
+  explicit Pack(float value) : value_(_mm_set1_ps(value)) {}
+  explicit Pack(__m128 value) : value_(value) {}
+
+  // Memory
+  static Pack load(const float *data) { return Pack(_mm_loadu_ps(data)); }
+  void store(float *data) const { _mm_storeu_ps(data, value_); }
+
+  // Arithmetic
+  friend Pack operator+(Pack a, Pack b) {
+    return Pack(_mm_add_ps(a.value_, b.value_));
+  }
+  friend Pack operator-(Pack a, Pack b) {
+    return Pack(_mm_sub_ps(a.value_, b.value_));
+  }
+  friend Pack operator*(Pack a, Pack b) {
+    return Pack(_mm_mul_ps(a.value_, b.value_));
+  }
+  friend Pack operator/(Pack a, Pack b) {
+    return Pack(_mm_div_ps(a.value_, b.value_));
+  }
+  friend Pack sqrt(Pack a) { return Pack(_mm_sqrt_ps(a.value_)); }
+  friend Pack min(Pack a, Pack b) {
+    return Pack(_mm_min_ps(a.value_, b.value_));
+  }
+  friend Pack max(Pack a, Pack b) {
+    return Pack(_mm_max_ps(a.value_, b.value_));
+  }
+
+  // Comparison
+  friend Mask operator<(Pack a, Pack b) {
+    return {_mm_cmplt_ps(a.value_, b.value_)};
+  }
+  friend Mask operator>(Pack a, Pack b) {
+    return {_mm_cmpgt_ps(a.value_, b.value_)};
+  }
+  friend Pack select(Mask mask, Pack a, Pack b) {
+    return Pack(_mm_or_ps(_mm_and_ps(mask.value, a.value_),
+                          _mm_andnot_ps(mask.value, b.value_)));
+  }
+
+ private:
+  __m128 value_;
+};
+
+template <>
+class Pack<double> final {
+ public:
+  using Type = double;
+  struct Mask {
+    __m128d value;
+    friend Mask operator&(Mask a, Mask b) {
+      return {_mm_and_pd(a.value, b.value)};
+    }
+  };
+  static constexpr const std::size_t size = 2;
+
+ public:
+  Pack() = default;
+  explicit Pack(double value) : value_(_mm_set1_pd(value)) {}
+  explicit Pack(__m128d value) : value_(value) {}
+
+  // Memory
+  static Pack load(const double *data) { return Pack(_mm_loadu_pd(data)); }
+  void store(double *data) const { _mm_storeu_pd(data, value_); }
+
+  // Arithmetic
+  friend Pack operator+(Pack a, Pack b) {
+    return Pack(_mm_add_pd(a.value_, b.value_));
+  }
+  friend Pack operator-(Pack a, Pack b) {
+    return Pack(_mm_sub_pd(a.value_, b.value_));
+  }
+  friend Pack operator*(Pack a, Pack b) {
+    return Pack(_mm_mul_pd(a.value_, b.value_));
+  }
+  friend Pack operator/(Pack a, Pack b) {
+    return Pack(_mm_div_pd(a.value_, b.value_));
+  }
+  friend Pack sqrt(Pack a) { return Pack(_mm_sqrt_pd(a.value_)); }
+  friend Pack min(Pack a, Pack b) {
+    return Pack(_mm_min_pd(a.value_, b.value_));
+  }
+  friend Pack max(Pack a, Pack b) {
+    return Pack(_mm_max_pd(a.value_, b.value_));
+  }
+
+  // Comparison
+  friend Mask operator<(Pack a, Pack b) {
+    return {_mm_cmplt_pd(a.value_, b.value_)};
+  }
+  friend Mask operator>(Pack a, Pack b) {
+    return {_mm_cmpgt_pd(a.value_, b.value_)};
+  }
+  friend Pack select(Mask mask, Pack a, Pack b) {
+    return Pack(_mm_or_pd(_mm_and_pd(mask.value, a.value_),
+                          _mm_andnot_pd(mask.value, b.value_)));
+  }
+
+ private:
+  __m128d value_;
+};
+
+#elif SHOTA_HAS_NEON_FP64
+
+// Lane-wise division and square root need AArch64, so 32-bit ARM uses the
+// single-lane packs.
+
+template <>
+class Pack<float> final {
+ public:
+  using Type = float;
+  struct Mask {
+    uint32x4_t value;
+    friend Mask operator&(Mask a, Mask b) {
+      return {vandq_u32(a.value, b.value)};
+    }
+  };
+  static constexpr const std::size_t size = 4;
+
+ public:
+  Pack() = default;
+  explicit Pack(float value) : value_(vdupq_n_f32(value)) {}
+  explicit Pack(float32x4_t value) : value_(value) {}
+
+  // Memory
+  static Pack load(const float *data) { return Pack(vld1q_f32(data)); }
+  void store(float *data) const { vst1q_f32(data, value_); }
+
+  // Arithmetic
+  friend Pack operator+(Pack a, Pack b) {
+    return Pack(vaddq_f32(a.value_, b.value_));
+  }
+  friend Pack operator-(Pack a, Pack b) {
+    return Pack(vsubq_f32(a.value_, b.value_));
+  }
+  friend Pack operator*(Pack a, Pack b) {
+    return Pack(vmulq_f32(a.value_, b.value_));
+  }
+  friend Pack operator/(Pack a, Pack b) {
+    return Pack(vdivq_f32(a.value_, b.value_));
+  }
+  friend Pack sqrt(Pack a) { return Pack(vsqrtq_f32(a.value_)); }
+  friend Pack min(Pack a, Pack b) {
+    return Pack(vminq_f32(a.value_, b.value_));
+  }
+  friend Pack max(Pack a, Pack b) {
+    return Pack(vmaxq_f32(a.value_, b.value_));
+  }
+
+  // Comparison
+  friend Mask operator<(Pack a, Pack b) {
+    return {vcltq_f32(a.value_, b.value_)};
+  }
+  friend Mask operator>(Pack a, Pack b) {
+    return {vcgtq_f32(a.value_, b.value_)};
+  }
+  friend Pack select(Mask mask, Pack a, Pack b) {
+    return Pack(vbslq_f32(mask.value, a.value_, b.value_));
+  }
+
+ private:
+  float32x4_t value_;
+};
+
+template <>
+class Pack<double> final {
+ public:
+  using Type = double;
+  struct Mask {
+    uint64x2_t value;
+    friend Mask operator&(Mask a, Mask b) {
+      return {vandq_u64(a.value, b.value)};
+    }
+  };
+  static constexpr const std::size_t size = 2;
+
+ public:
+  Pack() = default;
+  explicit Pack(double value) : value_(vdupq_n_f64(value)) {}
+  explicit Pack(float64x2_t value) : value_(value) {}
+
+  // Memory
+  static Pack load(const double *data) { return Pack(vld1q_f64(data)); }
+  void store(double *data) const { vst1q_f64(data, value_); }
+
+  // Arithmetic
+  friend Pack operator+(Pack a, Pack b) {
+    return Pack(vaddq_f64(a.value_, b.value_));
+  }
+  friend Pack operator-(Pack a, Pack b) {
+    return Pack(vsubq_f64(a.value_, b.value_));
+  }
+  friend Pack operator*(Pack a, Pack b) {
+    return Pack(vmulq_f64(a.value_, b.value_));
+  }
+  friend Pack operator/(Pack a, Pack b) {
+    return Pack(vdivq_f64(a.value_, b.value_));
+  }
+  friend Pack sqrt(Pack a) { return Pack(vsqrtq_f64(a.value_)); }
+  friend Pack min(Pack a, Pack b) {
+    return Pack(vminq_f64(a.value_, b.value_));
+  }
+  friend Pack max(Pack a, Pack b) {
+    return Pack(vmaxq_f64(a.value_, b.value_));
+  }
+
+  // Comparison
+  friend Mask operator<(Pack a, Pack b) {
+    return {vcltq_f64(a.value_, b.value_)};
+  }
+  friend Mask operator>(Pack a, Pack b) {
+    return {vcgtq_f64(a.value_, b.value_)};
+  }
+  friend Pack select(Mask mask, Pack a, Pack b) {
+    return Pack(vbslq_f64(mask.value, a.value_, b.value_));
+  }
+
+ private:
+  float64x2_t value_;
+};
+
+#endif  // SHOTA_HAS_AVX
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::Pack;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_PACK_H_
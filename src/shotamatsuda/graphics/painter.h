@@ -0,0 +1,272 @@
+//
+//  shotamatsuda/graphics/painter.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_PAINTER_H_
+#define SHOTA_GRAPHICS_PAINTER_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "shotamatsuda/graphics/color4.h"
+#include "shotamatsuda/graphics/fill_rule.h"
+#include "shotamatsuda/graphics/flattener.h"
+#include "shotamatsuda/graphics/linear_gradient.h"
+#include "shotamatsuda/graphics/rasterizer.h"
+#include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class Painter;
+
+template <class T>
+using Painter2 = Painter<T, 2>;
+
+// Fills shapes into a buffer of 8-bit RGBA pixels with premultiplied alpha,
+// compositing each one over the pixels already there. A shape is rasterized
+// over just the part of the buffer its cached bounds cover, and the coverage
+// of each row is composited as soon as it is accumulated, so that no mask is
+// written between the two and painting many small shapes touches only the
+// pixels under them. The painter keeps its buffers between shapes.
+//
+// Gradients are looked up in a table of premultiplied colors sampled at 256
+// offsets, and evaluated at the centers of pixels.
+template <class T>
+class Painter<T, 2> final {
+ public:
+  using Type = T;
+  using Scalar = math::Promote<T>;
+  static constexpr const int dimensions = 2;
+  static constexpr const int ramp_size = 256;
+
+ public:
+  Painter(Color4u *pixels, int width, int height, std::ptrdiff_t stride);
+
+  // Copy semantics
+  Painter(const Painter&) = default;
+  Painter& operator=(const Painter&) = default;
+
+  // Move semantics
+  Painter(Painter&&) = default;
+  Painter& operator=(Painter&&) = default;
+
+  // Attributes
+  Color4u * pixels() const { return pixels_; }
+  int width() const { return width_; }
+  int height() const { return height_; }
+  std::ptrdiff_t stride() const { return stride_; }
+
+  // Painting
+  template <class U>
+  void fill(const Shape2<T>& shape,
+            const Color4<U>& color,
+            FillRule rule = FillRule::NON_ZERO,
+            const Flattener2<T>& flattener = Flattener2<T>());
+  void fill(const Shape2<T>& shape,
+            const LinearGradient2<T>& gradient,
+            FillRule rule = FillRule::NON_ZERO,
+            const Flattener2<T>& flattener = Flattener2<T>());
+
+ private:
+  bool prepare(const Shape2<T>& shape, const Flattener2<T>& flattener);
+  template <class Shader>
+  void composite(FillRule rule, Shader shader);
+  static Color4u premultiply(const Color4f& color);
+  static void blend(Color4u& destination,
+                    const Color4u& source,
+                    std::uint8_t coverage);
+  static std::uint8_t multiply(unsigned int a, unsigned int b);
+
+ private:
+  Color4u *pixels_;
+  int width_;
+  int height_;
+  std::ptrdiff_t stride_;
+  Rasterizer2<T> rasterizer_;
+  std::vector<std::uint8_t> coverage_;
+  std::vector<Color4u> ramp_;
+};
+
+template <class T>
+constexpr const int Painter<T, 2>::ramp_size;
+
+using Painter2i = Painter2<int>;
+using Painter2f = Painter2<float>;
+using Painter2d = Painter2<double>;
+
+#pragma mark -
+
+template <class T>
+inline Painter<T, 2>::Painter(Color4u *pixels,
+                              int width,
+                              int height,
+                              std::ptrdiff_t stride)
+    : pixels_(pixels),
+      width_(width),
+      height_(height),
+      stride_(stride) {
+  assert(pixels || !width || !height);
+  assert(width >= 0 && height >= 0 && stride >= width);
+}
+
+#pragma mark Painting
+
+template <class T>
+template <class U>
+inline void Painter<T, 2>::fill(const Shape2<T>& shape,
+                                const Color4<U>& color,
+                                FillRule rule,
+                                const Flattener2<T>& flattener) {
+  const auto source = premultiply(color);
+  if (!source.a || !prepare(shape, flattener)) {
+    return;
+  }
+  composite(rule, [&source](int, int) -> const Color4u& {
+    return source;
+  });
+}
+
+template <class T>
+inline void Painter<T, 2>::fill(const Shape2<T>& shape,
+                                const LinearGradient2<T>& gradient,
+                                FillRule rule,
+                                const Flattener2<T>& flattener) {
+  if (gradient.stops().empty() || !prepare(shape, flattener)) {
+    return;
+  }
+  ramp_.resize(ramp_size);
+  for (auto i = 0; i < ramp_size; ++i) {
+    ramp_[i] = premultiply(gradient.color(float(i) / (ramp_size - 1)));
+  }
+  composite(rule, [this, &gradient](int x, int y) -> const Color4u& {
+    const auto offset = gradient.offset(Vec2<Scalar>(x + 0.5, y + 0.5));
+    const auto clamped = std::min(std::max(offset, Scalar(0)), Scalar(1));
+    return ramp_[static_cast<int>(clamped * (ramp_size - 1) + 0.5)];
+  });
+}
+
+// Sizes the rasterizer to the bounds of the shape within the buffer, and adds
+// the shape to it. Returns false when the shape misses the buffer.
+template <class T>
+inline bool Painter<T, 2>::prepare(const Shape2<T>& shape,
+                                   const Flattener2<T>& flattener) {
+  if (shape.empty()) {
+    return false;
+  }
+  const auto bounds = shape.bounds();
+  const auto clamp = [](Scalar value, int limit) {
+    return static_cast<int>(std::min(std::max(value, Scalar(0)),
+                                     Scalar(limit)));
+  };
+  const auto left = clamp(std::floor(bounds.minX()), width_);
+  const auto top = clamp(std::floor(bounds.minY()), height_);
+  const auto right = clamp(std::ceil(bounds.maxX()), width_);
+  const auto bottom = clamp(std::ceil(bounds.maxY()), height_);
+  if (left >= right || top >= bottom) {
+    return false;
+  }
+  rasterizer_.resize(right - left, bottom - top);
+  rasterizer_.setOrigin(Vec2<int>(left, top));
+  rasterizer_.addShape(shape, flattener);
+  coverage_.resize(right - left);
+  return true;
+}
+
+// Blends the shader's color at each pixel with coverage, a row at a time.
+template <class T>
+template <class Shader>
+inline void Painter<T, 2>::composite(FillRule rule, Shader shader) {
+  const auto& origin = rasterizer_.origin();
+  const auto width = rasterizer_.width();
+  for (auto y = 0; y < rasterizer_.height(); ++y) {
+    rasterizer_.rasterizeRow(rule, y, coverage_.data());
+    const auto row = pixels_ + (origin.y + y) * stride_ + origin.x;
+    for (auto x = 0; x < width; ++x) {
+      if (coverage_[x]) {
+        blend(row[x], shader(origin.x + x, origin.y + y), coverage_[x]);
+      }
+    }
+  }
+}
+
+#pragma mark Compositing
+
+template <class T>
+inline Color4u Painter<T, 2>::premultiply(const Color4f& color) {
+  const Color4u result(color);
+  return Color4u(multiply(result.r, result.a), multiply(result.g, result.a),
+                 multiply(result.b, result.a), result.a);
+}
+
+// Composites the source over the destination, with the source scaled by the
+// coverage.
+template <class T>
+inline void Painter<T, 2>::blend(Color4u& destination,
+                                 const Color4u& source,
+                                 std::uint8_t coverage) {
+  if (coverage == 255 && source.a == 255) {
+    destination = source;
+    return;
+  }
+  const auto inverse = 255 - multiply(source.a, coverage);
+  destination.r = multiply(source.r, coverage) +
+                  multiply(destination.r, inverse);
+  destination.g = multiply(source.g, coverage) +
+                  multiply(destination.g, inverse);
+  destination.b = multiply(source.b, coverage) +
+                  multiply(destination.b, inverse);
+  destination.a = multiply(source.a, coverage) +
+                  multiply(destination.a, inverse);
+}
+
+// Multiplies two 8-bit values as fractions of 255, rounding to the nearest.
+template <class T>
+inline std::uint8_t Painter<T, 2>::multiply(unsigned int a, unsigned int b) {
+  const auto product = a * b + 128;
+  return static_cast<std::uint8_t>((product + (product >> 8)) >> 8);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::Painter;
+using graphics::Painter2;
+using graphics::Painter2i;
+using graphics::Painter2f;
+using graphics::Painter2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_PAINTER_H_
@@ -29,23 +29,39 @@
 #define SHOTA_GRAPHICS_PATH2_H_
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iterator>
-#include <limits>
 #include <list>
+#include <memory>
+#include <numeric>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "shotamatsuda/graphics/cache.h"
 #include "shotamatsuda/graphics/command.h"
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/command_view.h"
 #include "shotamatsuda/graphics/conic.h"
+#include "shotamatsuda/graphics/conic_subdivider.h"
+#include "shotamatsuda/graphics/curve_bounds.h"
+#include "shotamatsuda/graphics/fill_rule.h"
+#include "shotamatsuda/graphics/hash.h"
 #include "shotamatsuda/graphics/path_direction.h"
+#include "shotamatsuda/graphics/path_iterator.h"
+#include "shotamatsuda/graphics/path_normalization.h"
+#include "shotamatsuda/graphics/point_bounds.h"
+#include "shotamatsuda/graphics/polymorphic_allocator.h"
+#include "shotamatsuda/graphics/reversed_path_view.h"
+#include "shotamatsuda/graphics/segment_index.h"
 #include "shotamatsuda/math/constants.h"
 #include "shotamatsuda/math/promotion.h"
 #include "shotamatsuda/math/rectangle.h"
-#include "shotamatsuda/math/roots.h"
 #include "shotamatsuda/math/vector.h"
 
 namespace shotamatsuda {
@@ -59,47 +75,79 @@ class Path;
 template <class T>
 using Path2 = Path<T, 2>;
 
+template <class T, int D>
+class Shape;
+
+// Commands are stored as three contiguous arrays: one verb per command, the
+// points each verb consumes in order, and one weight per conic. Iterators and
+// element access yield views into these arrays, which convert to Command2.
+// The arrays are allocated from the memory resource given at construction.
+//
+// Views are read-only, and commands() returns a copy, so commands are not
+// modified in place. Write a command back with setCommand(), move its end
+// point with setPoint(), or edit the list commands() returns and pass it to
+// set().
+//
+// The arrays are implicitly shared: copying a path only shares its storage,
+// and the first mutation of a shared path detaches it with a deep copy. Paths
+// share storage only when they use the same memory resource.
+//
+// The content hash and both kinds of bounds are computed on first use and
+// cached in the storage until the next mutation, so querying a path
+// repeatedly, or querying its copies, walks the arrays only once. Every
+// mutation also bumps the generation, which lets callers key their own
+// caches on a path without comparing its content. The segment index that
+// hit testing uses is likewise built on the first test and shared by copies.
 template <class T>
 class Path<T, 2> final {
  public:
   using Type = T;
   using Command = Command2<T>;
-  using Iterator = typename std::list<Command2<T>>::iterator;
-  using ConstIterator = typename std::list<Command2<T>>::const_iterator;
+  using Iterator = PathIterator2<T>;
+  using ConstIterator = PathIterator2<T>;
   using ReverseIterator = std::reverse_iterator<Iterator>;
   using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
+  using allocator_type = PolymorphicAllocator<Path>;
+  using Verbs = std::vector<CommandType, PolymorphicAllocator<CommandType>>;
+  using Points = std::vector<Vec2<T>, PolymorphicAllocator<Vec2<T>>>;
+  using Weights = std::vector<
+      math::Promote<T>, PolymorphicAllocator<math::Promote<T>>>;
   static constexpr const int dimensions = 2;
 
- private:
-  // Provided for reverse()
-  struct Holder {
-    explicit Holder(const Vec2<T>& vector) : vector(vector) {}
-    explicit Holder(const math::Promote<T>& scalar) : scalar(scalar) {}
-    operator const Vec2<T>&() const { return vector; }
-    operator const math::Promote<T>&() const { return scalar; }
-    union {
-      Vec2<T> vector;
-      math::Promote<T> scalar;
-    };
-  };
-
  public:
   Path() = default;
-  explicit Path(const std::list<Command2<T>>& commands);
+  explicit Path(const allocator_type& allocator) : allocator_(allocator) {}
+  explicit Path(const std::list<Command2<T>>& commands,
+                const allocator_type& allocator = allocator_type());
+  Path(Verbs&& verbs, Points&& points, Weights&& weights = Weights());
 
   // Copy semantics
-  Path(const Path&) = default;
-  Path& operator=(const Path&) = default;
+  Path(const Path& other);
+  Path& operator=(const Path& other);
+
+  // Move semantics
+  Path(Path&&) = default;
+  Path& operator=(Path&& other);
+
+  // Allocator-extended copy and move
+  Path(const Path& other, const allocator_type& allocator);
+  Path(Path&& other, const allocator_type& allocator);
 
   // Mutators
   void set(const std::list<Command2<T>>& commands);
+  void set(Verbs&& verbs, Points&& points, Weights&& weights = Weights());
   void reset();
+  void reserve(std::size_t commands, std::size_t points);
 
   // Attributes
-  bool empty() const { return commands_.empty(); }
+  bool empty() const { return verbs().empty(); }
   bool closed() const;
-  std::size_t size() const { return commands_.size(); }
+  std::size_t size() const { return verbs().size(); }
   Rect2<math::Promote<T>> bounds(bool precise = false) const;
+  allocator_type allocator() const { return allocator_; }
+  bool shared() const { return storage_ && storage_.use_count() > 1; }
+  std::size_t hash() const;
+  std::uint64_t generation() const { return generation_; }
 
   // Adding commands
   void close();
@@ -119,78 +167,104 @@ class Path<T, 2> final {
                const Vec2<T>& point);
 
   // Commands
-  const std::list<Command2<T>>& commands() const { return commands_; }
-  std::list<Command2<T>>& commands() { return commands_; }
+  std::list<Command2<T>> commands() const;
+  const Verbs& verbs() const { return storage().verbs; }
+  const Points& points() const { return storage().points; }
+  const Weights& weights() const { return storage().weights; }
+  void setCommand(int index, const Command2<T>& command);
+  void setPoint(int index, const Vec2<T>& point);
 
   // Direction
   PathDirection direction() const;
   Path& reverse();
   Path reversed() const;
+  ReversedPathView2<T> reversedView() const;
+
+  // Hit testing
+  bool contains(const Vec2<T>& point,
+                FillRule rule = FillRule::NON_ZERO) const;
+  int winding(const Vec2<T>& point) const;
 
   // Conversion
   bool convertQuadraticsToCubics();
   bool convertConicsToQuadratics();
   bool convertConicsToQuadratics(math::Promote<T> tolerance);
+  bool normalize(PathNormalization normalization,
+                 math::Promote<T> tolerance);
   bool removeDuplicates(math::Promote<T> threshold);
 
   // Element access
-  Command2<T>& operator[](int index) { return at(index); }
-  const Command2<T>& operator[](int index) const { return at(index); }
-  Command2<T>& at(int index);
-  const Command2<T>& at(int index) const;
-  Command2<T>& front() { return commands_.front(); }
-  const Command2<T>& front() const { return commands_.front(); }
-  Command2<T>& back() { return commands_.back(); }
-  const Command2<T>& back() const { return commands_.back(); }
+  CommandView2<T> operator[](int index) const { return at(index); }
+  CommandView2<T> at(int index) const;
+  CommandView2<T> front() const { return *begin(); }
+  CommandView2<T> back() const { return *std::prev(end()); }
 
   // Iterator
-  Iterator begin() { return std::begin(commands_); }
-  ConstIterator begin() const { return std::begin(commands_); }
-  Iterator end() { return std::end(commands_); }
-  ConstIterator end() const { return std::end(commands_); }
-  ReverseIterator rbegin() { return ReverseIterator(begin()); }
-  ConstReverseIterator rbegin() const { return ConstReverseIterator(begin()); }
-  ReverseIterator rend() { return ReverseIterator(end()); }
-  ConstReverseIterator rend() const { return ConstReverseIterator(end()); }
+  ConstIterator begin() const;
+  ConstIterator end() const;
+  ConstReverseIterator rbegin() const { return ConstReverseIterator(end()); }
+  ConstReverseIterator rend() const { return ConstReverseIterator(begin()); }
+
+  // Comparison
+  friend bool operator==(const Path& lhs, const Path& rhs) {
+    return lhs.equals(rhs);
+  }
 
  private:
+  struct Storage {
+    explicit Storage(const allocator_type& allocator);
+    Storage(const Storage& other, const allocator_type& allocator);
+
+    Verbs verbs;
+    Points points;
+    Weights weights;
+    Cache<std::size_t> hash;
+    Cache<Rect2<math::Promote<T>>> approximate_bounds;
+    Cache<Rect2<math::Promote<T>>> precise_bounds;
+    Cache<std::shared_ptr<const SegmentIndex2<T>>> segment_index;
+  };
+
+  // Storage
+  const Storage& storage() const;
+  Storage& detach();
+
+  // Commands
+  std::size_t pointIndex(int index) const;
+
+  // Comparison
+  bool equals(const Path& other) const;
+  std::size_t calculateHash() const;
+
   // Bounding box
   template <class U = math::Promote<T>>
   Rect2<U> calculateApproximateBounds() const;
   template <class U = math::Promote<T>>
   Rect2<U> calculatePreciseBounds() const;
-  template <class OutputIterator>
-  unsigned int findQuadraticExtrema(const Vec2<T>& p0,
-                                    const Vec2<T>& p1,
-                                    const Vec2<T>& p2,
-                                    OutputIterator result) const;
-  template <class OutputIterator>
-  unsigned int findCubicExtrema(const Vec2<T>& p0,
-                                const Vec2<T>& p1,
-                                const Vec2<T>& p2,
-                                const Vec2<T>& p3,
-                                OutputIterator result) const;
-  template <class U = math::Promote<T>>
-  Vec2<U> evaluateQuadraticAt(const Vec2<T>& p0,
-                              const Vec2<T>& p1,
-                              const Vec2<T>& p2,
-                              U t) const;
-  template <class U = math::Promote<T>>
-  Vec2<U> evaluateCubicAt(const Vec2<T>& p0,
-                          const Vec2<T>& p1,
-                          const Vec2<T>& p2,
-                          const Vec2<T>& p3,
-                          U t) const;
+
+  // Hit testing
+  std::shared_ptr<const SegmentIndex2<T>> segmentIndex() const;
 
   // Conversion
-  template <
-    class Method, class... Args,
-    std::enable_if_t<std::is_member_pointer<Method>::value> *& = enabler
-  >
-  bool convertConicsToQuadratics(Method method, Args&&... args);
+  friend class Shape<T, 2>;
+  bool convertConicsToQuadratics(math::Promote<T> tolerance,
+                                 ConicSubdivider2<T> *subdivider);
+  bool normalize(PathNormalization normalization,
+                 math::Promote<T> tolerance,
+                 ConicSubdivider2<T> *subdivider);
+  template <class Subdivision>
+  bool subdivideConics(Subdivision subdivision,
+                       ConicSubdivider2<T> *subdivider);
+  static unsigned int approximation(const Vec2<T> *point,
+                                    math::Promote<T> tolerance);
+  template <class OutputIterator>
+  static OutputIterator approximate(const Vec2<T> *point,
+                                    unsigned int count,
+                                    OutputIterator result);
 
  private:
-  std::list<Command2<T>> commands_;
+  std::shared_ptr<Storage> storage_;
+  allocator_type allocator_;
+  std::uint64_t generation_ = 0;
 };
 
 // Comparison
@@ -206,26 +280,192 @@ using Path2d = Path2<double>;
 #pragma mark -
 
 template <class T>
-inline Path<T, 2>::Path(const std::list<Command2<T>>& commands)
-    : commands_(commands) {}
+inline Path<T, 2>::Path(const std::list<Command2<T>>& commands,
+                        const allocator_type& allocator)
+    : allocator_(allocator) {
+  set(commands);
+}
+
+template <class T>
+inline Path<T, 2>::Path(Verbs&& verbs, Points&& points, Weights&& weights)
+    : allocator_(verbs.get_allocator()) {
+  set(std::move(verbs), std::move(points), std::move(weights));
+}
+
+template <class T>
+inline Path<T, 2>::Path(const Path& other)
+    : Path(other, allocator_type()) {}
+
+template <class T>
+inline Path<T, 2>::Path(const Path& other, const allocator_type& allocator)
+    : allocator_(allocator),
+      generation_(other.generation_) {
+  if (!other.storage_) {
+    return;
+  } else if (other.allocator_ == allocator_) {
+    storage_ = other.storage_;
+  } else {
+    storage_ = std::allocate_shared<Storage>(
+        PolymorphicAllocator<Storage>(allocator_), *other.storage_, allocator_);
+  }
+}
+
+template <class T>
+inline Path<T, 2>::Path(Path&& other, const allocator_type& allocator)
+    : allocator_(allocator),
+      generation_(other.generation_) {
+  if (other.allocator_ == allocator_) {
+    storage_ = std::move(other.storage_);
+  } else if (other.storage_) {
+    storage_ = std::allocate_shared<Storage>(
+        PolymorphicAllocator<Storage>(allocator_), *other.storage_, allocator_);
+  }
+}
+
+template <class T>
+inline Path2<T>& Path<T, 2>::operator=(const Path& other) {
+  if (&other != this) {
+    Path(other, allocator_).storage_.swap(storage_);
+    ++generation_;
+  }
+  return *this;
+}
+
+template <class T>
+inline Path2<T>& Path<T, 2>::operator=(Path&& other) {
+  if (&other != this) {
+    Path(std::move(other), allocator_).storage_.swap(storage_);
+    ++generation_;
+  }
+  return *this;
+}
+
+#pragma mark Storage
+
+template <class T>
+inline Path<T, 2>::Storage::Storage(const allocator_type& allocator)
+    : verbs(allocator),
+      points(allocator),
+      weights(allocator) {}
+
+template <class T>
+inline Path<T, 2>::Storage::Storage(const Storage& other,
+                                    const allocator_type& allocator)
+    : verbs(other.verbs, allocator),
+      points(other.points, allocator),
+      weights(other.weights, allocator),
+      hash(other.hash),
+      approximate_bounds(other.approximate_bounds),
+      precise_bounds(other.precise_bounds),
+      segment_index(other.segment_index) {}
+
+template <class T>
+inline const typename Path<T, 2>::Storage& Path<T, 2>::storage() const {
+  static const Storage empty{allocator_type()};
+  return storage_ ? *storage_ : empty;
+}
+
+template <class T>
+inline typename Path<T, 2>::Storage& Path<T, 2>::detach() {
+  if (!storage_) {
+    storage_ = std::allocate_shared<Storage>(
+        PolymorphicAllocator<Storage>(allocator_), allocator_);
+  } else if (storage_.use_count() > 1) {
+    storage_ = std::allocate_shared<Storage>(
+        PolymorphicAllocator<Storage>(allocator_), *storage_, allocator_);
+  }
+  storage_->hash.reset();
+  storage_->approximate_bounds.reset();
+  storage_->precise_bounds.reset();
+  storage_->segment_index.reset();
+  ++generation_;
+  return *storage_;
+}
 
 #pragma mark Mutators
 
 template <class T>
 inline void Path<T, 2>::set(const std::list<Command2<T>>& commands) {
-  commands_ = commands;
+  reset();
+  auto& data = detach();
+  data.verbs.reserve(commands.size());
+  for (const auto& command : commands) {
+    data.verbs.emplace_back(command.type());
+    switch (command.type()) {
+      case CommandType::MOVE:
+      case CommandType::LINE:
+        data.points.emplace_back(command.point());
+        break;
+      case CommandType::QUADRATIC:
+        data.points.emplace_back(command.control());
+        data.points.emplace_back(command.point());
+        break;
+      case CommandType::CONIC:
+        data.points.emplace_back(command.control());
+        data.points.emplace_back(command.point());
+        data.weights.emplace_back(command.weight());
+        break;
+      case CommandType::CUBIC:
+        data.points.emplace_back(command.control1());
+        data.points.emplace_back(command.control2());
+        data.points.emplace_back(command.point());
+        break;
+      case CommandType::CLOSE:
+        break;
+      default:
+        assert(false);
+        break;
+    }
+  }
+}
+
+template <class T>
+inline void Path<T, 2>::set(Verbs&& verbs, Points&& points, Weights&& weights) {
+  auto& data = detach();
+  assert(std::accumulate(
+      std::begin(verbs), std::end(verbs), std::size_t(),
+      [](std::size_t count, CommandType type) {
+        return count + pointCount(type);
+      }) == points.size());
+  assert(static_cast<std::size_t>(std::count(
+      std::begin(verbs), std::end(verbs),
+      CommandType::CONIC)) == weights.size());
+  data.verbs = std::move(verbs);
+  data.points = std::move(points);
+  data.weights = std::move(weights);
 }
 
 template <class T>
 inline void Path<T, 2>::reset() {
-  commands_.clear();
+  if (shared()) {
+    storage_.reset();
+    ++generation_;
+  } else if (storage_) {
+    auto& data = detach();
+    data.verbs.clear();
+    data.points.clear();
+    data.weights.clear();
+  }
+}
+
+template <class T>
+inline void Path<T, 2>::reserve(std::size_t commands, std::size_t points) {
+  auto& data = detach();
+  data.verbs.reserve(commands);
+  data.points.reserve(points);
 }
 
 #pragma mark Comparison
 
 template <class T, class U>
 inline bool operator==(const Path2<T>& lhs, const Path2<U>& rhs) {
-  return lhs.commands() == rhs.commands();
+  return (lhs.verbs() == rhs.verbs() &&
+          lhs.points().size() == rhs.points().size() &&
+          lhs.weights().size() == rhs.weights().size() &&
+          std::equal(std::begin(lhs.points()), std::end(lhs.points()),
+                     std::begin(rhs.points())) &&
+          std::equal(std::begin(lhs.weights()), std::end(lhs.weights()),
+                     std::begin(rhs.weights())));
 }
 
 template <class T, class U>
@@ -233,17 +473,62 @@ inline bool operator!=(const Path2<T>& lhs, const Path2<U>& rhs) {
   return !(lhs == rhs);
 }
 
+template <class T>
+inline bool Path<T, 2>::equals(const Path& other) const {
+  if (storage_ == other.storage_) {
+    return true;
+  }
+  if (verbs().size() != other.verbs().size() ||
+      points().size() != other.points().size()) {
+    return false;
+  }
+  // Reject by hash or bounds only when both are already cached, since
+  // computing either walks the arrays just like the comparison below.
+  if (storage_ && other.storage_) {
+    const auto hash = storage_->hash.find();
+    const auto other_hash = other.storage_->hash.find();
+    if (hash && other_hash && *hash != *other_hash) {
+      return false;
+    }
+    const auto bounds = storage_->approximate_bounds.find();
+    const auto other_bounds = other.storage_->approximate_bounds.find();
+    if (bounds && other_bounds && !(*bounds == *other_bounds)) {
+      return false;
+    }
+  }
+  return (verbs() == other.verbs() &&
+          points() == other.points() &&
+          weights() == other.weights());
+}
+
+template <class T>
+inline std::size_t Path<T, 2>::hash() const {
+  if (!storage_) {
+    return calculateHash();
+  }
+  return storage_->hash.get([this] { return calculateHash(); });
+}
+
+template <class T>
+inline std::size_t Path<T, 2>::calculateHash() const {
+  std::size_t seed{};
+  hashCombine(seed, std::begin(verbs()), std::end(verbs()));
+  hashCombine(seed, std::begin(points()), std::end(points()));
+  hashCombine(seed, std::begin(weights()), std::end(weights()));
+  return seed;
+}
+
 #pragma mark Attributes
 
 template <class T>
 inline bool Path<T, 2>::closed() const {
-  if (commands_.size() < 3) {
+  if (verbs().size() < 3) {
     return false;
   }
-  if (commands_.back().type() == CommandType::CLOSE) {
+  if (verbs().back() == CommandType::CLOSE) {
     return true;
   }
-  if (commands_.back().point() == commands_.front().point()) {
+  if (points().back() == points().front()) {
     return true;
   }
   return false;
@@ -251,99 +536,57 @@ inline bool Path<T, 2>::closed() const {
 
 template <class T>
 inline Rect2<math::Promote<T>> Path<T, 2>::bounds(bool precise) const {
+  if (!storage_) {
+    return precise ? calculatePreciseBounds() : calculateApproximateBounds();
+  }
   if (precise) {
-    return calculatePreciseBounds();
+    return storage_->precise_bounds.get([this] {
+      return calculatePreciseBounds();
+    });
   }
-  return calculateApproximateBounds();
+  return storage_->approximate_bounds.get([this] {
+    return calculateApproximateBounds();
+  });
 }
 
 template <class T>
 template <class U>
 inline Rect2<U> Path<T, 2>::calculateApproximateBounds() const {
-  T min_x = std::numeric_limits<T>::max();
-  T min_y = std::numeric_limits<T>::max();
-  T max_x = std::numeric_limits<T>::lowest();
-  T max_y = std::numeric_limits<T>::lowest();
-  for (const auto& command : commands_) {
-    switch (command.type()) {
-      case CommandType::CUBIC:
-        if (command.control2().x < min_x) min_x = command.control2().x;
-        if (command.control2().y < min_y) min_y = command.control2().y;
-        if (command.control2().x > max_x) max_x = command.control2().x;
-        if (command.control2().y > max_y) max_y = command.control2().y;
-        // Pass through
-      case CommandType::CONIC:
-      case CommandType::QUADRATIC:
-        if (command.control().x < min_x) min_x = command.control().x;
-        if (command.control().y < min_y) min_y = command.control().y;
-        if (command.control().x > max_x) max_x = command.control().x;
-        if (command.control().y > max_y) max_y = command.control().y;
-        // Pass through
-      case CommandType::LINE:
-      case CommandType::MOVE:
-        if (command.point().x < min_x) min_x = command.point().x;
-        if (command.point().y < min_y) min_y = command.point().y;
-        if (command.point().x > max_x) max_x = command.point().x;
-        if (command.point().y > max_y) max_y = command.point().y;
-        break;
-      case CommandType::CLOSE:
-        break;
-      default:
-        assert(false);
-        break;
-    }
+  if (points().empty()) {
+    return Rect2<U>(Vec2<U>(), Vec2<U>());
   }
-  if (min_x == std::numeric_limits<T>::max()) min_x = T();
-  if (min_y == std::numeric_limits<T>::max()) min_y = T();
-  if (max_x == std::numeric_limits<T>::lowest()) max_x = T();
-  if (max_y == std::numeric_limits<T>::lowest()) max_y = T();
-  return Rect2<U>(Vec2<U>(min_x, min_y), Vec2<U>(max_x, max_y));
+  Vec2<T> min;
+  Vec2<T> max;
+  findBounds(points().data(), points().size(), &min, &max);
+  return Rect2<U>(Vec2<U>(min.x, min.y), Vec2<U>(max.x, max.y));
 }
 
 template <class T>
 template <class U>
 inline Rect2<U> Path<T, 2>::calculatePreciseBounds() const {
-  if (commands_.empty()) {
+  if (points().empty()) {
     return Rect2<U>();
   }
-  Rect2<U> result(commands_.front().point());
-  Vec2<U> extrema[4];
-  for (auto current = std::begin(commands_), previous = current++;
-       current != std::end(commands_); ++current, ++previous) {
-    switch (current->type()) {
-      case CommandType::CUBIC: {
-        result.include(current->point());
-        const auto count = findCubicExtrema(
-            previous->point(),
-            current->control1(),
-            current->control2(),
-            current->point(),
-            extrema);
-        for (int i{}; i < count; ++i) {
-          result.include(extrema[i]);
-        }
+  Rect2<U> result(points().front());
+  CurveBounds2<U> extrema;
+  auto point = points().data();
+  auto weight = weights().data();
+  for (const auto& type : verbs()) {
+    switch (type) {
+      case CommandType::CUBIC:
+        result.include(point[2]);
+        extrema.addCubic(point[-1], point[0], point[1], point[2]);
         break;
-      }
-      case CommandType::CONIC: {
-        // TODO(shotamatsuda): Calculate conic extrema
-        result.include(current->control());
-        result.include(current->point());
+      case CommandType::CONIC:
+        result.include(point[1]);
+        extrema.addConic(point[-1], point[0], point[1], *weight++);
         break;
-      }
-      case CommandType::QUADRATIC: {
-        result.include(current->point());
-        const auto count = findQuadraticExtrema(
-            previous->point(),
-            current->control(),
-            current->point(),
-            extrema);
-        for (int i{}; i < count; ++i) {
-          result.include(extrema[i]);
-        }
+      case CommandType::QUADRATIC:
+        result.include(point[1]);
+        extrema.addQuadratic(point[-1], point[0], point[1]);
         break;
-      }
       case CommandType::LINE:
-        result.include(current->point());
+        result.include(point[0]);
         break;
       case CommandType::MOVE:
       case CommandType::CLOSE:
@@ -352,102 +595,24 @@ inline Rect2<U> Path<T, 2>::calculatePreciseBounds() const {
         assert(false);
         break;
     }
+    point += pointCount(type);
   }
-  return std::move(result);
-}
-
-template <class T>
-template <class OutputIterator>
-inline unsigned int Path<T, 2>::findQuadraticExtrema(
-    const Vec2<T>& p0,
-    const Vec2<T>& p1,
-    const Vec2<T>& p2,
-    OutputIterator result) const {
-  const auto a = p0 - 2 * p1 + p2;
-  const auto b = p1 - p0;
-  math::Promote<T> x_root;
-  math::Promote<T> y_root;
-  const auto x_count = math::solveLinear(a.x, b.x, &x_root);
-  const auto y_count = math::solveLinear(a.y, b.y, &y_root);
-  unsigned int count{};
-  if(x_count > 0 && 0 < x_root && x_root < 1) {
-    *result++ = evaluateQuadraticAt(p0, p1, p2, x_root);
-    ++count;
-  }
-  if(y_count > 0 && 0 < y_root && y_root < 1) {
-    *result = evaluateQuadraticAt(p0, p1, p2, y_root);
-    ++count;
-  }
-  return count;
-}
-
-template <class T>
-template <class OutputIterator>
-inline unsigned int Path<T, 2>::findCubicExtrema(
-    const Vec2<T>& p0,
-    const Vec2<T>& p1,
-    const Vec2<T>& p2,
-    const Vec2<T>& p3,
-    OutputIterator result) const {
-  const auto a = 3 * p3 - 9 * p2 + 9 * p1 - 3 * p0;
-  const auto b = 6 * p0 - 12 * p1 + 6 * p2;
-  const auto c = 3 * p1 - 3 * p0;
-  math::Promote<T> x_roots[2];
-  math::Promote<T> y_roots[2];
-  const auto x_count = math::solveQuadratic(a.x, b.x, c.x, x_roots);
-  const auto y_count = math::solveQuadratic(a.y, b.y, c.y, y_roots);
-  unsigned int count{};
-  if(x_count > 0 && 0 < x_roots[0] && x_roots[0] < 1) {
-    *result++ = evaluateCubicAt(p0, p1, p2, p3, x_roots[0]);
-    ++count;
-  }
-  if(y_count > 0 && 0 < y_roots[0] && y_roots[0] < 1) {
-    *result++ = evaluateCubicAt(p0, p1, p2, p3, y_roots[0]);
-    ++count;
-  }
-  if(x_count > 1 && 0 < x_roots[1] && x_roots[1] < 1) {
-    *result++ = evaluateCubicAt(p0, p1, p2, p3, x_roots[1]);
-    ++count;
-  }
-  if(y_count > 1 && 0 < y_roots[1] && y_roots[1] < 1) {
-    *result = evaluateCubicAt(p0, p1, p2, p3, y_roots[1]);
-    ++count;
-  }
-  return count;
-}
-
-template <class T>
-template <class U>
-inline Vec2<U> Path<T, 2>::evaluateQuadraticAt(const Vec2<T>& p0,
-                                               const Vec2<T>& p1,
-                                               const Vec2<T>& p2,
-                                               U t) const {
-  const auto a = (1 - t) * (1 - t);
-  const auto b = 2 * (1 - t) * t;
-  const auto c = t * t;
-  return a * p0 + b * p1 + c * p2;
-}
-
-template <class T>
-template <class U>
-inline Vec2<U> Path<T, 2>::evaluateCubicAt(const Vec2<T>& p0,
-                                           const Vec2<T>& p1,
-                                           const Vec2<T>& p2,
-                                           const Vec2<T>& p3,
-                                           U t) const {
-  const auto a = (1 - t) * (1 - t) * (1 - t);
-  const auto b = 3 * (1 - t) * (1 - t) * t;
-  const auto c = 3 * (1 - t) * t * t;
-  const auto d = t * t * t;
-  return a * p0 + b * p1 + c * p2 + d * p3;
+  Vec2<U> min;
+  Vec2<U> max;
+  if (extrema.find(&min, &max)) {
+    result.include(min);
+    result.include(max);
+  }
+  return result;
 }
 
 #pragma mark Adding commands
 
 template <class T>
 inline void Path<T, 2>::close() {
-  if (commands_.back().type() != CommandType::CLOSE) {
-    commands_.emplace_back(CommandType::CLOSE);
+  auto& data = detach();
+  if (!data.verbs.empty() && data.verbs.back() != CommandType::CLOSE) {
+    data.verbs.emplace_back(CommandType::CLOSE);
   }
 }
 
@@ -458,8 +623,10 @@ inline void Path<T, 2>::moveTo(T x, T y) {
 
 template <class T>
 inline void Path<T, 2>::moveTo(const Vec2<T>& point) {
-  commands_.clear();
-  commands_.emplace_back(CommandType::MOVE, point);
+  reset();
+  auto& data = detach();
+  data.verbs.emplace_back(CommandType::MOVE);
+  data.points.emplace_back(point);
 }
 
 template <class T>
@@ -469,14 +636,16 @@ inline void Path<T, 2>::lineTo(T x, T y) {
 
 template <class T>
 inline void Path<T, 2>::lineTo(const Vec2<T>& point) {
-  if (commands_.empty()) {
+  auto& data = detach();
+  if (data.verbs.empty()) {
     moveTo(point);
   } else {
-    if (commands_.back().type() == CommandType::CLOSE) {
-      commands_.pop_back();
+    if (data.verbs.back() == CommandType::CLOSE) {
+      data.verbs.pop_back();
     }
-    commands_.emplace_back(CommandType::LINE, point);
-    if (point == commands_.front().point()) {
+    data.verbs.emplace_back(CommandType::LINE);
+    data.points.emplace_back(point);
+    if (point == data.points.front()) {
       close();
     }
   }
@@ -490,14 +659,17 @@ inline void Path<T, 2>::quadraticTo(T cx, T cy, T x, T y) {
 template <class T>
 inline void Path<T, 2>::quadraticTo(const Vec2<T>& control,
                                     const Vec2<T>& point) {
-  if (commands_.empty()) {
+  auto& data = detach();
+  if (data.verbs.empty()) {
     moveTo(point);
   } else {
-    if (commands_.back().type() == CommandType::CLOSE) {
-      commands_.pop_back();
+    if (data.verbs.back() == CommandType::CLOSE) {
+      data.verbs.pop_back();
     }
-    commands_.emplace_back(CommandType::QUADRATIC, control, point);
-    if (point == commands_.front().point()) {
+    data.verbs.emplace_back(CommandType::QUADRATIC);
+    data.points.emplace_back(control);
+    data.points.emplace_back(point);
+    if (point == data.points.front()) {
       close();
     }
   }
@@ -512,14 +684,18 @@ template <class T>
 inline void Path<T, 2>::conicTo(const Vec2<T>& control,
                                 const Vec2<T>& point,
                                 math::Promote<T> weight) {
-  if (commands_.empty()) {
+  auto& data = detach();
+  if (data.verbs.empty()) {
     moveTo(point);
   } else {
-    if (commands_.back().type() == CommandType::CLOSE) {
-      commands_.pop_back();
+    if (data.verbs.back() == CommandType::CLOSE) {
+      data.verbs.pop_back();
     }
-    commands_.emplace_back(CommandType::CONIC, control, point, weight);
-    if (point == commands_.front().point()) {
+    data.verbs.emplace_back(CommandType::CONIC);
+    data.points.emplace_back(control);
+    data.points.emplace_back(point);
+    data.weights.emplace_back(weight);
+    if (point == data.points.front()) {
       close();
     }
   }
@@ -534,35 +710,122 @@ template <class T>
 inline void Path<T, 2>::cubicTo(const Vec2<T>& control1,
                                 const Vec2<T>& control2,
                                 const Vec2<T>& point) {
-  if (commands_.empty()) {
+  auto& data = detach();
+  if (data.verbs.empty()) {
     moveTo(point);
   } else {
-    if (commands_.back().type() == CommandType::CLOSE) {
-      commands_.pop_back();
+    if (data.verbs.back() == CommandType::CLOSE) {
+      data.verbs.pop_back();
     }
-    commands_.emplace_back(CommandType::CUBIC, control1, control2, point);
-    if (point == commands_.front().point()) {
+    data.verbs.emplace_back(CommandType::CUBIC);
+    data.points.emplace_back(control1);
+    data.points.emplace_back(control2);
+    data.points.emplace_back(point);
+    if (point == data.points.front()) {
       close();
     }
   }
 }
 
+#pragma mark Commands
+
+template <class T>
+inline std::list<Command2<T>> Path<T, 2>::commands() const {
+  return std::list<Command2<T>>(begin(), end());
+}
+
+template <class T>
+inline void Path<T, 2>::setCommand(int index, const Command2<T>& command) {
+  assert(0 <= index && static_cast<std::size_t>(index) < size());
+  const auto offset = pointIndex(index);
+  const auto conic = static_cast<std::size_t>(std::count(
+      std::begin(verbs()), std::begin(verbs()) + index, CommandType::CONIC));
+  std::array<Vec2<T>, 3> replacement;
+  switch (command.type()) {
+    case CommandType::MOVE:
+    case CommandType::LINE:
+      replacement[0] = command.point();
+      break;
+    case CommandType::QUADRATIC:
+    case CommandType::CONIC:
+      replacement[0] = command.control();
+      replacement[1] = command.point();
+      break;
+    case CommandType::CUBIC:
+      replacement[0] = command.control1();
+      replacement[1] = command.control2();
+      replacement[2] = command.point();
+      break;
+    case CommandType::CLOSE:
+      break;
+    default:
+      assert(false);
+      break;
+  }
+  auto& data = detach();
+  auto& type = data.verbs[index];
+  const auto previous = pointCount(type);
+  const auto count = pointCount(command.type());
+  const auto point = std::begin(data.points) + offset;
+  if (count > previous) {
+    data.points.insert(point + previous, count - previous, Vec2<T>());
+  } else {
+    data.points.erase(point + count, point + previous);
+  }
+  std::copy(std::begin(replacement), std::begin(replacement) + count,
+            std::begin(data.points) + offset);
+  const auto weight = std::begin(data.weights) + conic;
+  if (command.type() == CommandType::CONIC) {
+    if (type == CommandType::CONIC) {
+      *weight = command.weight();
+    } else {
+      data.weights.insert(weight, command.weight());
+    }
+  } else if (type == CommandType::CONIC) {
+    data.weights.erase(weight);
+  }
+  type = command.type();
+}
+
+template <class T>
+inline void Path<T, 2>::setPoint(int index, const Vec2<T>& point) {
+  assert(0 <= index && static_cast<std::size_t>(index) < size());
+  const auto count = pointCount(verbs()[index]);
+  assert(count);
+  const auto offset = pointIndex(index) + count - 1;
+  detach().points[offset] = point;
+}
+
+template <class T>
+inline std::size_t Path<T, 2>::pointIndex(int index) const {
+  return std::accumulate(
+      std::begin(verbs()), std::begin(verbs()) + index, std::size_t(),
+      [](std::size_t count, CommandType type) {
+        return count + pointCount(type);
+      });
+}
+
 #pragma mark Direction
 
 template <class T>
 inline PathDirection Path<T, 2>::direction() const {
-  if (commands_.size() < 3 || !closed()) {
+  if (verbs().size() < 3 || !closed()) {
     return PathDirection::UNDEFINED;
   }
   T sum{};
-  for (auto next = std::begin(commands_), current = next++;
-       current != std::end(commands_); ++current, ++next) {
-    if (next != std::end(commands_)) {
-      sum += current->point().cross(next->point());
-    } else {
-      sum += current->point().cross(commands_.front().point());
+  const Vec2<T> *previous{};
+  auto point = points().data();
+  for (const auto& type : verbs()) {
+    if (type == CommandType::CLOSE) {
+      continue;
+    }
+    point += pointCount(type);
+    if (previous) {
+      sum += previous->cross(point[-1]);
     }
+    previous = point - 1;
   }
+  sum += previous->cross(points().front());
   if (!sum) {
     return PathDirection::UNDEFINED;
   }
@@ -571,194 +834,514 @@ inline PathDirection Path<T, 2>::direction() const {
 
 template <class T>
 inline Path2<T>& Path<T, 2>::reverse() {
-  if (commands_.empty()) {
+  if (empty()) {
     return *this;
   }
-  std::list<Holder> holders;
-  for (auto& command : commands_) {
-    switch (command.type()) {
+  auto& data = detach();
+  // Reversing the whole point array makes each command's control points
+  // precede their new end point, in reverse order, which is exactly the
+  // layout of the reversed commands.
+  if (data.verbs.back() == CommandType::CLOSE) {
+    std::reverse(std::next(std::begin(data.verbs)),
+                 std::prev(std::end(data.verbs)));
+  } else {
+    std::reverse(std::next(std::begin(data.verbs)), std::end(data.verbs));
+  }
+  std::reverse(std::begin(data.points), std::end(data.points));
+  std::reverse(std::begin(data.weights), std::end(data.weights));
+  return *this;
+}
+
+template <class T>
+inline Path2<T> Path<T, 2>::reversed() const {
+  Path result(*this);
+  result.reverse();
+  return result;
+}
+
+template <class T>
+inline ReversedPathView2<T> Path<T, 2>::reversedView() const {
+  return ReversedPathView2<T>(verbs().data(), verbs().size(),
+                              points().data() + points().size(),
+                              weights().data() + weights().size());
+}
+
+#pragma mark Hit testing
+
+template <class T>
+inline bool Path<T, 2>::contains(const Vec2<T>& point, FillRule rule) const {
+  const auto winding = this->winding(point);
+  switch (rule) {
+    case FillRule::NON_ZERO:
+      return winding;
+    case FillRule::EVEN_ODD:
+      return winding & 1;
+    default:
+      assert(false);
+      break;
+  }
+  return false;
+}
+
+// Rejects points outside of the cached bounds before consulting the index,
+// whose bands span the rows from the top of the bounds up to their bottom.
+template <class T>
+inline int Path<T, 2>::winding(const Vec2<T>& point) const {
+  if (empty()) {
+    return 0;
+  }
+  const auto bounds = this->bounds();
+  if (point.x < bounds.minX() || point.x > bounds.maxX() ||
+      point.y < bounds.minY() || !(point.y < bounds.maxY())) {
+    return 0;
+  }
+  using Scalar = math::Promote<T>;
+  return segmentIndex()->winding(Vec2<Scalar>(point.x, point.y));
+}
+
+template <class T>
+inline std::shared_ptr<const SegmentIndex2<T>>
+    Path<T, 2>::segmentIndex() const {
+  const auto build = [this] {
+    return std::shared_ptr<const SegmentIndex2<T>>(
+        std::make_shared<SegmentIndex2<T>>(verbs(), points(), weights()));
+  };
+  if (!storage_) {
+    return build();
+  }
+  return storage_->segment_index.get(build);
+}
+
+#pragma mark Conversion
+
+template <class T>
+inline bool Path<T, 2>::convertQuadraticsToCubics() {
+  const auto quadratics = std::count(std::begin(verbs()), std::end(verbs()),
+                                     CommandType::QUADRATIC);
+  if (!quadratics) {
+    return false;
+  }
+  auto& data = detach();
+  Points points(data.points.get_allocator());
+  points.reserve(data.points.size() + quadratics);
+  auto point = std::begin(data.points);
+  for (auto& type : data.verbs) {
+    const auto count = pointCount(type);
+    if (type == CommandType::QUADRATIC) {
+      const auto a = points.back();
+      const auto b = point[0];
+      const auto c = point[1];
+      type = CommandType::CUBIC;
+      points.emplace_back(a + (b - a) * 2 / 3);
+      points.emplace_back(c + (b - c) * 2 / 3);
+      points.emplace_back(c);
+    } else {
+      points.insert(std::end(points), point, point + count);
+    }
+    point += count;
+  }
+  data.points.swap(points);
+  return true;
+}
+
+template <class T>
+inline bool Path<T, 2>::convertConicsToQuadratics() {
+  ConicSubdivider2<T> subdivider;
+  const auto changed = subdivideConics([](const Conic2<T>&) {
+    return 1U;
+  }, &subdivider);
+  subdivider.flush();
+  return changed;
+}
+
+template <class T>
+inline bool Path<T, 2>::convertConicsToQuadratics(math::Promote<T> tolerance) {
+  ConicSubdivider2<T> subdivider;
+  const auto changed = convertConicsToQuadratics(tolerance, &subdivider);
+  subdivider.flush();
+  return changed;
+}
+
+// Conics are handed to the subdivider, which writes their quadratics when a
+// packet of conics at the same level fills up or when it is flushed. The
+// path holds unspecified points in their place until then, which is why this
+// is private: Shape batches the conics of all its paths in one subdivider,
+// and flushes it before returning.
+template <class T>
+inline bool Path<T, 2>::convertConicsToQuadratics(
+    math::Promote<T> tolerance,
+    ConicSubdivider2<T> *subdivider) {
+  return subdivideConics([tolerance](const Conic2<T>& conic) {
+    return conic.subdivision(tolerance);
+  }, subdivider);
+}
+
+template <class T>
+template <class Subdivision>
+inline bool Path<T, 2>::subdivideConics(Subdivision subdivision,
+                                        ConicSubdivider2<T> *subdivider) {
+  assert(subdivider);
+  if (weights().empty()) {
+    return false;
+  }
+  // Size the new arrays exactly in a first pass, so that the quadratics can
+  // be written in place without reallocating.
+  std::size_t verb_count{};
+  std::size_t point_count{};
+  auto point = points().data();
+  auto weight = weights().data();
+  for (const auto& type : verbs()) {
+    const auto count = pointCount(type);
+    if (type == CommandType::CONIC) {
+      const Conic2<T> conic(point[-1], point[0], point[1], *weight++);
+      const std::size_t quadratics = 1U << subdivision(conic);
+      verb_count += quadratics;
+      point_count += quadratics * 2;
+    } else {
+      ++verb_count;
+      point_count += count;
+    }
+    point += count;
+  }
+  Verbs result_verbs(allocator_);
+  Points result_points(point_count, Vec2<T>(), allocator_);
+  result_verbs.reserve(verb_count);
+  auto output = std::begin(result_points);
+  point = points().data();
+  weight = weights().data();
+  for (const auto& type : verbs()) {
+    const auto count = pointCount(type);
+    if (type == CommandType::CONIC) {
+      const Conic2<T> conic(point[-1], point[0], point[1], *weight++);
+      const auto level = subdivision(conic);
+      const std::size_t quadratics = 1U << level;
+      result_verbs.insert(std::end(result_verbs), quadratics,
+                          CommandType::QUADRATIC);
+      subdivider->add(conic, level, &*output);
+      output += quadratics * 2;
+    } else {
+      result_verbs.emplace_back(type);
+      output = std::copy(point, point + count, output);
+    }
+    point += count;
+  }
+  assert(output == std::end(result_points));
+  reset();
+  auto& data = detach();
+  data.verbs.swap(result_verbs);
+  data.points.swap(result_points);
+  return true;
+}
+
+template <class T>
+inline bool Path<T, 2>::normalize(PathNormalization normalization,
+                                  math::Promote<T> tolerance) {
+  ConicSubdivider2<T> subdivider;
+  const auto changed = normalize(normalization, tolerance, &subdivider);
+  subdivider.flush();
+  return changed;
+}
+
+// Rewrites the path in a single pass into arrays sized exactly beforehand.
+// Conics are converted to quadratics within the tolerance, cubics are
+// approximated by quadratics within the tolerance, and lines and quadratics
+// are raised in degree exactly. As with convertConicsToQuadratics, the
+// quadratics of conics are written when the subdivider is flushed if the
+// path is normalized to quadratics, so only Shape batches across paths.
+template <class T>
+inline bool Path<T, 2>::normalize(PathNormalization normalization,
+                                  math::Promote<T> tolerance,
+                                  ConicSubdivider2<T> *subdivider) {
+  assert(subdivider);
+  const auto cubics = normalization == PathNormalization::CUBICS;
+  const auto target = cubics ? CommandType::CUBIC : CommandType::QUADRATIC;
+  const auto degree = pointCount(target);
+  bool changed{};
+  std::size_t verb_count{};
+  std::size_t point_count{};
+  auto point = points().data();
+  auto weight = weights().data();
+  for (const auto& type : verbs()) {
+    const auto count = pointCount(type);
+    std::size_t curves{};
+    switch (type) {
       case CommandType::MOVE:
-      case CommandType::LINE:
-        holders.emplace_back(command.point());
+        ++verb_count;
+        ++point_count;
         break;
+      case CommandType::CLOSE:
+        ++verb_count;
+        break;
+      case CommandType::LINE:
       case CommandType::QUADRATIC:
-        holders.emplace_back(command.control());
-        holders.emplace_back(command.point());
+        curves = 1;
         break;
-      case CommandType::CONIC:
-        holders.emplace_back(command.control());
-        holders.emplace_back(command.weight());
-        holders.emplace_back(command.point());
+      case CommandType::CONIC: {
+        const Conic2<T> conic(point[-1], point[0], point[1], *weight++);
+        curves = std::size_t(1) << conic.subdivision(tolerance);
         break;
+      }
       case CommandType::CUBIC:
-        holders.emplace_back(command.control1());
-        holders.emplace_back(command.control2());
-        holders.emplace_back(command.point());
-        break;
-      case CommandType::CLOSE:
+        curves = cubics ? 1 : approximation(point, tolerance);
         break;
       default:
         assert(false);
         break;
     }
+    if (curves && type != target) {
+      changed = true;
+    }
+    verb_count += curves;
+    point_count += curves * degree;
+    point += count;
   }
-  if (commands_.back().type() == CommandType::CLOSE) {
-    std::reverse(std::next(std::begin(commands_)),
-                 std::prev(std::end(commands_)));
-  } else {
-    std::reverse(std::next(std::begin(commands_)),
-                 std::end(commands_));
+  if (!changed) {
+    return false;
   }
-  std::reverse(std::begin(holders), std::end(holders));
-  auto itr = std::begin(holders);
-  for (auto& command : commands_) {
-    switch (command.type()) {
+  Verbs result_verbs(allocator_);
+  Points result_points(point_count, Vec2<T>(), allocator_);
+  result_verbs.reserve(verb_count);
+  auto output = std::begin(result_points);
+  point = points().data();
+  weight = weights().data();
+  for (const auto& type : verbs()) {
+    const auto count = pointCount(type);
+    switch (type) {
       case CommandType::MOVE:
-      case CommandType::LINE:
-        command.point() = *(itr++);
+      case CommandType::CLOSE:
+        result_verbs.emplace_back(type);
+        output = std::copy(point, point + count, output);
         break;
-      case CommandType::QUADRATIC:
-        command.control() = *(itr++);
-        command.point() = *(itr++);
+      case CommandType::LINE: {
+        const auto& a = point[-1];
+        result_verbs.emplace_back(target);
+        if (cubics) {
+          *output++ = a + (point[0] - a) / 3;
+          *output++ = point[0] + (a - point[0]) / 3;
+        } else {
+          *output++ = (a + point[0]) / 2;
+        }
+        *output++ = point[0];
         break;
-      case CommandType::CONIC:
-        command.weight() = *(itr++);
-        command.control() = *(itr++);
-        command.point() = *(itr++);
+      }
+      case CommandType::QUADRATIC: {
+        const auto& a = point[-1];
+        result_verbs.emplace_back(target);
+        if (cubics) {
+          *output++ = a + (point[0] - a) * 2 / 3;
+          *output++ = point[1] + (point[0] - point[1]) * 2 / 3;
+          *output++ = point[1];
+        } else {
+          output = std::copy(point, point + count, output);
+        }
         break;
-      case CommandType::CUBIC:
-        command.control1() = *(itr++);
-        command.control2() = *(itr++);
-        command.point() = *(itr++);
+      }
+      case CommandType::CONIC: {
+        const auto& a = point[-1];
+        const Conic2<T> conic(a, point[0], point[1], *weight++);
+        const auto level = conic.subdivision(tolerance);
+        const std::size_t quadratics = 1U << level;
+        result_verbs.insert(std::end(result_verbs), quadratics, target);
+        if (!cubics) {
+          subdivider->add(conic, level, &*output);
+          output += quadratics * 2;
+          break;
+        }
+        std::array<Vec2<T>, 2U << Conic2<T>::max_subdivision> buffer;
+        const auto end = conic.subdivide(level, std::begin(buffer));
+        auto previous = a;
+        for (auto control = std::begin(buffer); control != end; control += 2) {
+          *output++ = previous + (control[0] - previous) * 2 / 3;
+          *output++ = control[1] + (control[0] - control[1]) * 2 / 3;
+          *output++ = previous = control[1];
+        }
         break;
-      case CommandType::CLOSE:
+      }
+      case CommandType::CUBIC:
+        if (cubics) {
+          result_verbs.emplace_back(target);
+          output = std::copy(point, point + count, output);
+        } else {
+          const auto quadratics = approximation(point, tolerance);
+          result_verbs.insert(std::end(result_verbs), quadratics, target);
+          output = approximate(point, quadratics, output);
+        }
         break;
       default:
         assert(false);
         break;
     }
+    point += count;
   }
-  assert(itr == std::end(holders));
-  return *this;
+  assert(result_verbs.size() == verb_count);
+  assert(output == std::end(result_points));
+  reset();
+  auto& data = detach();
+  data.verbs.swap(result_verbs);
+  data.points.swap(result_points);
+  return true;
 }
 
+// Returns the number of quadratics that approximate the cubic ending at the
+// given points within the tolerance. A quadratic whose control point is
+// (3 * (b + c) - a - d) / 4 deviates from the cubic by at most
+// sqrt(3) / 36 * |d - 3 * c + 3 * b - a|, and the third difference shrinks
+// with the cube of the number of equal parts.
 template <class T>
-inline Path2<T> Path<T, 2>::reversed() const {
-  return std::move(Path(*this).reverse());
-}
-
-#pragma mark Conversion
-
-template <class T>
-inline bool Path<T, 2>::convertQuadraticsToCubics() {
-  bool changed{};
-  for (auto current = std::begin(commands_), previous = current++;
-       current != std::end(commands_);) {
-    if (current->type() != CommandType::QUADRATIC) {
-      previous = current++;
-      continue;
-    }
-    const auto a = previous->point();
-    const auto b = current->control();
-    const auto c = current->point();
-    current->type() = CommandType::CUBIC;
-    current->control1() = a + (b - a) * 2 / 3;
-    current->control2() = c + (b - c) * 2 / 3;
-    changed = true;
+inline unsigned int Path<T, 2>::approximation(const Vec2<T> *point,
+                                              math::Promote<T> tolerance) {
+  using Scalar = math::Promote<T>;
+  constexpr const unsigned int max_count = 1U << Conic2<T>::max_subdivision;
+  const auto x = Scalar(point[2].x) - 3 * Scalar(point[1].x) +
+                 3 * Scalar(point[0].x) - Scalar(point[-1].x);
+  const auto y = Scalar(point[2].y) - 3 * Scalar(point[1].y) +
+                 3 * Scalar(point[0].y) - Scalar(point[-1].y);
+  const auto error = std::sqrt(3 * (x * x + y * y)) / 36;
+  if (!(error > tolerance)) {
+    return 1;
   }
-  return changed;
+  const auto count = std::ceil(std::cbrt(error / tolerance));
+  if (!(count < max_count)) {
+    return max_count;
+  }
+  return static_cast<unsigned int>(count);
 }
 
+// Writes the control and end points of the quadratics approximating equal
+// parts of the cubic. The part over [t0, t1] has the end points of the cubic
+// there, and its control point is the midpoint of them offset by
+// (t1 - t0) * (B'(t0) - B'(t1)) / 4.
 template <class T>
-inline bool Path<T, 2>::convertConicsToQuadratics() {
-  using F = std::vector<Vec2<T>> (Conic2<T>::*)(void) const;
-  return convertConicsToQuadratics(static_cast<F>(&Conic2<T>::quadratics));
+template <class OutputIterator>
+inline OutputIterator Path<T, 2>::approximate(const Vec2<T> *point,
+                                              unsigned int count,
+                                              OutputIterator result) {
+  using Scalar = math::Promote<T>;
+  using Point = Vec2<Scalar>;
+  const Point p0(point[-1].x, point[-1].y);
+  const Point p1(point[0].x, point[0].y);
+  const Point p2(point[1].x, point[1].y);
+  const Point p3(point[2].x, point[2].y);
+  const auto a = p3 - p2 * 3 + p1 * 3 - p0;
+  const auto b = (p2 - p1 * 2 + p0) * 3;
+  const auto c = (p1 - p0) * 3;
+  const auto step = Scalar(1) / count;
+  auto start = p0;
+  auto derivative = c;
+  for (unsigned int i{1}; i <= count; ++i) {
+    const auto t = i == count ? Scalar(1) : step * i;
+    const auto end = i == count ? p3 : ((a * t + b) * t + c) * t + p0;
+    const auto next = (a * (3 * t) + b * 2) * t + c;
+    const auto control = (start + end) / 2 + (derivative - next) * (step / 4);
+    *result++ = Vec2<T>(static_cast<T>(control.x), static_cast<T>(control.y));
+    *result++ = i == count ? point[2]
+                           : Vec2<T>(static_cast<T>(end.x),
+                                     static_cast<T>(end.y));
+    start = end;
+    derivative = next;
+  }
+  return result;
 }
 
 template <class T>
-inline bool Path<T, 2>::convertConicsToQuadratics(math::Promote<T> tolerance) {
-  using F = std::vector<Vec2<T>> (Conic2<T>::*)(math::Promote<T>) const;
-  return convertConicsToQuadratics(static_cast<F>(&Conic2<T>::quadratics),
-                                   tolerance);
-}
+inline bool Path<T, 2>::removeDuplicates(math::Promote<T> threshold) {
+  const auto duplicate = [threshold](CommandType type, const Vec2<T> *point) {
+    return type != CommandType::CLOSE &&
+           point[pointCount(type) - 1].equals(point[-1], threshold);
+  };
 
-template <class T>
-template <
-  class Method, class... Args,
-  std::enable_if_t<std::is_member_pointer<Method>::value> *&
->
-inline bool Path<T, 2>::convertConicsToQuadratics(Method method,
-                                                  Args&&... args) {
-  assert(method);
-  bool changed{};
-  for (auto current = std::begin(commands_), previous = current++;
-       current != std::end(commands_);) {
-    if (current->type() != CommandType::CONIC) {
-      previous = current++;
-      continue;
+  // Find the first duplicate before detaching, so that a path without any
+  // stays shared.
+  std::size_t verb_index{};
+  std::size_t point_index{};
+  std::size_t weight_index{};
+  for (; verb_index < verbs().size(); ++verb_index) {
+    const auto type = verbs()[verb_index];
+    if (point_index && duplicate(type, points().data() + point_index)) {
+      break;
     }
-    const Conic2<T> conic(previous->point(),
-                          current->control(),
-                          current->point(),
-                          current->weight());
-    const auto points = (conic.*method)(args...);
-    current = commands_.erase(current);
-    for (auto itr = std::begin(points); itr != std::end(points); ++itr) {
-      current = commands_.emplace(current, CommandType::QUADRATIC,
-                                  *itr, *(++itr));
-      previous = current++;
+    point_index += pointCount(type);
+    if (type == CommandType::CONIC) {
+      ++weight_index;
     }
-    changed = true;
   }
-  return changed;
-}
+  if (verb_index == verbs().size()) {
+    return false;
+  }
 
-template <class T>
-inline bool Path<T, 2>::removeDuplicates(math::Promote<T> threshold) {
-  bool changed{};
-  std::list<std::list<Iterator>> duplicates;
-  bool duplicated{};
-  for (auto current = std::begin(commands_), previous = current++;
-       current != std::end(commands_); ++current, ++previous) {
-    if (current->point().equals(previous->point(), threshold)) {
-      if (!duplicated) {
-        duplicates.emplace_back();
-        duplicates.back().emplace_back(previous);
+  // Compact the arrays in place from there. The first command of each run of
+  // duplicates is kept, and its end point is moved to the midpoint of the
+  // run. Writing never overtakes reading, and every command read after the
+  // first duplicate is behind at least one dropped point, so the point
+  // before each command is still intact when it is compared.
+  auto& data = detach();
+  auto verb = data.verbs.data() + verb_index;
+  auto point = data.points.data() + point_index;
+  auto weight = data.weights.data() + weight_index;
+  auto verb_output = verb;
+  auto point_output = point;
+  auto weight_output = weight;
+  const auto verb_end = data.verbs.data() + data.verbs.size();
+  Vec2<T> front;
+  Vec2<T> back;
+  bool merging{};
+  for (; verb != verb_end; ++verb) {
+    const auto type = *verb;
+    const auto count = pointCount(type);
+    if (duplicate(type, point)) {
+      if (!merging) {
+        front = point[-1];
+        merging = true;
       }
-      duplicates.back().emplace_back(current);
-      duplicated = true;
-      changed = true;
+      back = point[count - 1];
     } else {
-      duplicated = false;
+      if (merging) {
+        point_output[-1] = (front + back) / 2;
+        merging = false;
+      }
+      *verb_output++ = type;
+      for (std::size_t i{}; i < count; ++i) {
+        *point_output++ = point[i];
+      }
+      if (type == CommandType::CONIC) {
+        *weight_output++ = *weight;
+      }
     }
-  }
-  for (auto& commands : duplicates) {
-    assert(commands.size() > 1);
-    for (auto itr = std::next(std::begin(commands));
-         itr != std::end(commands); ++itr) {
-      commands_.erase(*itr);
+    if (type == CommandType::CONIC) {
+      ++weight;
     }
-    const auto& front = commands.front()->point();
-    const auto& back = commands.back()->point();
-    commands.front()->point() = (front + back) / 2;
+    point += count;
   }
-  return changed;
+  if (merging) {
+    point_output[-1] = (front + back) / 2;
+  }
+  data.verbs.resize(verb_output - data.verbs.data());
+  data.points.resize(point_output - data.points.data());
+  data.weights.resize(weight_output - data.weights.data());
+  return true;
 }
 
 #pragma mark Element access
 
 template <class T>
-inline Command2<T>& Path<T, 2>::at(int index) {
-  auto itr = std::begin(commands_);
+inline CommandView2<T> Path<T, 2>::at(int index) const {
+  auto itr = begin();
   std::advance(itr, index);
   return *itr;
 }
 
+#pragma mark Iterator
+
 template <class T>
-inline const Command2<T>& Path<T, 2>::at(int index) const {
-  auto itr = std::begin(commands_);
-  std::advance(itr, index);
-  return *itr;
+inline typename Path<T, 2>::ConstIterator Path<T, 2>::begin() const {
+  return ConstIterator(verbs().data(), points().data(), weights().data());
+}
+
+template <class T>
+inline typename Path<T, 2>::ConstIterator Path<T, 2>::end() const {
+  return ConstIterator(verbs().data() + verbs().size(),
+                       points().data() + points().size(),
+                       weights().data() + weights().size());
 }
 
 }  // namespace graphics
@@ -773,4 +1356,15 @@ using graphics::Path2d;
 
 }  // namespace shotamatsuda
 
+namespace std {
+
+template <class T>
+struct hash<shotamatsuda::graphics::Path2<T>> {
+  std::size_t operator()(const shotamatsuda::graphics::Path2<T>& path) const {
+    return path.hash();
+  }
+};
+
+}  // namespace std
+
 #endif  // SHOTA_GRAPHICS_PATH2_H_
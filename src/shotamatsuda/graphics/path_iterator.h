@@ -0,0 +1,175 @@
+//
+//  shotamatsuda/graphics/path_iterator.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_PATH_ITERATOR_H_
+#define SHOTA_GRAPHICS_PATH_ITERATOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+
+#include "shotamatsuda/graphics/command.h"
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/command_view.h"
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class PathIterator;
+
+template <class T>
+using PathIterator2 = PathIterator<T, 2>;
+
+// Walks the verb, point and weight arrays of a path in lockstep, and yields a
+// view of the packed command for each verb on dereference.
+template <class T>
+class PathIterator<T, 2> final {
+ public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = Command2<T>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = CommandView2<T>;
+  using reference = CommandView2<T>;
+
+ public:
+  PathIterator();
+  PathIterator(const CommandType *verb,
+               const Vec2<T> *point,
+               const math::Promote<T> *weight);
+
+  // Copy semantics
+  PathIterator(const PathIterator&) = default;
+  PathIterator& operator=(const PathIterator&) = default;
+
+  // Move semantics
+  PathIterator(PathIterator&&) = default;
+  PathIterator& operator=(PathIterator&&) = default;
+
+  // Comparison
+  bool operator==(const PathIterator& other) const;
+  bool operator!=(const PathIterator& other) const;
+
+  // Iterator
+  reference operator*() const;
+  pointer operator->() const { return **this; }
+  PathIterator& operator++();
+  PathIterator operator++(int);
+  PathIterator& operator--();
+  PathIterator operator--(int);
+
+ private:
+  const CommandType *verb_;
+  const Vec2<T> *point_;
+  const math::Promote<T> *weight_;
+};
+
+#pragma mark -
+
+template <class T>
+inline PathIterator<T, 2>::PathIterator()
+    : verb_(),
+      point_(),
+      weight_() {}
+
+template <class T>
+inline PathIterator<T, 2>::PathIterator(const CommandType *verb,
+                                        const Vec2<T> *point,
+                                        const math::Promote<T> *weight)
+    : verb_(verb),
+      point_(point),
+      weight_(weight) {}
+
+#pragma mark Comparison
+
+template <class T>
+inline bool PathIterator<T, 2>::operator==(const PathIterator& other) const {
+  return verb_ == other.verb_;
+}
+
+template <class T>
+inline bool PathIterator<T, 2>::operator!=(const PathIterator& other) const {
+  return !(*this == other);
+}
+
+#pragma mark Iterator
+
+template <class T>
+inline CommandView2<T> PathIterator<T, 2>::operator*() const {
+  assert(verb_);
+  return CommandView2<T>(*verb_, point_,
+                         *verb_ == CommandType::CONIC ? weight_ : nullptr);
+}
+
+template <class T>
+inline PathIterator2<T>& PathIterator<T, 2>::operator++() {
+  assert(verb_);
+  const auto type = *verb_++;
+  point_ += pointCount(type);
+  if (type == CommandType::CONIC) {
+    ++weight_;
+  }
+  return *this;
+}
+
+template <class T>
+inline PathIterator2<T> PathIterator<T, 2>::operator++(int) {
+  PathIterator result(*this);
+  ++*this;
+  return result;
+}
+
+template <class T>
+inline PathIterator2<T>& PathIterator<T, 2>::operator--() {
+  assert(verb_);
+  const auto type = *--verb_;
+  point_ -= pointCount(type);
+  if (type == CommandType::CONIC) {
+    --weight_;
+  }
+  return *this;
+}
+
+template <class T>
+inline PathIterator2<T> PathIterator<T, 2>::operator--(int) {
+  PathIterator result(*this);
+  --*this;
+  return result;
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::PathIterator;
+using graphics::PathIterator2;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_PATH_ITERATOR_H_
@@ -0,0 +1,384 @@
+//
+//  shotamatsuda/graphics/path_measure.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_PATH_MEASURE_H_
+#define SHOTA_GRAPHICS_PATH_MEASURE_H_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/conic.h"
+#include "shotamatsuda/graphics/curve_measure.h"
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class PathMeasure;
+
+template <class T>
+using PathMeasure2 = PathMeasure<T, 2>;
+
+// Measures the arc length along a path or a shape once, and answers the
+// position and tangent at any distance along it. The distance runs through
+// the contours in order, including the closing segments of closed contours,
+// while moves between contours add nothing to it.
+//
+// The chords that CurveMeasure takes of every segment are kept in one table
+// of cumulative distances, with the segment each chord belongs to, so that a
+// query is a single binary search followed by an evaluation of the segment at
+// the parameter interpolated along the chord. Queries with sorted distances
+// can be answered in a batch by walking the table forward instead.
+template <class T>
+class PathMeasure<T, 2> final {
+ public:
+  using Type = T;
+  using Scalar = math::Promote<T>;
+  using Sample = std::pair<Vec2<Scalar>, Vec2<Scalar>>;
+  static constexpr const int dimensions = 2;
+
+ public:
+  explicit PathMeasure(Scalar tolerance = 0.25);
+  explicit PathMeasure(const Path2<T>& path, Scalar tolerance = 0.25);
+  explicit PathMeasure(const Shape2<T>& shape, Scalar tolerance = 0.25);
+
+  // Copy semantics
+  PathMeasure(const PathMeasure&) = default;
+  PathMeasure& operator=(const PathMeasure&) = default;
+
+  // Move semantics
+  PathMeasure(PathMeasure&&) = default;
+  PathMeasure& operator=(PathMeasure&&) = default;
+
+  // Mutators
+  void set(const Path2<T>& path);
+  void set(const Shape2<T>& shape);
+  void reset();
+
+  // Attributes
+  bool empty() const { return segments_.empty(); }
+  std::size_t size() const { return segments_.size(); }
+  Scalar length() const { return distances_.back(); }
+  Scalar tolerance() const { return measure_.tolerance(); }
+
+  // Measuring
+  Vec2<Scalar> position(Scalar distance) const;
+  Vec2<Scalar> tangent(Scalar distance) const;
+  Sample sample(Scalar distance) const;
+  template <class InputIterator, class OutputIterator>
+  OutputIterator sample(InputIterator first,
+                        InputIterator last,
+                        OutputIterator result) const;
+
+ private:
+  struct Segment {
+    CommandType type;
+    std::size_t point;
+    Scalar weight;
+    std::size_t chord;
+    unsigned int count;
+  };
+
+ private:
+  void add(const Path2<T>& path);
+  void addSegment(CommandType type,
+                  const Vec2<T> *points,
+                  Scalar weight = 1);
+  std::size_t find(Scalar distance) const;
+  Sample evaluate(std::size_t chord, Scalar distance) const;
+  static Vec2<Scalar> promote(const Vec2<T>& point);
+
+ private:
+  CurveMeasure2<T> measure_;
+  std::vector<Segment> segments_;
+  std::vector<Vec2<Scalar>> points_;
+  std::vector<Scalar> distances_;
+  std::vector<std::uint32_t> chords_;
+};
+
+using PathMeasure2i = PathMeasure2<int>;
+using PathMeasure2f = PathMeasure2<float>;
+using PathMeasure2d = PathMeasure2<double>;
+
+#pragma mark -
+
+template <class T>
+inline PathMeasure<T, 2>::PathMeasure(Scalar tolerance)
+    : measure_(tolerance),
+      distances_(1) {}
+
+template <class T>
+inline PathMeasure<T, 2>::PathMeasure(const Path2<T>& path,
+                                      Scalar tolerance)
+    : PathMeasure(tolerance) {
+  add(path);
+}
+
+template <class T>
+inline PathMeasure<T, 2>::PathMeasure(const Shape2<T>& shape,
+                                      Scalar tolerance)
+    : PathMeasure(tolerance) {
+  set(shape);
+}
+
+#pragma mark Mutators
+
+template <class T>
+inline void PathMeasure<T, 2>::set(const Path2<T>& path) {
+  reset();
+  add(path);
+}
+
+template <class T>
+inline void PathMeasure<T, 2>::set(const Shape2<T>& shape) {
+  reset();
+  for (const auto& path : shape.paths()) {
+    add(path);
+  }
+}
+
+template <class T>
+inline void PathMeasure<T, 2>::reset() {
+  segments_.clear();
+  points_.clear();
+  distances_.resize(1);
+  chords_.clear();
+}
+
+template <class T>
+inline void PathMeasure<T, 2>::add(const Path2<T>& path) {
+  bool open{};
+  Vec2<T> start;
+  auto point = path.points().data();
+  auto weight = path.weights().data();
+  for (const auto& type : path.verbs()) {
+    // A command following a close continues from the last point, as it does
+    // in the path.
+    if (type != CommandType::MOVE && type != CommandType::CLOSE && !open) {
+      start = point[-1];
+      open = true;
+    }
+    switch (type) {
+      case CommandType::MOVE:
+        start = point[0];
+        open = true;
+        break;
+      case CommandType::LINE:
+      case CommandType::QUADRATIC:
+      case CommandType::CUBIC:
+        addSegment(type, point - 1);
+        break;
+      case CommandType::CONIC:
+        addSegment(type, point - 1, *weight++);
+        break;
+      case CommandType::CLOSE:
+        if (open) {
+          if (point[-1] != start) {
+            const std::array<Vec2<T>, 2> line{{point[-1], start}};
+            addSegment(CommandType::LINE, line.data());
+          }
+          open = false;
+        }
+        break;
+      default:
+        assert(false);
+        break;
+    }
+    point += pointCount(type);
+  }
+}
+
+// Appends the chords of the segment whose points, including its start, are
+// given.
+template <class T>
+inline void PathMeasure<T, 2>::addSegment(CommandType type,
+                                          const Vec2<T> *points,
+                                          Scalar weight) {
+  switch (type) {
+    case CommandType::LINE:
+      measure_.setLine(points[0], points[1]);
+      break;
+    case CommandType::QUADRATIC:
+      measure_.setQuadratic(points[0], points[1], points[2]);
+      break;
+    case CommandType::CONIC:
+      measure_.setConic(Conic2<T>(points[0], points[1], points[2], weight));
+      break;
+    case CommandType::CUBIC:
+      measure_.setCubic(points[0], points[1], points[2], points[3]);
+      break;
+    default:
+      assert(false);
+      break;
+  }
+  const auto& lengths = measure_.lengths();
+  const auto count = static_cast<unsigned int>(lengths.size() - 1);
+  const Segment segment{type, points_.size(), weight, chords_.size(), count};
+  for (std::size_t i = 0; i <= pointCount(type); ++i) {
+    points_.emplace_back(promote(points[i]));
+  }
+  const auto base = distances_.back();
+  for (unsigned int i = 1; i <= count; ++i) {
+    distances_.emplace_back(base + lengths[i]);
+    chords_.emplace_back(static_cast<std::uint32_t>(segments_.size()));
+  }
+  segments_.emplace_back(segment);
+}
+
+#pragma mark Measuring
+
+template <class T>
+inline Vec2<math::Promote<T>> PathMeasure<T, 2>::position(
+    Scalar distance) const {
+  return sample(distance).first;
+}
+
+template <class T>
+inline Vec2<math::Promote<T>> PathMeasure<T, 2>::tangent(
+    Scalar distance) const {
+  return sample(distance).second;
+}
+
+// Returns the position and the unit tangent at the distance, which is clamped
+// to the length. The tangent is zero on a path without length.
+template <class T>
+inline typename PathMeasure<T, 2>::Sample PathMeasure<T, 2>::sample(
+    Scalar distance) const {
+  if (chords_.empty()) {
+    return Sample();
+  }
+  return evaluate(find(distance), distance);
+}
+
+// Answers the distances, which must be in ascending order, by walking the
+// chords forward from the previous one. Each sample is written to the result
+// in the order of the distances.
+template <class T>
+template <class InputIterator, class OutputIterator>
+inline OutputIterator PathMeasure<T, 2>::sample(InputIterator first,
+                                                InputIterator last,
+                                                OutputIterator result) const {
+  if (chords_.empty()) {
+    for (; first != last; ++first) {
+      *result++ = Sample();
+    }
+    return result;
+  }
+  std::size_t chord{};
+  for (; first != last; ++first) {
+    const Scalar distance = *first;
+    while (chord + 1 < chords_.size() && !(distance < distances_[chord + 1])) {
+      ++chord;
+    }
+    *result++ = evaluate(chord, distance);
+  }
+  return result;
+}
+
+// Returns the index of the chord that covers the distance, or the first or
+// last one when the distance lies outside of the path.
+template <class T>
+inline std::size_t PathMeasure<T, 2>::find(Scalar distance) const {
+  assert(!chords_.empty());
+  const auto upper = std::upper_bound(
+      std::begin(distances_), std::end(distances_), distance);
+  const auto index = std::distance(std::begin(distances_), upper);
+  if (!index) {
+    return 0;
+  }
+  return std::min(static_cast<std::size_t>(index - 1), chords_.size() - 1);
+}
+
+// Interpolates the parameter along the chord, and evaluates its segment
+// there. Where the derivative vanishes, the direction of the chord stands in
+// for the tangent.
+template <class T>
+inline typename PathMeasure<T, 2>::Sample PathMeasure<T, 2>::evaluate(
+    std::size_t chord,
+    Scalar distance) const {
+  const auto& segment = segments_[chords_[chord]];
+  const auto points = points_.data() + segment.point;
+  const auto lower = distances_[chord];
+  const auto span = distances_[chord + 1] - lower;
+  auto fraction = span > 0 ? (distance - lower) / span : 0;
+  fraction = std::min(std::max(fraction, Scalar(0)), Scalar(1));
+  const auto index = chord - segment.chord;
+  const auto t = (index + fraction) / segment.count;
+  Sample result;
+  result.first = CurveMeasure2<T>::point(
+      segment.type, points, segment.weight, t);
+  auto tangent = CurveMeasure2<T>::derivative(
+      segment.type, points, segment.weight, t);
+  auto length = std::sqrt(tangent.x * tangent.x + tangent.y * tangent.y);
+  if (!(length > 0)) {
+    tangent = CurveMeasure2<T>::point(
+        segment.type, points, segment.weight,
+        Scalar(index + 1) / segment.count) -
+        CurveMeasure2<T>::point(
+            segment.type, points, segment.weight,
+            Scalar(index) / segment.count);
+    length = std::sqrt(tangent.x * tangent.x + tangent.y * tangent.y);
+  }
+  if (length > 0) {
+    result.second = tangent / length;
+  }
+  return result;
+}
+
+#pragma mark Conversion
+
+template <class T>
+inline Vec2<math::Promote<T>> PathMeasure<T, 2>::promote(
+    const Vec2<T>& point) {
+  return Vec2<Scalar>(point.x, point.y);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::PathMeasure;
+using graphics::PathMeasure2;
+using graphics::PathMeasure2i;
+using graphics::PathMeasure2f;
+using graphics::PathMeasure2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_PATH_MEASURE_H_
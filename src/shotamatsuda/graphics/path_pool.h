@@ -0,0 +1,134 @@
+//
+//  shotamatsuda/graphics/path_pool.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_PATH_POOL_H_
+#define SHOTA_GRAPHICS_PATH_POOL_H_
+
+#include <cstddef>
+#include <functional>
+#include <unordered_set>
+#include <utility>
+
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/shape.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class PathPool;
+
+template <class T>
+using PathPool2 = PathPool<T, 2>;
+
+// Interns paths by content. Every path with equal content resolves to the same
+// pooled path, and the copies handed out share its storage, so an outline that
+// appears many times in a scene is stored once and can be processed once by
+// iterating over the pool. Pooled paths use the default memory resource.
+template <class T>
+class PathPool<T, 2> final {
+ public:
+  using Type = T;
+  using Paths = std::unordered_set<Path2<T>>;
+  using Iterator = typename Paths::const_iterator;
+  using ConstIterator = typename Paths::const_iterator;
+  static constexpr const int dimensions = 2;
+
+ public:
+  PathPool() = default;
+
+  // Copy semantics
+  PathPool(const PathPool&) = default;
+  PathPool& operator=(const PathPool&) = default;
+
+  // Move semantics
+  PathPool(PathPool&&) = default;
+  PathPool& operator=(PathPool&&) = default;
+
+  // Interning
+  const Path2<T>& intern(const Path2<T>& path);
+  const Path2<T>& intern(Path2<T>&& path);
+  void intern(Shape2<T>& shape);
+  bool contains(const Path2<T>& path) const;
+
+  // Attributes
+  bool empty() const { return paths_.empty(); }
+  std::size_t size() const { return paths_.size(); }
+  void reserve(std::size_t count) { paths_.reserve(count); }
+  void clear() { paths_.clear(); }
+
+  // Iterator
+  ConstIterator begin() const { return std::begin(paths_); }
+  ConstIterator end() const { return std::end(paths_); }
+
+ private:
+  Paths paths_;
+};
+
+using PathPool2i = PathPool2<int>;
+using PathPool2f = PathPool2<float>;
+using PathPool2d = PathPool2<double>;
+
+#pragma mark -
+
+template <class T>
+inline const Path2<T>& PathPool<T, 2>::intern(const Path2<T>& path) {
+  return *paths_.insert(path).first;
+}
+
+template <class T>
+inline const Path2<T>& PathPool<T, 2>::intern(Path2<T>&& path) {
+  return *paths_.insert(std::move(path)).first;
+}
+
+template <class T>
+inline void PathPool<T, 2>::intern(Shape2<T>& shape) {
+  // Assignment shares the pooled storage unless the shape allocates its paths
+  // from another memory resource, in which case they keep a private copy.
+  for (auto& path : shape.paths()) {
+    path = intern(path);
+  }
+}
+
+template <class T>
+inline bool PathPool<T, 2>::contains(const Path2<T>& path) const {
+  return paths_.find(path) != std::end(paths_);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::PathPool;
+using graphics::PathPool2;
+using graphics::PathPool2i;
+using graphics::PathPool2f;
+using graphics::PathPool2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_PATH_POOL_H_
@@ -0,0 +1,353 @@
+//
+//  shotamatsuda/graphics/point_bounds.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_POINT_BOUNDS_H_
+#define SHOTA_GRAPHICS_POINT_BOUNDS_H_
+
+#include <cassert>
+#include <cstddef>
+
+#include "shotamatsuda/graphics/simd.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+// Finds the component-wise minimum and maximum of a non-empty, contiguous
+// array of points. The float, double and int overloads load the coordinates
+// as interleaved lanes, so that every vector holds whole points, and reduce
+// the lanes once at the end. Other types use the scalar loop.
+template <class T>
+void findBounds(const Vec2<T> *points,
+                std::size_t size,
+                Vec2<T> *min,
+                Vec2<T> *max);
+void findBounds(const Vec2<float> *points,
+                std::size_t size,
+                Vec2<float> *min,
+                Vec2<float> *max);
+void findBounds(const Vec2<double> *points,
+                std::size_t size,
+                Vec2<double> *min,
+                Vec2<double> *max);
+void findBounds(const Vec2<int> *points,
+                std::size_t size,
+                Vec2<int> *min,
+                Vec2<int> *max);
+
+#pragma mark -
+
+template <class T>
+inline void includeBounds(const Vec2<T> *first,
+                          const Vec2<T> *last,
+                          Vec2<T> *min,
+                          Vec2<T> *max) {
+  for (; first != last; ++first) {
+    if (first->x < min->x) min->x = first->x;
+    if (first->y < min->y) min->y = first->y;
+    if (first->x > max->x) max->x = first->x;
+    if (first->y > max->y) max->y = first->y;
+  }
+}
+
+template <class T>
+inline void findBounds(const Vec2<T> *points,
+                       std::size_t size,
+                       Vec2<T> *min,
+                       Vec2<T> *max) {
+  assert(points && size && min && max);
+  *min = *max = points[0];
+  includeBounds(points + 1, points + size, min, max);
+}
+
+inline void findBounds(const Vec2<float> *points,
+                       std::size_t size,
+                       Vec2<float> *min,
+                       Vec2<float> *max) {
+  static_assert(sizeof(Vec2<float>) == 2 * sizeof(float),
+                "Points must be tightly packed");
+  assert(points && size && min && max);
+  *min = *max = points[0];
+  std::size_t i{};
+#if SHOTA_HAS_AVX
+  if (size >= 8) {
+    const auto data = reinterpret_cast<const float *>(points);
+    auto lo0 = _mm256_loadu_ps(data);
+    auto lo1 = _mm256_loadu_ps(data + 8);
+    auto hi0 = lo0;
+    auto hi1 = lo1;
+    for (i = 8; i + 8 <= size; i += 8) {
+      const auto a = _mm256_loadu_ps(data + i * 2);
+      const auto b = _mm256_loadu_ps(data + i * 2 + 8);
+      lo0 = _mm256_min_ps(lo0, a);
+      hi0 = _mm256_max_ps(hi0, a);
+      lo1 = _mm256_min_ps(lo1, b);
+      hi1 = _mm256_max_ps(hi1, b);
+    }
+    lo0 = _mm256_min_ps(lo0, lo1);
+    hi0 = _mm256_max_ps(hi0, hi1);
+    auto lo = _mm_min_ps(_mm256_castps256_ps128(lo0),
+                         _mm256_extractf128_ps(lo0, 1));
+    auto hi = _mm_max_ps(_mm256_castps256_ps128(hi0),
+                         _mm256_extractf128_ps(hi0, 1));
+    lo = _mm_min_ps(lo, _mm_movehl_ps(lo, lo));
+    hi = _mm_max_ps(hi, _mm_movehl_ps(hi, hi));
+    _mm_storel_pi(reinterpret_cast<__m64 *>(min), lo);
+    _mm_storel_pi(reinterpret_cast<__m64 *>(max), hi);
+  }
+#elif SHOTA_HAS_SSE2
+  if (size >= 4) {
+    const auto data = reinterpret_cast<const float *>(points);
+    auto lo0 = _mm_loadu_ps(data);
+    auto lo1 = _mm_loadu_ps(data + 4);
+    auto hi0 = lo0;
+    auto hi1 = lo1;
+    for (i = 4; i + 4 <= size; i += 4) {
+      const auto a = _mm_loadu_ps(data + i * 2);
+      const auto b = _mm_loadu_ps(data + i * 2 + 4);
+      lo0 = _mm_min_ps(lo0, a);
+      hi0 = _mm_max_ps(hi0, a);
+      lo1 = _mm_min_ps(lo1, b);
+      hi1 = _mm_max_ps(hi1, b);
+    }
+    auto lo = _mm_min_ps(lo0, lo1);
+    auto hi = _mm_max_ps(hi0, hi1);
+    lo = _mm_min_ps(lo, _mm_movehl_ps(lo, lo));
+    hi = _mm_max_ps(hi, _mm_movehl_ps(hi, hi));
+    _mm_storel_pi(reinterpret_cast<__m64 *>(min), lo);
+    _mm_storel_pi(reinterpret_cast<__m64 *>(max), hi);
+  }
+#elif SHOTA_HAS_NEON
+  if (size >= 4) {
+    const auto data = reinterpret_cast<const float *>(points);
+    auto lo0 = vld1q_f32(data);
+    auto lo1 = vld1q_f32(data + 4);
+    auto hi0 = lo0;
+    auto hi1 = lo1;
+    for (i = 4; i + 4 <= size; i += 4) {
+      const auto a = vld1q_f32(data + i * 2);
+      const auto b = vld1q_f32(data + i * 2 + 4);
+      lo0 = vminq_f32(lo0, a);
+      hi0 = vmaxq_f32(hi0, a);
+      lo1 = vminq_f32(lo1, b);
+      hi1 = vmaxq_f32(hi1, b);
+    }
+    lo0 = vminq_f32(lo0, lo1);
+    hi0 = vmaxq_f32(hi0, hi1);
+    vst1_f32(reinterpret_cast<float *>(min),
+             vmin_f32(vget_low_f32(lo0), vget_high_f32(lo0)));
+    vst1_f32(reinterpret_cast<float *>(max),
+             vmax_f32(vget_low_f32(hi0), vget_high_f32(hi0)));
+  }
+#endif
+  includeBounds(points + i, points + size, min, max);
+}
+
+inline void findBounds(const Vec2<double> *points,
+                       std::size_t size,
+                       Vec2<double> *min,
+                       Vec2<double> *max) {
+  static_assert(sizeof(Vec2<double>) == 2 * sizeof(double),
+                "Points must be tightly packed");
+  assert(points && size && min && max);
+  *min = *max = points[0];
+  std::size_t i{};
+#if SHOTA_HAS_AVX
+  if (size >= 4) {
+    const auto data = reinterpret_cast<const double *>(points);
+    auto lo0 = _mm256_loadu_pd(data);
+    auto lo1 = _mm256_loadu_pd(data + 4);
+    auto hi0 = lo0;
+    auto hi1 = lo1;
+    for (i = 4; i + 4 <= size; i += 4) {
+      const auto a = _mm256_loadu_pd(data + i * 2);
+      const auto b = _mm256_loadu_pd(data + i * 2 + 4);
+      lo0 = _mm256_min_pd(lo0, a);
+      hi0 = _mm256_max_pd(hi0, a);
+      lo1 = _mm256_min_pd(lo1, b);
+      hi1 = _mm256_max_pd(hi1, b);
+    }
+    lo0 = _mm256_min_pd(lo0, lo1);
+    hi0 = _mm256_max_pd(hi0, hi1);
+    _mm_storeu_pd(reinterpret_cast<double *>(min),
+                  _mm_min_pd(_mm256_castpd256_pd128(lo0),
+                             _mm256_extractf128_pd(lo0, 1)));
+    _mm_storeu_pd(reinterpret_cast<double *>(max),
+                  _mm_max_pd(_mm256_castpd256_pd128(hi0),
+                             _mm256_extractf128_pd(hi0, 1)));
+  }
+#elif SHOTA_HAS_SSE2
+  if (size >= 2) {
+    const auto data = reinterpret_cast<const double *>(points);
+    auto lo0 = _mm_loadu_pd(data);
+    auto lo1 = _mm_loadu_pd(data + 2);
+    auto hi0 = lo0;
+    auto hi1 = lo1;
+    for (i = 2; i + 2 <= size; i += 2) {
+      const auto a = _mm_loadu_pd(data + i * 2);
+      const auto b = _mm_loadu_pd(data + i * 2 + 2);
+      lo0 = _mm_min_pd(lo0, a);
+      hi0 = _mm_max_pd(hi0, a);
+      lo1 = _mm_min_pd(lo1, b);
+      hi1 = _mm_max_pd(hi1, b);
+    }
+    _mm_storeu_pd(reinterpret_cast<double *>(min), _mm_min_pd(lo0, lo1));
+    _mm_storeu_pd(reinterpret_cast<double *>(max), _mm_max_pd(hi0, hi1));
+  }
+#elif SHOTA_HAS_NEON_FP64
+  if (size >= 2) {
+    const auto data = reinterpret_cast<const double *>(points);
+    auto lo0 = vld1q_f64(data);
+    auto lo1 = vld1q_f64(data + 2);
+    auto hi0 = lo0;
+    auto hi1 = lo1;
+    for (i = 2; i + 2 <= size; i += 2) {
+      const auto a = vld1q_f64(data + i * 2);
+      const auto b = vld1q_f64(data + i * 2 + 2);
+      lo0 = vminq_f64(lo0, a);
+      hi0 = vmaxq_f64(hi0, a);
+      lo1 = vminq_f64(lo1, b);
+      hi1 = vmaxq_f64(hi1, b);
+    }
+    vst1q_f64(reinterpret_cast<double *>(min), vminq_f64(lo0, lo1));
+    vst1q_f64(reinterpret_cast<double *>(max), vmaxq_f64(hi0, hi1));
+  }
+#endif
+  includeBounds(points + i, points + size, min, max);
+}
+
+#if SHOTA_HAS_SSE2 && !SHOTA_HAS_SSE4_1
+
+// SSE2 has no 32-bit integer minimum and maximum, so they are blended from
+// a comparison.
+inline __m128i minEpi32(__m128i a, __m128i b) {
+  const auto mask = _mm_cmplt_epi32(a, b);
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+inline __m128i maxEpi32(__m128i a, __m128i b) {
+  const auto mask = _mm_cmpgt_epi32(a, b);
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+#elif SHOTA_HAS_SSE4_1
+
+inline __m128i minEpi32(__m128i a, __m128i b) { return _mm_min_epi32(a, b); }
+inline __m128i maxEpi32(__m128i a, __m128i b) { return _mm_max_epi32(a, b); }
+
+#endif  // SHOTA_HAS_SSE2 && !SHOTA_HAS_SSE4_1
+
+inline void findBounds(const Vec2<int> *points,
+                       std::size_t size,
+                       Vec2<int> *min,
+                       Vec2<int> *max) {
+  static_assert(sizeof(Vec2<int>) == 2 * sizeof(int),
+                "Points must be tightly packed");
+  assert(points && size && min && max);
+  *min = *max = points[0];
+  std::size_t i{};
+#if SHOTA_HAS_AVX2
+  if (size >= 8) {
+    const auto data = reinterpret_cast<const __m256i *>(points);
+    auto lo0 = _mm256_loadu_si256(data);
+    auto lo1 = _mm256_loadu_si256(data + 1);
+    auto hi0 = lo0;
+    auto hi1 = lo1;
+    for (i = 8; i + 8 <= size; i += 8) {
+      const auto a = _mm256_loadu_si256(data + i / 4);
+      const auto b = _mm256_loadu_si256(data + i / 4 + 1);
+      lo0 = _mm256_min_epi32(lo0, a);
+      hi0 = _mm256_max_epi32(hi0, a);
+      lo1 = _mm256_min_epi32(lo1, b);
+      hi1 = _mm256_max_epi32(hi1, b);
+    }
+    lo0 = _mm256_min_epi32(lo0, lo1);
+    hi0 = _mm256_max_epi32(hi0, hi1);
+    auto lo = _mm_min_epi32(_mm256_castsi256_si128(lo0),
+                            _mm256_extracti128_si256(lo0, 1));
+    auto hi = _mm_max_epi32(_mm256_castsi256_si128(hi0),
+                            _mm256_extracti128_si256(hi0, 1));
+    lo = _mm_min_epi32(lo, _mm_unpackhi_epi64(lo, lo));
+    hi = _mm_max_epi32(hi, _mm_unpackhi_epi64(hi, hi));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(min), lo);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(max), hi);
+  }
+#elif SHOTA_HAS_SSE2
+  if (size >= 4) {
+    const auto data = reinterpret_cast<const __m128i *>(points);
+    auto lo0 = _mm_loadu_si128(data);
+    auto lo1 = _mm_loadu_si128(data + 1);
+    auto hi0 = lo0;
+    auto hi1 = lo1;
+    for (i = 4; i + 4 <= size; i += 4) {
+      const auto a = _mm_loadu_si128(data + i / 2);
+      const auto b = _mm_loadu_si128(data + i / 2 + 1);
+      lo0 = minEpi32(lo0, a);
+      hi0 = maxEpi32(hi0, a);
+      lo1 = minEpi32(lo1, b);
+      hi1 = maxEpi32(hi1, b);
+    }
+    auto lo = minEpi32(lo0, lo1);
+    auto hi = maxEpi32(hi0, hi1);
+    lo = minEpi32(lo, _mm_unpackhi_epi64(lo, lo));
+    hi = maxEpi32(hi, _mm_unpackhi_epi64(hi, hi));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(min), lo);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(max), hi);
+  }
+#elif SHOTA_HAS_NEON
+  if (size >= 4) {
+    const auto data = reinterpret_cast<const int *>(points);
+    auto lo0 = vld1q_s32(data);
+    auto lo1 = vld1q_s32(data + 4);
+    auto hi0 = lo0;
+    auto hi1 = lo1;
+    for (i = 4; i + 4 <= size; i += 4) {
+      const auto a = vld1q_s32(data + i * 2);
+      const auto b = vld1q_s32(data + i * 2 + 4);
+      lo0 = vminq_s32(lo0, a);
+      hi0 = vmaxq_s32(hi0, a);
+      lo1 = vminq_s32(lo1, b);
+      hi1 = vmaxq_s32(hi1, b);
+    }
+    lo0 = vminq_s32(lo0, lo1);
+    hi0 = vmaxq_s32(hi0, hi1);
+    vst1_s32(reinterpret_cast<int *>(min),
+             vmin_s32(vget_low_s32(lo0), vget_high_s32(lo0)));
+    vst1_s32(reinterpret_cast<int *>(max),
+             vmax_s32(vget_low_s32(hi0), vget_high_s32(hi0)));
+  }
+#endif
+  includeBounds(points + i, points + size, min, max);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_POINT_BOUNDS_H_
@@ -0,0 +1,170 @@
+//
+//  shotamatsuda/graphics/polylines.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_POLYLINES_H_
+#define SHOTA_GRAPHICS_POLYLINES_H_
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class Polylines;
+
+template <class T>
+using Polylines2 = Polylines<T, 2>;
+
+// A set of polylines stored in a single point array, with the offset of the
+// first point of each contour and whether it is closed. Clearing keeps the
+// capacity, so a buffer owned by the caller can be reused across frames
+// without allocating once it has grown to fit.
+template <class T>
+class Polylines<T, 2> final {
+ public:
+  using Type = T;
+  using Points = std::vector<Vec2<T>>;
+  using Offsets = std::vector<std::size_t>;
+  static constexpr const int dimensions = 2;
+
+ public:
+  Polylines() = default;
+
+  // Copy semantics
+  Polylines(const Polylines&) = default;
+  Polylines& operator=(const Polylines&) = default;
+
+  // Move semantics
+  Polylines(Polylines&&) = default;
+  Polylines& operator=(Polylines&&) = default;
+
+  // Mutators
+  void reserve(std::size_t points, std::size_t contours);
+  void clear();
+
+  // Attributes
+  bool empty() const { return offsets_.empty(); }
+  std::size_t size() const { return offsets_.size(); }
+
+  // Adding points
+  void moveTo(const Vec2<T>& point);
+  void lineTo(const Vec2<T>& point);
+  void close();
+
+  // Contours
+  const Points& points() const { return points_; }
+  const Offsets& offsets() const { return offsets_; }
+  const Vec2<T> * contour(std::size_t index) const;
+  std::size_t contourSize(std::size_t index) const;
+  bool closed(std::size_t index) const;
+
+ private:
+  Points points_;
+  Offsets offsets_;
+  std::vector<bool> closed_;
+};
+
+using Polylines2i = Polylines2<int>;
+using Polylines2f = Polylines2<float>;
+using Polylines2d = Polylines2<double>;
+
+#pragma mark -
+
+template <class T>
+inline void Polylines<T, 2>::reserve(std::size_t points,
+                                     std::size_t contours) {
+  points_.reserve(points);
+  offsets_.reserve(contours);
+  closed_.reserve(contours);
+}
+
+template <class T>
+inline void Polylines<T, 2>::clear() {
+  points_.clear();
+  offsets_.clear();
+  closed_.clear();
+}
+
+#pragma mark Adding points
+
+template <class T>
+inline void Polylines<T, 2>::moveTo(const Vec2<T>& point) {
+  offsets_.emplace_back(points_.size());
+  closed_.push_back(false);
+  points_.emplace_back(point);
+}
+
+template <class T>
+inline void Polylines<T, 2>::lineTo(const Vec2<T>& point) {
+  assert(!empty());
+  points_.emplace_back(point);
+}
+
+template <class T>
+inline void Polylines<T, 2>::close() {
+  assert(!empty());
+  closed_.back() = true;
+}
+
+#pragma mark Contours
+
+template <class T>
+inline const Vec2<T> * Polylines<T, 2>::contour(std::size_t index) const {
+  assert(index < size());
+  return points_.data() + offsets_[index];
+}
+
+template <class T>
+inline std::size_t Polylines<T, 2>::contourSize(std::size_t index) const {
+  assert(index < size());
+  const auto end = index + 1 < size() ? offsets_[index + 1] : points_.size();
+  return end - offsets_[index];
+}
+
+template <class T>
+inline bool Polylines<T, 2>::closed(std::size_t index) const {
+  assert(index < size());
+  return closed_[index];
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::Polylines;
+using graphics::Polylines2;
+using graphics::Polylines2i;
+using graphics::Polylines2f;
+using graphics::Polylines2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_POLYLINES_H_
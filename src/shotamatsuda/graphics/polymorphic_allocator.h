@@ -0,0 +1,189 @@
+//
+//  shotamatsuda/graphics/polymorphic_allocator.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_POLYMORPHIC_ALLOCATOR_H_
+#define SHOTA_GRAPHICS_POLYMORPHIC_ALLOCATOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "shotamatsuda/graphics/memory_resource.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+// Mirrors std::pmr::polymorphic_allocator. Containers copied from one that
+// uses this allocator fall back to the default resource, and elements that
+// are themselves allocator-aware are constructed with the same resource.
+template <class T>
+class PolymorphicAllocator {
+ public:
+  using value_type = T;
+
+ public:
+  PolymorphicAllocator();
+  PolymorphicAllocator(MemoryResource *resource);
+  template <class U>
+  PolymorphicAllocator(const PolymorphicAllocator<U>& other);
+
+  // Copy semantics
+  PolymorphicAllocator(const PolymorphicAllocator&) = default;
+  PolymorphicAllocator& operator=(const PolymorphicAllocator&) = default;
+
+  // Allocation
+  T * allocate(std::size_t size);
+  void deallocate(T *pointer, std::size_t size);
+
+  // Construction
+  template <class U, class... Args>
+  void construct(U *pointer, Args&&... args);
+  template <class U>
+  void destroy(U *pointer);
+
+  // Container support
+  PolymorphicAllocator select_on_container_copy_construction() const;
+
+  // Attributes
+  MemoryResource * resource() const { return resource_; }
+
+ private:
+  template <class U, class... Args>
+  void construct(std::true_type, U *pointer, Args&&... args);
+  template <class U, class... Args>
+  void construct(std::false_type, U *pointer, Args&&... args);
+
+ private:
+  MemoryResource *resource_;
+};
+
+// Comparison
+template <class T, class U>
+bool operator==(const PolymorphicAllocator<T>& lhs,
+                const PolymorphicAllocator<U>& rhs);
+template <class T, class U>
+bool operator!=(const PolymorphicAllocator<T>& lhs,
+                const PolymorphicAllocator<U>& rhs);
+
+#pragma mark -
+
+template <class T>
+inline PolymorphicAllocator<T>::PolymorphicAllocator()
+    : resource_(defaultResource()) {}
+
+template <class T>
+inline PolymorphicAllocator<T>::PolymorphicAllocator(MemoryResource *resource)
+    : resource_(resource) {
+  assert(resource_);
+}
+
+template <class T>
+template <class U>
+inline PolymorphicAllocator<T>::PolymorphicAllocator(
+    const PolymorphicAllocator<U>& other)
+    : resource_(other.resource()) {}
+
+#pragma mark Allocation
+
+template <class T>
+inline T * PolymorphicAllocator<T>::allocate(std::size_t size) {
+  return static_cast<T *>(resource_->allocate(size * sizeof(T), alignof(T)));
+}
+
+template <class T>
+inline void PolymorphicAllocator<T>::deallocate(T *pointer,
+                                                std::size_t size) {
+  resource_->deallocate(pointer, size * sizeof(T), alignof(T));
+}
+
+#pragma mark Construction
+
+template <class T>
+template <class U, class... Args>
+inline void PolymorphicAllocator<T>::construct(U *pointer, Args&&... args) {
+  using UsesAllocator = std::integral_constant<bool,
+      std::uses_allocator<U, PolymorphicAllocator>::value &&
+      std::is_constructible<U, Args..., const PolymorphicAllocator&>::value>;
+  construct(UsesAllocator(), pointer, std::forward<Args>(args)...);
+}
+
+template <class T>
+template <class U, class... Args>
+inline void PolymorphicAllocator<T>::construct(std::true_type,
+                                               U *pointer,
+                                               Args&&... args) {
+  ::new (static_cast<void *>(pointer)) U(std::forward<Args>(args)..., *this);
+}
+
+template <class T>
+template <class U, class... Args>
+inline void PolymorphicAllocator<T>::construct(std::false_type,
+                                               U *pointer,
+                                               Args&&... args) {
+  ::new (static_cast<void *>(pointer)) U(std::forward<Args>(args)...);
+}
+
+template <class T>
+template <class U>
+inline void PolymorphicAllocator<T>::destroy(U *pointer) {
+  pointer->~U();
+}
+
+#pragma mark Container support
+
+template <class T>
+inline PolymorphicAllocator<T>
+PolymorphicAllocator<T>::select_on_container_copy_construction() const {
+  return PolymorphicAllocator();
+}
+
+#pragma mark Comparison
+
+template <class T, class U>
+inline bool operator==(const PolymorphicAllocator<T>& lhs,
+                       const PolymorphicAllocator<U>& rhs) {
+  return *lhs.resource() == *rhs.resource();
+}
+
+template <class T, class U>
+inline bool operator!=(const PolymorphicAllocator<T>& lhs,
+                       const PolymorphicAllocator<U>& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::PolymorphicAllocator;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_POLYMORPHIC_ALLOCATOR_H_
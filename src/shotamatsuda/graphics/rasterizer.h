@@ -0,0 +1,385 @@
+//
+//  shotamatsuda/graphics/rasterizer.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_RASTERIZER_H_
+#define SHOTA_GRAPHICS_RASTERIZER_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/coverage.h"
+#include "shotamatsuda/graphics/fill_rule.h"
+#include "shotamatsuda/graphics/flattener.h"
+#include "shotamatsuda/graphics/flattening_iterator.h"
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class Rasterizer;
+
+template <class T>
+using Rasterizer2 = Rasterizer<T, 2>;
+
+// Renders shapes into 8-bit coverage masks by accumulating signed area. Each
+// line adds to the pixels it crosses the area between it and their right
+// edges, signed by its direction, and the remaining height to the pixel after
+// them, so that summing each row from the left yields the winding area of
+// every pixel. Contours are closed implicitly, and coordinates are in pixels,
+// with the top left of the mask at its origin, which defaults to zero, so that
+// a mask can cover just the bounds of a shape.
+//
+// Lines are clipped to the mask, and the parts to its left are moved onto its
+// left edge, where they still cover everything to their right. The buffer
+// keeps two extra columns per row so that lines touching the right edge need
+// no bounds checks.
+template <class T>
+class Rasterizer<T, 2> final {
+ public:
+  using Type = T;
+  static constexpr const int dimensions = 2;
+
+ public:
+  Rasterizer();
+  Rasterizer(int width, int height);
+
+  // Copy semantics
+  Rasterizer(const Rasterizer&) = default;
+  Rasterizer& operator=(const Rasterizer&) = default;
+
+  // Move semantics
+  Rasterizer(Rasterizer&&) = default;
+  Rasterizer& operator=(Rasterizer&&) = default;
+
+  // Mutators
+  void resize(int width, int height);
+  void reset();
+  void setOrigin(const Vec2<int>& origin) { origin_ = origin; }
+
+  // Attributes
+  int width() const { return width_; }
+  int height() const { return height_; }
+  const Vec2<int>& origin() const { return origin_; }
+
+  // Adding geometry
+  void addLine(const Vec2<T>& p0, const Vec2<T>& p1);
+  void addPath(const Path2<T>& path,
+               const Flattener2<T>& flattener = Flattener2<T>());
+  void addShape(const Shape2<T>& shape,
+                const Flattener2<T>& flattener = Flattener2<T>());
+  void addBackdrop(int y, float area);
+
+  // Rasterization
+  void rasterize(FillRule rule,
+                 std::uint8_t *mask,
+                 std::ptrdiff_t stride) const;
+  void rasterizeRow(FillRule rule, int y, std::uint8_t *row) const;
+  std::vector<std::uint8_t> rasterize(FillRule rule) const;
+  std::vector<std::uint8_t> rasterize(
+      const Shape2<T>& shape,
+      FillRule rule,
+      const Flattener2<T>& flattener = Flattener2<T>());
+
+ private:
+  template <class Range>
+  void addCommands(const Range& commands);
+  void clipLine(float x0, float y0, float x1, float y1);
+  void drawLine(float x0, float y0, float x1, float y1);
+  std::size_t stride() const { return width_ + 2; }
+
+ private:
+  int width_;
+  int height_;
+  Vec2<int> origin_;
+  std::vector<float> areas_;
+};
+
+using Rasterizer2i = Rasterizer2<int>;
+using Rasterizer2f = Rasterizer2<float>;
+using Rasterizer2d = Rasterizer2<double>;
+
+#pragma mark -
+
+template <class T>
+inline Rasterizer<T, 2>::Rasterizer() : width_(), height_(), origin_() {}
+
+template <class T>
+inline Rasterizer<T, 2>::Rasterizer(int width, int height)
+    : width_(),
+      height_(),
+      origin_() {
+  resize(width, height);
+}
+
+#pragma mark Mutators
+
+template <class T>
+inline void Rasterizer<T, 2>::resize(int width, int height) {
+  assert(width >= 0 && height >= 0);
+  width_ = width;
+  height_ = height;
+  areas_.assign(stride() * height_, 0);
+}
+
+template <class T>
+inline void Rasterizer<T, 2>::reset() {
+  std::fill(std::begin(areas_), std::end(areas_), 0);
+}
+
+#pragma mark Adding geometry
+
+template <class T>
+inline void Rasterizer<T, 2>::addLine(const Vec2<T>& p0, const Vec2<T>& p1) {
+  clipLine(static_cast<float>(p0.x - origin_.x),
+           static_cast<float>(p0.y - origin_.y),
+           static_cast<float>(p1.x - origin_.x),
+           static_cast<float>(p1.y - origin_.y));
+}
+
+template <class T>
+inline void Rasterizer<T, 2>::addPath(const Path2<T>& path,
+                                      const Flattener2<T>& flattener) {
+  addCommands(flattened(path, flattener));
+}
+
+template <class T>
+inline void Rasterizer<T, 2>::addShape(const Shape2<T>& shape,
+                                       const Flattener2<T>& flattener) {
+  addCommands(flattened(shape, flattener));
+}
+
+// Adds the area that lines to the left of the mask leave in the given row, as
+// a line lying on its left edge would.
+template <class T>
+inline void Rasterizer<T, 2>::addBackdrop(int y, float area) {
+  assert(0 <= y && y < height_);
+  areas_[y * stride()] += area;
+}
+
+template <class T>
+template <class Range>
+inline void Rasterizer<T, 2>::addCommands(const Range& commands) {
+  Vec2<T> start;
+  Vec2<T> previous;
+  for (const auto& command : commands) {
+    switch (command.type()) {
+      case CommandType::MOVE:
+        addLine(previous, start);
+        start = previous = command.point();
+        break;
+      case CommandType::LINE:
+        addLine(previous, command.point());
+        previous = command.point();
+        break;
+      case CommandType::CLOSE:
+        addLine(previous, start);
+        previous = start;
+        break;
+      default:
+        assert(false);
+        break;
+    }
+  }
+  addLine(previous, start);
+}
+
+// Clips the line to the rows of the mask, and splits it where it crosses the
+// left and right edges, clamping the parts outside onto the edges.
+template <class T>
+inline void Rasterizer<T, 2>::clipLine(float x0,
+                                       float y0,
+                                       float x1,
+                                       float y1) {
+  if (y0 == y1 || !(std::max(y0, y1) > 0 && std::min(y0, y1) < height_)) {
+    return;
+  }
+  const auto dxdy = (x1 - x0) / (y1 - y0);
+  const auto clip = [&](float& x, float& y) {
+    const auto clamped = std::min(std::max(y, 0.f), float(height_));
+    if (clamped != y) {
+      x += (clamped - y) * dxdy;
+      y = clamped;
+    }
+  };
+  clip(x0, y0);
+  clip(x1, y1);
+  // Split the line where it crosses the left and right edges. The pieces
+  // between take their x from the edges themselves rather than from their y,
+  // which loses too much precision on nearly horizontal lines that reach far
+  // outside the mask.
+  float xs[4] = {x0, x0, x0, x1};
+  float ys[4] = {y0, y0, y0, y1};
+  auto count = 1;
+  if (x0 != x1) {
+    const auto dydx = (y1 - y0) / (x1 - x0);
+    for (const auto edge : {0.f, float(width_)}) {
+      if ((x0 < edge) != (x1 < edge)) {
+        xs[count] = edge;
+        ys[count++] = y0 + (edge - x0) * dydx;
+      }
+    }
+  }
+  if (count == 3 && (xs[1] < xs[2]) != (x0 < x1)) {
+    std::swap(xs[1], xs[2]);
+    std::swap(ys[1], ys[2]);
+  }
+  xs[count] = x1;
+  ys[count] = y1;
+  const auto clamp = [this](float x) {
+    return std::min(std::max(x, 0.f), float(width_));
+  };
+  for (auto i = 0; i < count; ++i) {
+    drawLine(clamp(xs[i]), ys[i], clamp(xs[i + 1]), ys[i + 1]);
+  }
+}
+
+// Accumulates the signed area of a line that lies within the mask.
+template <class T>
+inline void Rasterizer<T, 2>::drawLine(float x0,
+                                       float y0,
+                                       float x1,
+                                       float y1) {
+  if (y0 == y1) {
+    return;
+  }
+  auto direction = 1.f;
+  if (y0 > y1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+    direction = -1;
+  }
+  const auto dxdy = (x1 - x0) / (y1 - y0);
+  const auto limit = float(width_);
+  const auto first = static_cast<int>(y0);
+  const auto last = std::min(height_, static_cast<int>(std::ceil(y1)));
+  auto x = x0;
+  for (auto y = first; y < last; ++y) {
+    const auto row = areas_.data() + y * stride();
+    const auto dy = std::min(float(y + 1), y1) - std::max(float(y), y0);
+    const auto next = std::min(std::max(x + dxdy * dy, 0.f), limit);
+    const auto d = dy * direction;
+    const auto left = std::min(x, next);
+    const auto right = std::max(x, next);
+    const auto left_floor = std::floor(left);
+    const auto left_index = static_cast<int>(left_floor);
+    const auto right_ceil = std::ceil(right);
+    const auto right_index = static_cast<int>(right_ceil);
+    if (right_index <= left_index + 1) {
+      // Within a single pixel, the area to the right of the line is the
+      // height times the distance from its midpoint to the right edge.
+      const auto middle = (x + next) / 2 - left_floor;
+      row[left_index] += d - d * middle;
+      row[left_index + 1] += d * middle;
+    } else {
+      // Across several pixels, the area is a triangle in the first pixel, a
+      // constant slope in the pixels between, and the rest in the last.
+      const auto s = 1 / (right - left);
+      const auto left_fraction = left - left_floor;
+      const auto a0 = s * (1 - left_fraction) * (1 - left_fraction) / 2;
+      const auto right_fraction = right - right_ceil + 1;
+      const auto am = s * right_fraction * right_fraction / 2;
+      row[left_index] += d * a0;
+      if (right_index == left_index + 2) {
+        row[left_index + 1] += d * (1 - a0 - am);
+      } else {
+        const auto a1 = s * (1.5f - left_fraction);
+        row[left_index + 1] += d * (a1 - a0);
+        for (auto i = left_index + 2; i < right_index - 1; ++i) {
+          row[i] += d * s;
+        }
+        const auto a2 = a1 + (right_index - left_index - 3) * s;
+        row[right_index - 1] += d * (1 - a2 - am);
+      }
+      row[right_index] += d * am;
+    }
+    x = next;
+  }
+}
+
+#pragma mark Rasterization
+
+template <class T>
+inline void Rasterizer<T, 2>::rasterize(FillRule rule,
+                                        std::uint8_t *mask,
+                                        std::ptrdiff_t stride) const {
+  assert(mask || !width_ || !height_);
+  for (auto y = 0; y < height_; ++y) {
+    rasterizeRow(rule, y, mask + y * stride);
+  }
+}
+
+// Writes the coverage of a single row, so that callers can consume the mask
+// row by row without storing all of it.
+template <class T>
+inline void Rasterizer<T, 2>::rasterizeRow(FillRule rule,
+                                           int y,
+                                           std::uint8_t *row) const {
+  assert(0 <= y && y < height_);
+  accumulateCoverage(areas_.data() + y * stride(), width_, rule, row);
+}
+
+template <class T>
+inline std::vector<std::uint8_t> Rasterizer<T, 2>::rasterize(
+    FillRule rule) const {
+  std::vector<std::uint8_t> result(std::size_t(width_) * height_);
+  rasterize(rule, result.data(), width_);
+  return result;
+}
+
+template <class T>
+inline std::vector<std::uint8_t> Rasterizer<T, 2>::rasterize(
+    const Shape2<T>& shape,
+    FillRule rule,
+    const Flattener2<T>& flattener) {
+  reset();
+  addShape(shape, flattener);
+  return rasterize(rule);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::Rasterizer;
+using graphics::Rasterizer2;
+using graphics::Rasterizer2i;
+using graphics::Rasterizer2f;
+using graphics::Rasterizer2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_RASTERIZER_H_
@@ -0,0 +1,277 @@
+//
+//  shotamatsuda/graphics/reversed_path_view.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_REVERSED_PATH_VIEW_H_
+#define SHOTA_GRAPHICS_REVERSED_PATH_VIEW_H_
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+
+#include "shotamatsuda/graphics/command.h"
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class ReversedPathIterator;
+template <class T, int D>
+class ReversedPathView;
+
+template <class T>
+using ReversedPathIterator2 = ReversedPathIterator<T, 2>;
+template <class T>
+using ReversedPathView2 = ReversedPathView<T, 2>;
+
+// Yields the commands of a reversed path by walking the arrays of the path
+// backwards. The move to its last point comes first and a trailing close
+// stays last; every other command refers to the points before it, in reverse
+// order. Commands are assembled on dereference since their points are not
+// stored in order.
+template <class T>
+class ReversedPathIterator<T, 2> final {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Command2<T>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = Command2<T>;
+
+ public:
+  ReversedPathIterator();
+  ReversedPathIterator(const CommandType *front,
+                       const CommandType *back,
+                       const CommandType *close,
+                       const CommandType *verb,
+                       const Vec2<T> *point,
+                       const math::Promote<T> *weight);
+
+  // Copy semantics
+  ReversedPathIterator(const ReversedPathIterator&) = default;
+  ReversedPathIterator& operator=(const ReversedPathIterator&) = default;
+
+  // Move semantics
+  ReversedPathIterator(ReversedPathIterator&&) = default;
+  ReversedPathIterator& operator=(ReversedPathIterator&&) = default;
+
+  // Comparison
+  bool operator==(const ReversedPathIterator& other) const;
+  bool operator!=(const ReversedPathIterator& other) const;
+
+  // Iterator
+  reference operator*() const;
+  ReversedPathIterator& operator++();
+  ReversedPathIterator operator++(int);
+
+ private:
+  const CommandType *front_;
+  const CommandType *back_;
+  const CommandType *close_;
+  const CommandType *verb_;
+  const Vec2<T> *point_;
+  const math::Promote<T> *weight_;
+};
+
+// A non-owning view of a path in reverse, which iterates the same commands
+// as the path that reversed() returns without copying it. Views are
+// invalidated by any mutation of the path.
+template <class T>
+class ReversedPathView<T, 2> final {
+ public:
+  using Type = T;
+  static constexpr const int dimensions = 2;
+  using Iterator = ReversedPathIterator2<T>;
+  using ConstIterator = ReversedPathIterator2<T>;
+
+ public:
+  ReversedPathView(const CommandType *verbs,
+                   std::size_t size,
+                   const Vec2<T> *points_end,
+                   const math::Promote<T> *weights_end);
+
+  // Copy semantics
+  ReversedPathView(const ReversedPathView&) = default;
+  ReversedPathView& operator=(const ReversedPathView&) = default;
+
+  // Move semantics
+  ReversedPathView(ReversedPathView&&) = default;
+  ReversedPathView& operator=(ReversedPathView&&) = default;
+
+  // Attributes
+  bool empty() const { return !size_; }
+  std::size_t size() const { return size_; }
+
+  // Iterator
+  ConstIterator begin() const;
+  ConstIterator end() const;
+
+ private:
+  const CommandType *verbs_;
+  std::size_t size_;
+  const Vec2<T> *points_end_;
+  const math::Promote<T> *weights_end_;
+};
+
+#pragma mark -
+
+template <class T>
+inline ReversedPathIterator<T, 2>::ReversedPathIterator()
+    : front_(),
+      back_(),
+      close_(),
+      verb_(),
+      point_(),
+      weight_() {}
+
+template <class T>
+inline ReversedPathIterator<T, 2>::ReversedPathIterator(
+    const CommandType *front,
+    const CommandType *back,
+    const CommandType *close,
+    const CommandType *verb,
+    const Vec2<T> *point,
+    const math::Promote<T> *weight)
+    : front_(front),
+      back_(back),
+      close_(close),
+      verb_(verb),
+      point_(point),
+      weight_(weight) {}
+
+#pragma mark Comparison
+
+template <class T>
+inline bool ReversedPathIterator<T, 2>::operator==(
+    const ReversedPathIterator& other) const {
+  return verb_ == other.verb_;
+}
+
+template <class T>
+inline bool ReversedPathIterator<T, 2>::operator!=(
+    const ReversedPathIterator& other) const {
+  return !(*this == other);
+}
+
+#pragma mark Iterator
+
+template <class T>
+inline Command2<T> ReversedPathIterator<T, 2>::operator*() const {
+  assert(verb_);
+  const auto type = *verb_;
+  switch (type) {
+    case CommandType::MOVE:
+    case CommandType::LINE:
+      return Command2<T>(type, point_[-1]);
+    case CommandType::QUADRATIC:
+      return Command2<T>(type, point_[-1], point_[-2]);
+    case CommandType::CONIC:
+      return Command2<T>(type, point_[-1], point_[-2], weight_[-1]);
+    case CommandType::CUBIC:
+      return Command2<T>(type, point_[-1], point_[-2], point_[-3]);
+    case CommandType::CLOSE:
+      break;
+    default:
+      assert(false);
+      break;
+  }
+  return Command2<T>(type);
+}
+
+template <class T>
+inline ReversedPathIterator2<T>& ReversedPathIterator<T, 2>::operator++() {
+  assert(verb_);
+  const auto type = *verb_;
+  point_ -= pointCount(type);
+  if (type == CommandType::CONIC) {
+    --weight_;
+  }
+  // The verbs are visited in the order of the first, the last to the second,
+  // and the trailing close if any.
+  if (verb_ == close_) {
+    verb_ = nullptr;
+  } else if (verb_ == front_) {
+    verb_ = back_ != front_ ? back_ : close_;
+  } else if (--verb_ == front_) {
+    verb_ = close_;
+  }
+  return *this;
+}
+
+template <class T>
+inline ReversedPathIterator2<T> ReversedPathIterator<T, 2>::operator++(int) {
+  ReversedPathIterator result(*this);
+  ++*this;
+  return result;
+}
+
+#pragma mark -
+
+template <class T>
+inline ReversedPathView<T, 2>::ReversedPathView(
+    const CommandType *verbs,
+    std::size_t size,
+    const Vec2<T> *points_end,
+    const math::Promote<T> *weights_end)
+    : verbs_(verbs),
+      size_(size),
+      points_end_(points_end),
+      weights_end_(weights_end) {}
+
+#pragma mark Iterator
+
+template <class T>
+inline ReversedPathIterator2<T> ReversedPathView<T, 2>::begin() const {
+  if (empty()) {
+    return end();
+  }
+  const auto last = verbs_ + size_ - 1;
+  const auto closed = size_ > 1 && *last == CommandType::CLOSE;
+  return ReversedPathIterator2<T>(verbs_, closed ? last - 1 : last,
+                                  closed ? last : nullptr, verbs_,
+                                  points_end_, weights_end_);
+}
+
+template <class T>
+inline ReversedPathIterator2<T> ReversedPathView<T, 2>::end() const {
+  return ReversedPathIterator2<T>();
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::ReversedPathIterator;
+using graphics::ReversedPathIterator2;
+using graphics::ReversedPathView;
+using graphics::ReversedPathView2;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_REVERSED_PATH_VIEW_H_
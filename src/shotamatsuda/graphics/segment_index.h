@@ -0,0 +1,510 @@
+//
+//  shotamatsuda/graphics/segment_index.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_SEGMENT_INDEX_H_
+#define SHOTA_GRAPHICS_SEGMENT_INDEX_H_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class SegmentIndex;
+
+template <class T>
+using SegmentIndex2 = SegmentIndex<T, 2>;
+
+// Indexes the segments of a path by the rows they span, to count the winding
+// of the path around a point. Segments are split at their extrema in y into
+// pieces that are monotonic in y, so that a horizontal line crosses each
+// piece at most once, and the pieces are listed in every band of rows they
+// overlap. Counting the winding at a point then solves for the crossings of
+// only the pieces in its band that span its row, and adds the direction of
+// each that lies to the right of the point.
+//
+// Contours are closed implicitly, as they are when filled. Each piece spans
+// the half-open range from its top to its bottom, so that a row through the
+// joint of two pieces crosses just one of them. The segments are stored as
+// polynomials in the power basis, with conics as the quotient of two, so that
+// every kind evaluates the same way.
+template <class T>
+class SegmentIndex<T, 2> final {
+ public:
+  using Type = T;
+  using Scalar = math::Promote<T>;
+  static constexpr const int dimensions = 2;
+  static constexpr const std::size_t max_bands = 1 << 16;
+
+ public:
+  SegmentIndex();
+  template <class Verbs, class Points, class Weights>
+  SegmentIndex(const Verbs& verbs,
+               const Points& points,
+               const Weights& weights);
+
+  // Copy semantics
+  SegmentIndex(const SegmentIndex&) = default;
+  SegmentIndex& operator=(const SegmentIndex&) = default;
+
+  // Move semantics
+  SegmentIndex(SegmentIndex&&) = default;
+  SegmentIndex& operator=(SegmentIndex&&) = default;
+
+  // Attributes
+  bool empty() const { return pieces_.empty(); }
+  std::size_t size() const { return pieces_.size(); }
+  std::size_t bands() const { return offsets_.size() - 1; }
+
+  // Hit testing
+  int winding(const Vec2<Scalar>& point) const;
+
+ private:
+  struct Segment {
+    std::array<Scalar, 4> x;
+    std::array<Scalar, 4> y;
+    std::array<Scalar, 3> w;
+  };
+
+  struct Piece {
+    std::uint32_t segment;
+    Scalar t0;
+    Scalar t1;
+    Scalar top;
+    Scalar bottom;
+    int direction;
+  };
+
+ private:
+  // Building
+  void addLine(const Vec2<Scalar>& p0, const Vec2<Scalar>& p1);
+  void addQuadratic(const Vec2<Scalar>& p0,
+                    const Vec2<Scalar>& p1,
+                    const Vec2<Scalar>& p2);
+  void addConic(const Vec2<Scalar>& p0,
+                const Vec2<Scalar>& p1,
+                const Vec2<Scalar>& p2,
+                Scalar weight);
+  void addCubic(const Vec2<Scalar>& p0,
+                const Vec2<Scalar>& p1,
+                const Vec2<Scalar>& p2,
+                const Vec2<Scalar>& p3);
+  void addSegment(const Segment& segment);
+  void build();
+  std::size_t countEntries(std::size_t bands) const;
+  std::pair<std::size_t, std::size_t> range(const Piece& piece,
+                                            std::size_t bands) const;
+
+  // Evaluation
+  Scalar crossing(const Piece& piece, Scalar y) const;
+  static Scalar evaluate(const std::array<Scalar, 4>& coefficients,
+                         const std::array<Scalar, 3>& w,
+                         Scalar t);
+  static int solveUnitQuadratic(Scalar a, Scalar b, Scalar c, Scalar *roots);
+  static Vec2<Scalar> promote(const Vec2<T>& point);
+
+ private:
+  std::vector<Segment> segments_;
+  std::vector<Piece> pieces_;
+  std::vector<std::uint32_t> offsets_;
+  std::vector<std::uint32_t> entries_;
+  Scalar top_;
+  Scalar band_height_;
+};
+
+template <class T>
+constexpr const std::size_t SegmentIndex<T, 2>::max_bands;
+
+using SegmentIndex2i = SegmentIndex2<int>;
+using SegmentIndex2f = SegmentIndex2<float>;
+using SegmentIndex2d = SegmentIndex2<double>;
+
+#pragma mark -
+
+template <class T>
+inline SegmentIndex<T, 2>::SegmentIndex()
+    : offsets_(2),
+      top_(),
+      band_height_(1) {}
+
+template <class T>
+template <class Verbs, class Points, class Weights>
+inline SegmentIndex<T, 2>::SegmentIndex(const Verbs& verbs,
+                                        const Points& points,
+                                        const Weights& weights)
+    : SegmentIndex() {
+  bool open{};
+  Vec2<Scalar> start;
+  auto point = points.data();
+  auto weight = weights.data();
+  for (const auto& type : verbs) {
+    // A command following a close continues from the last point, as it does
+    // in the path.
+    if (type != CommandType::MOVE && type != CommandType::CLOSE && !open) {
+      start = promote(point[-1]);
+      open = true;
+    }
+    switch (type) {
+      case CommandType::MOVE:
+        if (open) {
+          addLine(promote(point[-1]), start);
+        }
+        start = promote(point[0]);
+        open = true;
+        break;
+      case CommandType::LINE:
+        addLine(promote(point[-1]), promote(point[0]));
+        break;
+      case CommandType::QUADRATIC:
+        addQuadratic(promote(point[-1]), promote(point[0]),
+                     promote(point[1]));
+        break;
+      case CommandType::CONIC:
+        addConic(promote(point[-1]), promote(point[0]), promote(point[1]),
+                 *weight++);
+        break;
+      case CommandType::CUBIC:
+        addCubic(promote(point[-1]), promote(point[0]), promote(point[1]),
+                 promote(point[2]));
+        break;
+      case CommandType::CLOSE:
+        if (open) {
+          addLine(promote(point[-1]), start);
+          open = false;
+        }
+        break;
+      default:
+        assert(false);
+        break;
+    }
+    point += pointCount(type);
+  }
+  if (open) {
+    addLine(promote(point[-1]), start);
+  }
+  build();
+}
+
+#pragma mark Building
+
+template <class T>
+inline void SegmentIndex<T, 2>::addLine(const Vec2<Scalar>& p0,
+                                        const Vec2<Scalar>& p1) {
+  if (p0.y == p1.y) {
+    return;
+  }
+  addSegment(Segment{
+    {{0, 0, p1.x - p0.x, p0.x}},
+    {{0, 0, p1.y - p0.y, p0.y}},
+    {{0, 0, 1}}
+  });
+}
+
+template <class T>
+inline void SegmentIndex<T, 2>::addQuadratic(const Vec2<Scalar>& p0,
+                                             const Vec2<Scalar>& p1,
+                                             const Vec2<Scalar>& p2) {
+  const auto a = p0 - p1 * 2 + p2;
+  const auto b = (p1 - p0) * 2;
+  addSegment(Segment{
+    {{0, a.x, b.x, p0.x}},
+    {{0, a.y, b.y, p0.y}},
+    {{0, 0, 1}}
+  });
+}
+
+// The numerators are the quadratics of the homogeneous control points, in
+// which the middle one is scaled by the weight, and the denominator is that
+// of the weights.
+template <class T>
+inline void SegmentIndex<T, 2>::addConic(const Vec2<Scalar>& p0,
+                                         const Vec2<Scalar>& p1,
+                                         const Vec2<Scalar>& p2,
+                                         Scalar weight) {
+  const auto weighted = p1 * weight;
+  const auto a = p0 - weighted * 2 + p2;
+  const auto b = (weighted - p0) * 2;
+  addSegment(Segment{
+    {{0, a.x, b.x, p0.x}},
+    {{0, a.y, b.y, p0.y}},
+    {{2 - 2 * weight, 2 * (weight - 1), 1}}
+  });
+}
+
+template <class T>
+inline void SegmentIndex<T, 2>::addCubic(const Vec2<Scalar>& p0,
+                                         const Vec2<Scalar>& p1,
+                                         const Vec2<Scalar>& p2,
+                                         const Vec2<Scalar>& p3) {
+  const auto a = p3 - p2 * 3 + p1 * 3 - p0;
+  const auto b = (p2 - p1 * 2 + p0) * 3;
+  const auto c = (p1 - p0) * 3;
+  addSegment(Segment{
+    {{a.x, b.x, c.x, p0.x}},
+    {{a.y, b.y, c.y, p0.y}},
+    {{0, 0, 1}}
+  });
+}
+
+// Splits the segment where the derivative of y vanishes. For y = Y / W, the
+// numerator of the derivative is Y'W - YW', which is a quadratic for every
+// kind of segment, since its cubic terms cancel for conics.
+template <class T>
+inline void SegmentIndex<T, 2>::addSegment(const Segment& segment) {
+  const auto& y = segment.y;
+  const auto& w = segment.w;
+  const auto a = 3 * y[0] * w[2] + y[1] * w[1] - y[2] * w[0];
+  const auto b = 2 * (y[1] * w[2] - y[3] * w[0]);
+  const auto c = y[2] * w[2] - y[3] * w[1];
+  std::array<Scalar, 4> parameters;
+  parameters[0] = 0;
+  const auto count = solveUnitQuadratic(a, b, c, &parameters[1]);
+  parameters[count + 1] = 1;
+  const auto index = static_cast<std::uint32_t>(segments_.size());
+  segments_.emplace_back(segment);
+  auto previous = evaluate(y, w, 0);
+  for (auto i = 0; i <= count; ++i) {
+    const auto t0 = parameters[i];
+    const auto t1 = parameters[i + 1];
+    const auto next = evaluate(y, w, t1);
+    if (previous != next) {
+      pieces_.emplace_back(Piece{
+        index, t0, t1,
+        std::min(previous, next), std::max(previous, next),
+        previous < next ? 1 : -1
+      });
+    }
+    previous = next;
+  }
+}
+
+// Divides the rows the pieces span into as many bands as there are pieces,
+// and halves the count while the pieces would be listed more than 8 times
+// on average, which bounds the memory for pieces that span many rows.
+template <class T>
+inline void SegmentIndex<T, 2>::build() {
+  if (pieces_.empty()) {
+    return;
+  }
+  auto top = pieces_.front().top;
+  auto bottom = pieces_.front().bottom;
+  for (const auto& piece : pieces_) {
+    top = std::min(top, piece.top);
+    bottom = std::max(bottom, piece.bottom);
+  }
+  top_ = top;
+  auto bands = std::min(pieces_.size(), max_bands);
+  band_height_ = (bottom - top) / bands;
+  while (bands > 1 && countEntries(bands) > pieces_.size() * 8) {
+    bands /= 2;
+    band_height_ = (bottom - top) / bands;
+  }
+  if (!(band_height_ > 0)) {
+    bands = 1;
+    band_height_ = 1;
+  }
+
+  // Count the pieces in each band, and turn the counts into offsets.
+  offsets_.assign(bands + 1, 0);
+  for (const auto& piece : pieces_) {
+    const auto range = this->range(piece, bands);
+    for (auto band = range.first; band < range.second; ++band) {
+      ++offsets_[band + 1];
+    }
+  }
+  for (std::size_t band = 0; band < bands; ++band) {
+    offsets_[band + 1] += offsets_[band];
+  }
+  entries_.resize(offsets_.back());
+  std::vector<std::uint32_t> cursors(std::begin(offsets_),
+                                     std::prev(std::end(offsets_)));
+  for (std::uint32_t index = 0; index < pieces_.size(); ++index) {
+    const auto range = this->range(pieces_[index], bands);
+    for (auto band = range.first; band < range.second; ++band) {
+      entries_[cursors[band]++] = index;
+    }
+  }
+}
+
+template <class T>
+inline std::size_t SegmentIndex<T, 2>::countEntries(std::size_t bands) const {
+  std::size_t count{};
+  for (const auto& piece : pieces_) {
+    const auto range = this->range(piece, bands);
+    count += range.second - range.first;
+  }
+  return count;
+}
+
+// Returns the range of bands that the piece overlaps, out of the given
+// number of bands of the current height.
+template <class T>
+inline std::pair<std::size_t, std::size_t> SegmentIndex<T, 2>::range(
+    const Piece& piece,
+    std::size_t bands) const {
+  const auto band = [this, bands](Scalar y) {
+    const auto index = std::floor((y - top_) / band_height_);
+    return static_cast<std::size_t>(
+        std::min(std::max(index, Scalar(0)), Scalar(bands - 1)));
+  };
+  return std::make_pair(band(piece.top), band(piece.bottom) + 1);
+}
+
+#pragma mark Hit testing
+
+template <class T>
+inline int SegmentIndex<T, 2>::winding(const Vec2<Scalar>& point) const {
+  if (pieces_.empty()) {
+    return 0;
+  }
+  const auto index = std::floor((point.y - top_) / band_height_);
+  if (!(index >= 0 && index < offsets_.size() - 1)) {
+    return 0;
+  }
+  const auto band = static_cast<std::size_t>(index);
+  int winding{};
+  for (auto entry = offsets_[band]; entry < offsets_[band + 1]; ++entry) {
+    const auto& piece = pieces_[entries_[entry]];
+    if (point.y < piece.top || !(point.y < piece.bottom)) {
+      continue;
+    }
+    if (crossing(piece, point.y) > point.x) {
+      winding += piece.direction;
+    }
+  }
+  return winding;
+}
+
+#pragma mark Evaluation
+
+// Returns x where the piece crosses the row, by bisecting its parameter range
+// until it cannot be narrowed any further, which is direct for lines.
+template <class T>
+inline math::Promote<T> SegmentIndex<T, 2>::crossing(const Piece& piece,
+                                                     Scalar y) const {
+  const auto& segment = segments_[piece.segment];
+  if (!segment.y[0] && !segment.y[1] && !segment.w[0] && !segment.w[1]) {
+    const auto t = (y - segment.y[3]) / segment.y[2];
+    return evaluate(segment.x, segment.w, t);
+  }
+  auto lower = piece.t0;
+  auto upper = piece.t1;
+  for (auto i = 0; i < std::numeric_limits<Scalar>::digits; ++i) {
+    const auto middle = (lower + upper) / 2;
+    const auto value = evaluate(segment.y, segment.w, middle);
+    if ((value < y) == (piece.direction > 0)) {
+      lower = middle;
+    } else {
+      upper = middle;
+    }
+  }
+  return evaluate(segment.x, segment.w, (lower + upper) / 2);
+}
+
+// Evaluates the cubic over the quadratic of weights at the parameter, both of
+// which are in the power basis with the highest degree first.
+template <class T>
+inline math::Promote<T> SegmentIndex<T, 2>::evaluate(
+    const std::array<Scalar, 4>& coefficients,
+    const std::array<Scalar, 3>& w,
+    Scalar t) {
+  const auto& c = coefficients;
+  const auto numerator = ((c[0] * t + c[1]) * t + c[2]) * t + c[3];
+  const auto denominator = (w[0] * t + w[1]) * t + w[2];
+  return numerator / denominator;
+}
+
+// Writes the roots of at^2 + bt + c strictly between 0 and 1 in ascending
+// order, and returns their count.
+template <class T>
+inline int SegmentIndex<T, 2>::solveUnitQuadratic(Scalar a,
+                                                  Scalar b,
+                                                  Scalar c,
+                                                  Scalar *roots) {
+  assert(roots);
+  const auto inside = [](Scalar t) { return t > 0 && t < 1; };
+  int count{};
+  if (!a) {
+    if (b && inside(-c / b)) {
+      roots[count++] = -c / b;
+    }
+    return count;
+  }
+  const auto discriminant = b * b - 4 * a * c;
+  if (discriminant < 0) {
+    return count;
+  }
+  // Avoid the cancellation of the textbook formula by computing the root of
+  // larger magnitude first.
+  const auto root = std::sqrt(discriminant);
+  const auto q = b < 0 ? -(b - root) / 2 : -(b + root) / 2;
+  std::array<Scalar, 2> candidates{{q / a, q ? c / q : 0}};
+  if (candidates[0] > candidates[1]) {
+    std::swap(candidates[0], candidates[1]);
+  }
+  for (const auto& t : candidates) {
+    if (inside(t) && (!count || t != roots[count - 1])) {
+      roots[count++] = t;
+    }
+  }
+  return count;
+}
+
+#pragma mark Conversion
+
+template <class T>
+inline Vec2<math::Promote<T>> SegmentIndex<T, 2>::promote(
+    const Vec2<T>& point) {
+  return Vec2<Scalar>(point.x, point.y);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::SegmentIndex;
+using graphics::SegmentIndex2;
+using graphics::SegmentIndex2i;
+using graphics::SegmentIndex2f;
+using graphics::SegmentIndex2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_SEGMENT_INDEX_H_
@@ -28,12 +28,25 @@
 #ifndef SHOTA_GRAPHICS_SHAPE2_H_
 #define SHOTA_GRAPHICS_SHAPE2_H_
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstddef>
+#include <functional>
 #include <list>
 #include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "shotamatsuda/algorithm/leaf_iterator_iterator.h"
+#include "shotamatsuda/graphics/cache.h"
+#include "shotamatsuda/graphics/conic_subdivider.h"
+#include "shotamatsuda/graphics/fill_rule.h"
+#include "shotamatsuda/graphics/hash.h"
 #include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/path_normalization.h"
+#include "shotamatsuda/graphics/polymorphic_allocator.h"
 #include "shotamatsuda/math/promotion.h"
 #include "shotamatsuda/math/rectangle.h"
 #include "shotamatsuda/math/vector.h"
@@ -47,15 +60,26 @@ class Shape;
 template <class T>
 using Shape2 = Shape<T, 2>;
 
+// Paths are allocated from the memory resource given at construction, and
+// every path added to a shape is rebound to that resource. Building a scratch
+// shape on an ArenaResource lets it be discarded with a single reset.
+//
+// The bounds and hash of every path but the last are cached and extended as
+// paths are appended, and the last path caches its own, so bounds() and
+// hash() are constant time on a shape that has not changed. Non-const access
+// to any path other than the last discards the caches; a path must not be
+// mutated through a reference kept from before that access.
 template <class T>
 class Shape<T, 2> final {
  public:
   using Type = T;
+  using allocator_type = PolymorphicAllocator<Shape>;
+  using Paths = std::list<Path2<T>, PolymorphicAllocator<Path2<T>>>;
   using Iterator = LeafIteratorIterator<
-      typename std::list<Path2<T>>::iterator,
+      typename Paths::iterator,
       typename Path2<T>::Iterator>;
   using ConstIterator = LeafIteratorIterator<
-      typename std::list<Path2<T>>::const_iterator,
+      typename Paths::const_iterator,
       typename Path2<T>::ConstIterator>;
   using ReverseIterator = std::reverse_iterator<Iterator>;
   using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
@@ -63,21 +87,39 @@ class Shape<T, 2> final {
 
  public:
   Shape() = default;
-  explicit Shape(const Path2<T>& path);
-  explicit Shape(const std::list<Path2<T>>& paths);
+  explicit Shape(const allocator_type& allocator);
+  explicit Shape(const Path2<T>& path,
+                 const allocator_type& allocator = allocator_type());
+  explicit Shape(Path2<T>&& path,
+                 const allocator_type& allocator = allocator_type());
+  explicit Shape(const std::list<Path2<T>>& paths,
+                 const allocator_type& allocator = allocator_type());
+  explicit Shape(std::list<Path2<T>>&& paths,
+                 const allocator_type& allocator = allocator_type());
 
   // Copy semantics
   Shape(const Shape&) = default;
   Shape& operator=(const Shape&) = default;
 
+  // Move semantics
+  Shape(Shape&&) = default;
+  Shape& operator=(Shape&&) = default;
+
+  // Allocator-extended copy and move
+  Shape(const Shape& other, const allocator_type& allocator);
+  Shape(Shape&& other, const allocator_type& allocator);
+
   // Mutators
   void set(const std::list<Path2<T>>& paths);
+  void set(std::list<Path2<T>>&& paths);
   void reset();
 
   // Attributes
   bool empty() const { return paths_.empty(); }
   std::size_t size() const { return paths_.size(); }
   Rect2<math::Promote<T>> bounds(bool precise = false) const;
+  allocator_type allocator() const { return paths_.get_allocator(); }
+  std::size_t hash() const;
 
   // Adding commands
   void close();
@@ -97,21 +139,31 @@ class Shape<T, 2> final {
                const Vec2<T>& point);
 
   // Paths
-  const std::list<Path2<T>>& paths() const { return paths_; }
-  std::list<Path2<T>>& paths() { return paths_; }
+  const Paths& paths() const { return paths_; }
+  Paths& paths() { invalidate(); return paths_; }
+  Path2<T>& addPath(const Path2<T>& path);
+  Path2<T>& addPath(Path2<T>&& path);
 
   // Conversion
   bool convertQuadraticsToCubics();
   bool convertConicsToQuadratics();
   bool convertConicsToQuadratics(math::Promote<T> tolerance);
+  bool normalize(PathNormalization normalization,
+                 math::Promote<T> tolerance);
   bool removeDuplicates(math::Promote<T> threshold);
+  bool removeDuplicates(math::Promote<T> threshold, unsigned int concurrency);
+
+  // Hit testing
+  bool contains(const Vec2<T>& point,
+                FillRule rule = FillRule::NON_ZERO) const;
+  int winding(const Vec2<T>& point) const;
 
   // Element access
   Path2<T>& operator[](int index) { return at(index); }
   const Path2<T>& operator[](int index) const { return at(index); }
   Path2<T>& at(int index);
   const Path2<T>& at(int index) const;
-  Path2<T>& front() { return paths_.front(); }
+  Path2<T>& front() { invalidate(); return paths_.front(); }
   const Path2<T>& front() const { return paths_.front(); }
   Path2<T>& back() { return paths_.back(); }
   const Path2<T>& back() const { return paths_.back(); }
@@ -127,7 +179,19 @@ class Shape<T, 2> final {
   ConstReverseIterator rend() const { return ConstReverseIterator(end()); }
 
  private:
-  std::list<Path2<T>> paths_;
+  // Bounding box
+  Rect2<math::Promote<T>> calculateBounds(bool precise) const;
+  std::size_t calculateHash() const;
+  static void include(Rect2<math::Promote<T>>& result,
+                      const Rect2<math::Promote<T>>& bounds);
+  void seal();
+  void invalidate();
+
+ private:
+  Paths paths_;
+  Cache<Rect2<math::Promote<T>>> approximate_bounds_;
+  Cache<Rect2<math::Promote<T>>> precise_bounds_;
+  Cache<std::size_t> hash_;
 };
 
 // Comparison
@@ -143,20 +207,60 @@ using Shape2d = Shape2<double>;
 #pragma mark -
 
 template <class T>
-inline Shape<T, 2>::Shape(const Path2<T>& path) : paths_{path} {}
+inline Shape<T, 2>::Shape(const allocator_type& allocator)
+    : paths_(allocator) {}
+
+template <class T>
+inline Shape<T, 2>::Shape(const Path2<T>& path,
+                          const allocator_type& allocator)
+    : paths_(allocator) {
+  paths_.emplace_back(path);
+}
+
+template <class T>
+inline Shape<T, 2>::Shape(Path2<T>&& path, const allocator_type& allocator)
+    : paths_(allocator) {
+  paths_.emplace_back(std::move(path));
+}
+
+template <class T>
+inline Shape<T, 2>::Shape(const std::list<Path2<T>>& paths,
+                          const allocator_type& allocator)
+    : paths_(std::begin(paths), std::end(paths), allocator) {}
+
+template <class T>
+inline Shape<T, 2>::Shape(std::list<Path2<T>>&& paths,
+                          const allocator_type& allocator)
+    : paths_(std::make_move_iterator(std::begin(paths)),
+             std::make_move_iterator(std::end(paths)),
+             allocator) {}
 
 template <class T>
-inline Shape<T, 2>::Shape(const std::list<Path2<T>>& paths) : paths_(paths) {}
+inline Shape<T, 2>::Shape(const Shape& other, const allocator_type& allocator)
+    : paths_(other.paths_, allocator) {}
+
+template <class T>
+inline Shape<T, 2>::Shape(Shape&& other, const allocator_type& allocator)
+    : paths_(std::move(other.paths_), allocator) {}
 
 #pragma mark Mutators
 
 template <class T>
 inline void Shape<T, 2>::set(const std::list<Path2<T>>& paths) {
-  paths_ = paths;
+  invalidate();
+  paths_.assign(std::begin(paths), std::end(paths));
+}
+
+template <class T>
+inline void Shape<T, 2>::set(std::list<Path2<T>>&& paths) {
+  invalidate();
+  paths_.assign(std::make_move_iterator(std::begin(paths)),
+                std::make_move_iterator(std::end(paths)));
 }
 
 template <class T>
 inline void Shape<T, 2>::reset() {
+  invalidate();
   paths_.clear();
 }
 
@@ -164,7 +268,9 @@ inline void Shape<T, 2>::reset() {
 
 template <class T, class U>
 inline bool operator==(const Shape2<T>& lhs, const Shape2<U>& rhs) {
-  return lhs.paths() == rhs.paths();
+  return (lhs.size() == rhs.size() &&
+          std::equal(std::begin(lhs.paths()), std::end(lhs.paths()),
+                     std::begin(rhs.paths())));
 }
 
 template <class T, class U>
@@ -179,19 +285,95 @@ inline Rect2<math::Promote<T>> Shape<T, 2>::bounds(bool precise) const {
   if (paths_.empty()) {
     return Rect2<math::Promote<T>>();
   }
+  const auto& cache = precise ? precise_bounds_ : approximate_bounds_;
+  auto result = cache.get([this, precise] {
+    return calculateBounds(precise);
+  });
+  include(result, paths_.back().bounds(precise));
+  return result;
+}
+
+template <class T>
+inline Rect2<math::Promote<T>> Shape<T, 2>::calculateBounds(
+    bool precise) const {
   Rect2<math::Promote<T>> result;
-  for (const auto& path : paths_) {
-    const auto bounds = path.bounds(precise);
-    if (bounds.empty()) {
-      continue;
-    }
-    if (result.empty()) {
-      result = std::move(bounds);
-    } else {
-      result.include(std::move(bounds));
-    }
+  if (paths_.empty()) {
+    return result;
   }
-  return std::move(result);
+  for (auto itr = std::begin(paths_); itr != std::prev(std::end(paths_));
+       ++itr) {
+    include(result, itr->bounds(precise));
+  }
+  return result;
+}
+
+template <class T>
+inline void Shape<T, 2>::include(Rect2<math::Promote<T>>& result,
+                                 const Rect2<math::Promote<T>>& bounds) {
+  if (bounds.empty()) {
+    return;
+  }
+  if (result.empty()) {
+    result = bounds;
+  } else {
+    result.include(bounds);
+  }
+}
+
+template <class T>
+inline void Shape<T, 2>::seal() {
+  // Called before appending a path, so that the current last path moves into
+  // the cached bounds and hash instead of discarding them.
+  if (paths_.empty()) {
+    return;
+  }
+  if (const auto cached = approximate_bounds_.find()) {
+    auto bounds = *cached;
+    include(bounds, paths_.back().bounds(false));
+    approximate_bounds_.set(bounds);
+  }
+  if (const auto cached = precise_bounds_.find()) {
+    auto bounds = *cached;
+    include(bounds, paths_.back().bounds(true));
+    precise_bounds_.set(bounds);
+  }
+  if (const auto cached = hash_.find()) {
+    auto seed = *cached;
+    hashCombine(seed, paths_.back().hash());
+    hash_.set(seed);
+  }
+}
+
+template <class T>
+inline void Shape<T, 2>::invalidate() {
+  approximate_bounds_.reset();
+  precise_bounds_.reset();
+  hash_.reset();
+}
+
+template <class T>
+inline std::size_t Shape<T, 2>::hash() const {
+  if (paths_.empty()) {
+    return std::size_t();
+  }
+  auto seed = hash_.get([this] {
+    return calculateHash();
+  });
+  hashCombine(seed, paths_.back().hash());
+  return seed;
+}
+
+template <class T>
+inline std::size_t Shape<T, 2>::calculateHash() const {
+  std::size_t seed{};
+  if (paths_.empty()) {
+    return seed;
+  }
+  for (auto itr = std::begin(paths_); itr != std::prev(std::end(paths_));
+       ++itr) {
+    hashCombine(seed, itr->hash());
+  }
+  return seed;
 }
 
 #pragma mark Adding commands
@@ -206,6 +388,7 @@ inline void Shape<T, 2>::close() {
 
 template <class T>
 inline void Shape<T, 2>::moveTo(T x, T y) {
+  seal();
   paths_.emplace_back();
   paths_.back().moveTo(x, y);
 }
@@ -288,10 +471,27 @@ inline void Shape<T, 2>::cubicTo(const Vec2<T>& control1,
   paths_.back().cubicTo(control1, control2, point);
 }
 
+#pragma mark Paths
+
+template <class T>
+inline Path2<T>& Shape<T, 2>::addPath(const Path2<T>& path) {
+  seal();
+  paths_.emplace_back(path);
+  return paths_.back();
+}
+
+template <class T>
+inline Path2<T>& Shape<T, 2>::addPath(Path2<T>&& path) {
+  seal();
+  paths_.emplace_back(std::move(path));
+  return paths_.back();
+}
+
 #pragma mark Conversion
 
 template <class T>
 inline bool Shape<T, 2>::convertQuadraticsToCubics() {
+  invalidate();
   bool changed{};
   for (auto& path : paths_) {
     if (path.convertQuadraticsToCubics()) {
@@ -303,6 +503,7 @@ inline bool Shape<T, 2>::convertQuadraticsToCubics() {
 
 template <class T>
 inline bool Shape<T, 2>::convertConicsToQuadratics() {
+  invalidate();
   bool changed{};
   for (auto& path : paths_) {
     if (path.convertConicsToQuadratics()) {
@@ -314,17 +515,38 @@ inline bool Shape<T, 2>::convertConicsToQuadratics() {
 
 template <class T>
 inline bool Shape<T, 2>::convertConicsToQuadratics(math::Promote<T> tolerance) {
+  invalidate();
+  // Share the packets across paths, so that they fill up even when every
+  // path has only a few conics.
+  ConicSubdivider2<T> subdivider;
   bool changed{};
   for (auto& path : paths_) {
-    if (path.convertConicsToQuadratics(tolerance)) {
+    if (path.convertConicsToQuadratics(tolerance, &subdivider)) {
       changed = true;
     }
   }
+  subdivider.flush();
+  return changed;
+}
+
+template <class T>
+inline bool Shape<T, 2>::normalize(PathNormalization normalization,
+                                   math::Promote<T> tolerance) {
+  invalidate();
+  ConicSubdivider2<T> subdivider;
+  bool changed{};
+  for (auto& path : paths_) {
+    if (path.normalize(normalization, tolerance, &subdivider)) {
+      changed = true;
+    }
+  }
+  subdivider.flush();
   return changed;
 }
 
 template <class T>
 inline bool Shape<T, 2>::removeDuplicates(math::Promote<T> threshold) {
+  invalidate();
   bool changed{};
   for (auto& path : paths_) {
     if (path.removeDuplicates(threshold)) {
@@ -334,10 +556,88 @@ inline bool Shape<T, 2>::removeDuplicates(math::Promote<T> threshold) {
   return changed;
 }
 
+// Paths are handed out one at a time to the given number of threads, which
+// includes the calling thread. Whether a path must detach is decided from the
+// use count of its storage, which is only reliable on one thread, so paths
+// that share storage, such as those interned by PathPool, are processed on the
+// calling thread before the others are handed out.
+template <class T>
+inline bool Shape<T, 2>::removeDuplicates(math::Promote<T> threshold,
+                                          unsigned int concurrency) {
+  invalidate();
+  bool changed{};
+  std::vector<Path2<T> *> targets;
+  targets.reserve(paths_.size());
+  for (auto& path : paths_) {
+    if (!path.shared()) {
+      targets.emplace_back(&path);
+    } else if (path.removeDuplicates(threshold)) {
+      changed = true;
+    }
+  }
+  concurrency = std::min<std::size_t>(concurrency, targets.size());
+  if (concurrency < 2) {
+    for (const auto& target : targets) {
+      if (target->removeDuplicates(threshold)) {
+        changed = true;
+      }
+    }
+    return changed;
+  }
+  std::atomic<std::size_t> next{};
+  std::atomic<bool> concurrent_changed{};
+  const auto work = [&]() {
+    for (auto index = next++; index < targets.size(); index = next++) {
+      if (targets[index]->removeDuplicates(threshold)) {
+        concurrent_changed.store(true, std::memory_order_relaxed);
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(concurrency - 1);
+  for (unsigned int i{1}; i < concurrency; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return changed || concurrent_changed;
+}
+
+#pragma mark Hit testing
+
+template <class T>
+inline bool Shape<T, 2>::contains(const Vec2<T>& point, FillRule rule) const {
+  const auto winding = this->winding(point);
+  switch (rule) {
+    case FillRule::NON_ZERO:
+      return winding;
+    case FillRule::EVEN_ODD:
+      return winding & 1;
+    default:
+      assert(false);
+      break;
+  }
+  return false;
+}
+
+// The paths of a shape are filled together, so their windings add up. Each
+// path rejects the point by its own bounds, and consults its own index.
+template <class T>
+inline int Shape<T, 2>::winding(const Vec2<T>& point) const {
+  int winding{};
+  for (const auto& path : paths_) {
+    winding += path.winding(point);
+  }
+  return winding;
+}
+
 #pragma mark Element access
 
 template <class T>
 inline Path2<T>& Shape<T, 2>::at(int index) {
+  invalidate();
   auto itr = std::begin(paths_);
   std::advance(itr, index);
   return *itr;
@@ -384,4 +684,15 @@ using graphics::Shape2d;
 
 }  // namespace shotamatsuda
 
+namespace std {
+
+template <class T>
+struct hash<shotamatsuda::graphics::Shape2<T>> {
+  std::size_t operator()(const shotamatsuda::graphics::Shape2<T>& shape) const {
+    return shape.hash();
+  }
+};
+
+}  // namespace std
+
 #endif  // SHOTA_GRAPHICS_SHAPE2_H_
@@ -0,0 +1,96 @@
+//
+//  shotamatsuda/graphics/simd.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_SIMD_H_
+#define SHOTA_GRAPHICS_SIMD_H_
+
+// Instruction sets are detected from the compiler's target flags, and each
+// can be turned off by defining its SHOTA_HAS_ macro to 0 beforehand.
+
+#ifndef SHOTA_HAS_AVX2
+#if defined(__AVX2__)
+#define SHOTA_HAS_AVX2 1
+#else
+#define SHOTA_HAS_AVX2 0
+#endif
+#endif  // SHOTA_HAS_AVX2
+
+#ifndef SHOTA_HAS_AVX
+#if defined(__AVX__)
+#define SHOTA_HAS_AVX 1
+#else
+#define SHOTA_HAS_AVX 0
+#endif
+#endif  // SHOTA_HAS_AVX
+
+#ifndef SHOTA_HAS_SSE4_1
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define SHOTA_HAS_SSE4_1 1
+#else
+#define SHOTA_HAS_SSE4_1 0
+#endif
+#endif  // SHOTA_HAS_SSE4_1
+
+#ifndef SHOTA_HAS_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SHOTA_HAS_SSE2 1
+#else
+#define SHOTA_HAS_SSE2 0
+#endif
+#endif  // SHOTA_HAS_SSE2
+
+#ifndef SHOTA_HAS_NEON
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SHOTA_HAS_NEON 1
+#else
+#define SHOTA_HAS_NEON 0
+#endif
+#endif  // SHOTA_HAS_NEON
+
+#ifndef SHOTA_HAS_NEON_FP64
+#if SHOTA_HAS_NEON && defined(__aarch64__)
+#define SHOTA_HAS_NEON_FP64 1
+#else
+#define SHOTA_HAS_NEON_FP64 0
+#endif
+#endif  // SHOTA_HAS_NEON_FP64
+
+#if SHOTA_HAS_AVX || SHOTA_HAS_AVX2
+#include <immintrin.h>
+#endif
+#if SHOTA_HAS_SSE4_1
+#include <smmintrin.h>
+#endif
+#if SHOTA_HAS_SSE2
+#include <emmintrin.h>
+#endif
+#if SHOTA_HAS_NEON
+#include <arm_neon.h>
+#endif
+
+#endif  // SHOTA_GRAPHICS_SIMD_H_
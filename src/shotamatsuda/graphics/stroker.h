@@ -0,0 +1,864 @@
+//
+//  shotamatsuda/graphics/stroker.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_STROKER_H_
+#define SHOTA_GRAPHICS_STROKER_H_
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/conic.h"
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/graphics/stroke_cap.h"
+#include "shotamatsuda/graphics/stroke_join.h"
+#include "shotamatsuda/math/promotion.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class Stroker;
+
+template <class T>
+using Stroker2 = Stroker<T, 2>;
+
+// Outlines the strokes of paths as shapes to be filled with the nonzero rule.
+// Each contour is offset to both of its sides, curves into curves of the same
+// kind: quadratics and conics are offset by intersecting the tangents at the
+// ends of the offset, cubics by intersecting the offset legs of their control
+// polygons, and a piece is split in half until the midpoint of its offset
+// lies within the tolerance of the true offset. Round joins and caps are
+// emitted as conics, so they are exact arcs.
+//
+// An open contour becomes one closed path running along one side and back
+// along the other, and a closed contour becomes a path for each side, the
+// inner one reversed. The sides are built in buffers that the stroker keeps
+// between calls, so stroking allocates nothing but the resulting paths once
+// the buffers have grown.
+template <class T>
+class Stroker<T, 2> final {
+ public:
+  using Type = T;
+  using Scalar = math::Promote<T>;
+  static constexpr const int dimensions = 2;
+  static constexpr const unsigned int max_subdivision = 5;
+
+ public:
+  explicit Stroker(Scalar width = 1,
+                   StrokeJoin join = StrokeJoin::MITER,
+                   StrokeCap cap = StrokeCap::BUTT,
+                   Scalar miter_limit = 4,
+                   Scalar tolerance = 0.25);
+
+  // Copy semantics
+  Stroker(const Stroker&) = default;
+  Stroker& operator=(const Stroker&) = default;
+
+  // Move semantics
+  Stroker(Stroker&&) = default;
+  Stroker& operator=(Stroker&&) = default;
+
+  // Attributes
+  Scalar width() const { return width_; }
+  void setWidth(Scalar value);
+  StrokeJoin join() const { return join_; }
+  void setJoin(StrokeJoin value) { join_ = value; }
+  StrokeCap cap() const { return cap_; }
+  void setCap(StrokeCap value) { cap_ = value; }
+  Scalar miterLimit() const { return miter_limit_; }
+  void setMiterLimit(Scalar value) { miter_limit_ = value; }
+  Scalar tolerance() const { return tolerance_; }
+  void setTolerance(Scalar value) { tolerance_ = value; }
+
+  // Stroking
+  void stroke(const Path2<T>& path, Shape2<T> *shape);
+  void stroke(const Shape2<T>& shape, Shape2<T> *result);
+
+ private:
+  // One side of a contour, stored like the arrays of a path.
+  struct Side {
+    void clear();
+    void moveTo(const Vec2<Scalar>& point);
+    void lineTo(const Vec2<Scalar>& point);
+    void quadraticTo(const Vec2<Scalar>& control, const Vec2<Scalar>& point);
+    void conicTo(const Vec2<Scalar>& control,
+                 const Vec2<Scalar>& point,
+                 Scalar weight);
+    void cubicTo(const Vec2<Scalar>& control1,
+                 const Vec2<Scalar>& control2,
+                 const Vec2<Scalar>& point);
+
+    std::vector<CommandType> verbs;
+    std::vector<Vec2<Scalar>> points;
+    std::vector<Scalar> weights;
+  };
+
+  // Contours
+  void begin(const Vec2<Scalar>& point);
+  void finish(Shape2<T> *shape);
+  void close(Shape2<T> *shape);
+  void emit(const Side& side, Shape2<T> *shape) const;
+  static void appendReversed(const Side& side, Side *result);
+
+  // Segments
+  void addLine(const Vec2<Scalar>& point);
+  void addConic(const Conic2<Scalar>& conic, bool quadratic);
+  void addCubic(const Vec2<Scalar>& p0,
+                const Vec2<Scalar>& p1,
+                const Vec2<Scalar>& p2,
+                const Vec2<Scalar>& p3);
+  bool offsetConic(const Conic2<Scalar>& conic,
+                   const Vec2<Scalar>& t0,
+                   const Vec2<Scalar>& t1,
+                   Scalar distance,
+                   std::array<Vec2<Scalar>, 3> *result) const;
+  bool offsetCubic(const std::array<Vec2<Scalar>, 4>& cubic,
+                   const Vec2<Scalar>& t0,
+                   const Vec2<Scalar>& t1,
+                   Scalar distance,
+                   std::array<Vec2<Scalar>, 4> *result) const;
+  static std::pair<std::array<Vec2<Scalar>, 4>, std::array<Vec2<Scalar>, 4>>
+      chop(const std::array<Vec2<Scalar>, 4>& cubic);
+
+  // Joins and caps
+  void addJoin(const Vec2<Scalar>& tangent);
+  void addCap(const Vec2<Scalar>& point,
+              const Vec2<Scalar>& tangent,
+              Side *side) const;
+  void addDot(Shape2<T> *shape);
+  static void addArc(const Vec2<Scalar>& center,
+                     Vec2<Scalar> radius,
+                     Scalar angle,
+                     int pieces,
+                     Side *side);
+
+  // Vectors
+  Scalar radius() const { return width_ / 2; }
+  static bool unit(const Vec2<Scalar>& vector, Vec2<Scalar> *result);
+  static bool tangents(const Vec2<Scalar> *points,
+                       int count,
+                       Vec2<Scalar> *start,
+                       Vec2<Scalar> *end);
+  static Vec2<Scalar> normal(const Vec2<Scalar>& tangent);
+  static Vec2<Scalar> intersect(const Vec2<Scalar>& p0,
+                                const Vec2<Scalar>& t0,
+                                const Vec2<Scalar>& p1,
+                                const Vec2<Scalar>& t1);
+  static Vec2<Scalar> promote(const Vec2<T>& point);
+  static Vec2<T> demote(const Vec2<Scalar>& point);
+
+ private:
+  Scalar width_;
+  StrokeJoin join_;
+  StrokeCap cap_;
+  Scalar miter_limit_;
+  Scalar tolerance_;
+
+  // Scratch state of the contour being stroked
+  Side outer_;
+  Side inner_;
+  Vec2<Scalar> start_;
+  Vec2<Scalar> current_;
+  Vec2<Scalar> first_tangent_;
+  Vec2<Scalar> previous_tangent_;
+  unsigned int segments_;
+  bool degenerate_;
+};
+
+using Stroker2i = Stroker2<int>;
+using Stroker2f = Stroker2<float>;
+using Stroker2d = Stroker2<double>;
+
+#pragma mark -
+
+template <class T>
+constexpr const unsigned int Stroker<T, 2>::max_subdivision;
+
+template <class T>
+inline Stroker<T, 2>::Stroker(Scalar width,
+                              StrokeJoin join,
+                              StrokeCap cap,
+                              Scalar miter_limit,
+                              Scalar tolerance)
+    : width_(width),
+      join_(join),
+      cap_(cap),
+      miter_limit_(miter_limit),
+      tolerance_(tolerance),
+      segments_(),
+      degenerate_() {
+  assert(width >= 0);
+}
+
+#pragma mark Attributes
+
+template <class T>
+inline void Stroker<T, 2>::setWidth(Scalar value) {
+  assert(value >= 0);
+  width_ = value;
+}
+
+#pragma mark Stroking
+
+template <class T>
+inline void Stroker<T, 2>::stroke(const Path2<T>& path, Shape2<T> *shape) {
+  assert(shape);
+  if (!(width_ > 0)) {
+    return;
+  }
+  bool open{};
+  auto point = path.points().data();
+  auto weight = path.weights().data();
+  for (const auto& type : path.verbs()) {
+    // A command following a close continues from the last point, as it does
+    // in the path.
+    if (type != CommandType::MOVE && type != CommandType::CLOSE && !open) {
+      begin(promote(point[-1]));
+      open = true;
+    }
+    switch (type) {
+      case CommandType::MOVE:
+        if (open) {
+          finish(shape);
+        }
+        begin(promote(point[0]));
+        open = true;
+        break;
+      case CommandType::LINE:
+        addLine(promote(point[0]));
+        break;
+      case CommandType::QUADRATIC:
+        addConic(Conic2<Scalar>(promote(point[-1]), promote(point[0]),
+                                promote(point[1]), 1), true);
+        break;
+      case CommandType::CONIC:
+        addConic(Conic2<Scalar>(promote(point[-1]), promote(point[0]),
+                                promote(point[1]), *weight++), false);
+        break;
+      case CommandType::CUBIC:
+        addCubic(promote(point[-1]), promote(point[0]),
+                 promote(point[1]), promote(point[2]));
+        break;
+      case CommandType::CLOSE:
+        if (open) {
+          close(shape);
+          open = false;
+        }
+        break;
+      default:
+        assert(false);
+        break;
+    }
+    point += pointCount(type);
+  }
+  if (open) {
+    finish(shape);
+  }
+}
+
+template <class T>
+inline void Stroker<T, 2>::stroke(const Shape2<T>& shape, Shape2<T> *result) {
+  for (const auto& path : shape.paths()) {
+    stroke(path, result);
+  }
+}
+
+#pragma mark Contours
+
+template <class T>
+inline void Stroker<T, 2>::begin(const Vec2<Scalar>& point) {
+  outer_.clear();
+  inner_.clear();
+  start_ = point;
+  current_ = point;
+  segments_ = 0;
+  degenerate_ = false;
+}
+
+// Emits an open contour as one path that runs along the outer side, around
+// the end cap, back along the inner side and around the start cap.
+template <class T>
+inline void Stroker<T, 2>::finish(Shape2<T> *shape) {
+  if (!segments_) {
+    if (degenerate_) {
+      addDot(shape);
+    }
+    return;
+  }
+  addCap(current_, previous_tangent_, &outer_);
+  appendReversed(inner_, &outer_);
+  addCap(start_, -first_tangent_, &outer_);
+  emit(outer_, shape);
+  segments_ = 0;
+}
+
+// Emits a closed contour as a path for each side, after joining its last
+// segment to its first.
+template <class T>
+inline void Stroker<T, 2>::close(Shape2<T> *shape) {
+  if (!segments_) {
+    if (degenerate_) {
+      addDot(shape);
+    }
+    begin(start_);
+    return;
+  }
+  addLine(start_);
+  addJoin(first_tangent_);
+  emit(outer_, shape);
+  outer_.clear();
+  appendReversed(inner_, &outer_);
+  emit(outer_, shape);
+  begin(start_);
+}
+
+template <class T>
+inline void Stroker<T, 2>::emit(const Side& side, Shape2<T> *shape) const {
+  Path2<T> path(shape->allocator());
+  path.reserve(side.verbs.size() + 1, side.points.size());
+  auto point = side.points.data();
+  auto weight = side.weights.data();
+  for (const auto& type : side.verbs) {
+    switch (type) {
+      case CommandType::MOVE:
+        path.moveTo(demote(point[0]));
+        break;
+      case CommandType::LINE:
+        path.lineTo(demote(point[0]));
+        break;
+      case CommandType::QUADRATIC:
+        path.quadraticTo(demote(point[0]), demote(point[1]));
+        break;
+      case CommandType::CONIC:
+        path.conicTo(demote(point[0]), demote(point[1]), *weight++);
+        break;
+      case CommandType::CUBIC:
+        path.cubicTo(demote(point[0]), demote(point[1]), demote(point[2]));
+        break;
+      default:
+        assert(false);
+        break;
+    }
+    point += pointCount(type);
+  }
+  path.close();
+  shape->addPath(std::move(path));
+}
+
+// Appends the commands of the side in reverse order, starting a contour at
+// its last point unless the result already ends there.
+template <class T>
+inline void Stroker<T, 2>::appendReversed(const Side& side, Side *result) {
+  assert(result);
+  if (side.points.empty()) {
+    return;
+  }
+  if (result->verbs.empty()) {
+    result->moveTo(side.points.back());
+  }
+  auto point = side.points.data() + side.points.size();
+  auto weight = side.weights.data() + side.weights.size();
+  for (auto itr = side.verbs.rbegin(); itr != side.verbs.rend(); ++itr) {
+    point -= pointCount(*itr);
+    switch (*itr) {
+      case CommandType::MOVE:
+        break;
+      case CommandType::LINE:
+        result->lineTo(point[-1]);
+        break;
+      case CommandType::QUADRATIC:
+        result->quadraticTo(point[0], point[-1]);
+        break;
+      case CommandType::CONIC:
+        result->conicTo(point[0], point[-1], *--weight);
+        break;
+      case CommandType::CUBIC:
+        result->cubicTo(point[1], point[0], point[-1]);
+        break;
+      default:
+        assert(false);
+        break;
+    }
+  }
+}
+
+#pragma mark Segments
+
+template <class T>
+inline void Stroker<T, 2>::addLine(const Vec2<Scalar>& point) {
+  Vec2<Scalar> tangent;
+  if (!unit(point - current_, &tangent)) {
+    degenerate_ = true;
+    return;
+  }
+  addJoin(tangent);
+  const auto offset = normal(tangent) * radius();
+  outer_.lineTo(point + offset);
+  inner_.lineTo(point - offset);
+  previous_tangent_ = tangent;
+  current_ = point;
+}
+
+// Quadratics are passed as conics of weight 1, whose halves are quadratics.
+template <class T>
+inline void Stroker<T, 2>::addConic(const Conic2<Scalar>& conic,
+                                    bool quadratic) {
+  Vec2<Scalar> t0;
+  Vec2<Scalar> t1;
+  if (!tangents(conic.points.data(), 3, &t0, &t1)) {
+    degenerate_ = true;
+    return;
+  }
+  // Walk the halves depth first with an explicit stack, as in
+  // Conic::subdivide().
+  std::array<std::pair<Conic2<Scalar>, unsigned int>,
+             max_subdivision + 1> stack;
+  auto top = std::begin(stack);
+  *top++ = std::make_pair(conic, max_subdivision);
+  while (top != std::begin(stack)) {
+    const auto entry = *--top;
+    const auto& piece = entry.first;
+    if (!tangents(piece.points.data(), 3, &t0, &t1)) {
+      continue;
+    }
+    std::array<Vec2<Scalar>, 3> outer;
+    std::array<Vec2<Scalar>, 3> inner;
+    const auto fits = offsetConic(piece, t0, t1, radius(), &outer) &&
+                      offsetConic(piece, t0, t1, -radius(), &inner);
+    if (!fits && entry.second) {
+      const auto pair = piece.chop();
+      *top++ = std::make_pair(pair.second, entry.second - 1);
+      *top++ = std::make_pair(pair.first, entry.second - 1);
+      continue;
+    }
+    addJoin(t0);
+    if (quadratic) {
+      outer_.quadraticTo(outer[1], outer[2]);
+      inner_.quadraticTo(inner[1], inner[2]);
+    } else {
+      outer_.conicTo(outer[1], outer[2], piece.weight);
+      inner_.conicTo(inner[1], inner[2], piece.weight);
+    }
+    previous_tangent_ = t1;
+    current_ = piece.c;
+  }
+}
+
+template <class T>
+inline void Stroker<T, 2>::addCubic(const Vec2<Scalar>& p0,
+                                    const Vec2<Scalar>& p1,
+                                    const Vec2<Scalar>& p2,
+                                    const Vec2<Scalar>& p3) {
+  const std::array<Vec2<Scalar>, 4> cubic{{p0, p1, p2, p3}};
+  Vec2<Scalar> t0;
+  Vec2<Scalar> t1;
+  if (!tangents(cubic.data(), 4, &t0, &t1)) {
+    degenerate_ = true;
+    return;
+  }
+  std::array<std::pair<std::array<Vec2<Scalar>, 4>, unsigned int>,
+             max_subdivision + 1> stack;
+  auto top = std::begin(stack);
+  *top++ = std::make_pair(cubic, max_subdivision);
+  while (top != std::begin(stack)) {
+    const auto entry = *--top;
+    const auto& piece = entry.first;
+    if (!tangents(piece.data(), 4, &t0, &t1)) {
+      continue;
+    }
+    std::array<Vec2<Scalar>, 4> outer;
+    std::array<Vec2<Scalar>, 4> inner;
+    const auto fits = offsetCubic(piece, t0, t1, radius(), &outer) &&
+                      offsetCubic(piece, t0, t1, -radius(), &inner);
+    if (!fits && entry.second) {
+      const auto pair = chop(piece);
+      *top++ = std::make_pair(pair.second, entry.second - 1);
+      *top++ = std::make_pair(pair.first, entry.second - 1);
+      continue;
+    }
+    addJoin(t0);
+    outer_.cubicTo(outer[1], outer[2], outer[3]);
+    inner_.cubicTo(inner[1], inner[2], inner[3]);
+    previous_tangent_ = t1;
+    current_ = piece[3];
+  }
+}
+
+// Offsets the ends along their normals and places the control point where
+// the tangents there meet, which is exact for a circular arc. The offset fits
+// when it turns by less than 60 degrees and its midpoint lies within the
+// tolerance of the true offset of the conic's midpoint.
+template <class T>
+inline bool Stroker<T, 2>::offsetConic(
+    const Conic2<Scalar>& conic,
+    const Vec2<Scalar>& t0,
+    const Vec2<Scalar>& t1,
+    Scalar distance,
+    std::array<Vec2<Scalar>, 3> *result) const {
+  assert(result);
+  auto& offset = *result;
+  offset[0] = conic.a + normal(t0) * distance;
+  offset[2] = conic.c + normal(t1) * distance;
+  const auto cosine = t0.x * t1.x + t0.y * t1.y;
+  if (cosine > 0) {
+    offset[1] = intersect(offset[0], t0, offset[2], t1);
+  } else {
+    offset[1] = (offset[0] + offset[2]) / 2;
+  }
+  Vec2<Scalar> tangent;
+  if (!(cosine > Scalar(0.5)) || !unit(conic.c - conic.a, &tangent)) {
+    return false;
+  }
+  const auto w = conic.weight;
+  const auto scale = 1 / (2 * (1 + w));
+  const auto middle = (conic.a + conic.b * (2 * w) + conic.c) * scale;
+  const auto expected = middle + normal(tangent) * distance;
+  const auto actual = (offset[0] + offset[1] * (2 * w) + offset[2]) * scale;
+  return (expected - actual).lengthSquared() <= tolerance_ * tolerance_;
+}
+
+// Offsets the legs of the control polygon along their normals, and places
+// the control points where the middle leg meets the others, falling back to
+// translating the control points where the legs are parallel.
+template <class T>
+inline bool Stroker<T, 2>::offsetCubic(
+    const std::array<Vec2<Scalar>, 4>& cubic,
+    const Vec2<Scalar>& t0,
+    const Vec2<Scalar>& t1,
+    Scalar distance,
+    std::array<Vec2<Scalar>, 4> *result) const {
+  assert(result);
+  auto& offset = *result;
+  const auto n0 = normal(t0) * distance;
+  const auto n1 = normal(t1) * distance;
+  offset[0] = cubic[0] + n0;
+  offset[3] = cubic[3] + n1;
+  offset[1] = cubic[1] + n0;
+  offset[2] = cubic[2] + n1;
+  Vec2<Scalar> middle;
+  if (unit(cubic[2] - cubic[1], &middle)) {
+    const auto shifted = cubic[1] + normal(middle) * distance;
+    if (middle.x * t0.x + middle.y * t0.y > 0) {
+      offset[1] = intersect(offset[0], t0, shifted, middle);
+    }
+    if (middle.x * t1.x + middle.y * t1.y > 0) {
+      offset[2] = intersect(offset[3], t1, shifted, middle);
+    }
+  }
+  Vec2<Scalar> tangent;
+  const auto cosine = t0.x * t1.x + t0.y * t1.y;
+  if (!(cosine > Scalar(0.5)) ||
+      !unit(cubic[3] + cubic[2] - cubic[1] - cubic[0], &tangent)) {
+    return false;
+  }
+  const auto middle_point = (cubic[0] + cubic[3] +
+                             (cubic[1] + cubic[2]) * 3) / 8;
+  const auto expected = middle_point + normal(tangent) * distance;
+  const auto actual = (offset[0] + offset[3] +
+                       (offset[1] + offset[2]) * 3) / 8;
+  return (expected - actual).lengthSquared() <= tolerance_ * tolerance_;
+}
+
+template <class T>
+inline std::pair<std::array<Vec2<math::Promote<T>>, 4>,
+                 std::array<Vec2<math::Promote<T>>, 4>>
+    Stroker<T, 2>::chop(const std::array<Vec2<Scalar>, 4>& cubic) {
+  const auto ab = (cubic[0] + cubic[1]) / 2;
+  const auto bc = (cubic[1] + cubic[2]) / 2;
+  const auto cd = (cubic[2] + cubic[3]) / 2;
+  const auto abc = (ab + bc) / 2;
+  const auto bcd = (bc + cd) / 2;
+  const auto middle = (abc + bcd) / 2;
+  return std::make_pair(
+      std::array<Vec2<Scalar>, 4>{{cubic[0], ab, abc, middle}},
+      std::array<Vec2<Scalar>, 4>{{middle, bcd, cd, cubic[3]}});
+}
+
+#pragma mark Joins and caps
+
+// Connects both sides from the end of the previous segment to the start of
+// one leaving in the given direction, or starts them if it is the first. The
+// side on the outside of the turn gets the join, and the other doubles back
+// through the path, where the overlap is filled under the nonzero rule.
+template <class T>
+inline void Stroker<T, 2>::addJoin(const Vec2<Scalar>& tangent) {
+  const auto after = normal(tangent) * radius();
+  if (!segments_++) {
+    first_tangent_ = tangent;
+    outer_.moveTo(current_ + after);
+    inner_.moveTo(current_ - after);
+    return;
+  }
+  const auto& pivot = current_;
+  const auto& previous = previous_tangent_;
+  const auto before = normal(previous) * radius();
+  const auto cross = previous.x * tangent.y - previous.y * tangent.x;
+  const auto cosine = previous.x * tangent.x + previous.y * tangent.y;
+  if (cosine > 0 && std::abs(cross) < Scalar(1e-4)) {
+    if (outer_.points.back() != pivot + after) {
+      outer_.lineTo(pivot + after);
+    }
+    if (inner_.points.back() != pivot - after) {
+      inner_.lineTo(pivot - after);
+    }
+    return;
+  }
+  const Scalar sign = cross > 0 ? -1 : 1;
+  auto& outside = cross > 0 ? inner_ : outer_;
+  auto& inside = cross > 0 ? outer_ : inner_;
+  inside.lineTo(pivot);
+  inside.lineTo(pivot - after * sign);
+  switch (join_) {
+    case StrokeJoin::MITER: {
+      // The miter extends by 1 / cos(theta / 2) times the radius, where
+      // theta is the angle of the turn.
+      const auto half = std::sqrt((1 + cosine) / 2);
+      if (half * miter_limit_ >= 1) {
+        outside.lineTo(pivot + (before + after) * (sign / (1 + cosine)));
+      }
+      outside.lineTo(pivot + after * sign);
+      break;
+    }
+    case StrokeJoin::ROUND:
+      addArc(pivot, before * sign,
+             std::atan2(std::abs(cross), cosine) * (cross > 0 ? 1 : -1),
+             cosine < 0 ? 2 : 1, &outside);
+      break;
+    case StrokeJoin::BEVEL:
+      outside.lineTo(pivot + after * sign);
+      break;
+    default:
+      assert(false);
+      break;
+  }
+}
+
+// Connects the side from the left of the point to its right, looking along
+// the tangent.
+template <class T>
+inline void Stroker<T, 2>::addCap(const Vec2<Scalar>& point,
+                                  const Vec2<Scalar>& tangent,
+                                  Side *side) const {
+  assert(side);
+  const auto offset = normal(tangent) * radius();
+  const auto extension = tangent * radius();
+  switch (cap_) {
+    case StrokeCap::BUTT:
+      side->lineTo(point - offset);
+      break;
+    case StrokeCap::ROUND: {
+      const auto weight = std::sqrt(Scalar(0.5));
+      side->conicTo(point + offset + extension, point + extension, weight);
+      side->conicTo(point - offset + extension, point - offset, weight);
+      break;
+    }
+    case StrokeCap::SQUARE:
+      side->lineTo(point + offset + extension);
+      side->lineTo(point - offset + extension);
+      side->lineTo(point - offset);
+      break;
+    default:
+      assert(false);
+      break;
+  }
+}
+
+// A contour of zero length still gets its caps, facing along the x-axis.
+template <class T>
+inline void Stroker<T, 2>::addDot(Shape2<T> *shape) {
+  if (cap_ == StrokeCap::BUTT) {
+    return;
+  }
+  const Vec2<Scalar> tangent(1, 0);
+  outer_.clear();
+  outer_.moveTo(start_ + normal(tangent) * radius());
+  addCap(start_, tangent, &outer_);
+  addCap(start_, -tangent, &outer_);
+  emit(outer_, shape);
+}
+
+// Sweeps the radius around the center by the angle in equal pieces of at
+// most 90 degrees, each of which is a conic.
+template <class T>
+inline void Stroker<T, 2>::addArc(const Vec2<Scalar>& center,
+                                  Vec2<Scalar> radius,
+                                  Scalar angle,
+                                  int pieces,
+                                  Side *side) {
+  assert(side);
+  const auto step = angle / pieces;
+  const auto weight = std::cos(step / 2);
+  const auto cosine = std::cos(step);
+  const auto sine = std::sin(step);
+  for (auto i = 0; i < pieces; ++i) {
+    const Vec2<Scalar> next(radius.x * cosine - radius.y * sine,
+                            radius.x * sine + radius.y * cosine);
+    side->conicTo(center + (radius + next) / (2 * weight * weight),
+                  center + next, weight);
+    radius = next;
+  }
+}
+
+#pragma mark Vectors
+
+template <class T>
+inline bool Stroker<T, 2>::unit(const Vec2<Scalar>& vector,
+                                Vec2<Scalar> *result) {
+  assert(result);
+  const auto length = std::sqrt(vector.x * vector.x + vector.y * vector.y);
+  if (!(length > 0) || !std::isfinite(length)) {
+    return false;
+  }
+  *result = vector / length;
+  return true;
+}
+
+// Finds the directions in which the curve leaves its first point and enters
+// its last, skipping control points that coincide with them.
+template <class T>
+inline bool Stroker<T, 2>::tangents(const Vec2<Scalar> *points,
+                                    int count,
+                                    Vec2<Scalar> *start,
+                                    Vec2<Scalar> *end) {
+  assert(points && count > 1);
+  assert(start && end);
+  bool found{};
+  for (auto i = 1; i < count && !found; ++i) {
+    found = unit(points[i] - points[0], start);
+  }
+  if (!found) {
+    return false;
+  }
+  found = false;
+  for (auto i = count - 2; i >= 0 && !found; --i) {
+    found = unit(points[count - 1] - points[i], end);
+  }
+  return found;
+}
+
+template <class T>
+inline Vec2<math::Promote<T>> Stroker<T, 2>::normal(
+    const Vec2<Scalar>& tangent) {
+  return Vec2<Scalar>(-tangent.y, tangent.x);
+}
+
+// Returns where the line through p0 along t0 meets the line through p1
+// along t1, or the midpoint of p0 and p1 where they are parallel.
+template <class T>
+inline Vec2<math::Promote<T>> Stroker<T, 2>::intersect(
+    const Vec2<Scalar>& p0,
+    const Vec2<Scalar>& t0,
+    const Vec2<Scalar>& p1,
+    const Vec2<Scalar>& t1) {
+  const auto denominator = t0.x * t1.y - t0.y * t1.x;
+  if (std::abs(denominator) < Scalar(1e-6)) {
+    return (p0 + p1) / 2;
+  }
+  const auto d = p1 - p0;
+  return p0 + t0 * ((d.x * t1.y - d.y * t1.x) / denominator);
+}
+
+#pragma mark Conversion
+
+template <class T>
+inline Vec2<math::Promote<T>> Stroker<T, 2>::promote(const Vec2<T>& point) {
+  return Vec2<Scalar>(point.x, point.y);
+}
+
+template <class T>
+inline Vec2<T> Stroker<T, 2>::demote(const Vec2<Scalar>& point) {
+  return Vec2<T>(point.x, point.y);
+}
+
+#pragma mark Side
+
+template <class T>
+inline void Stroker<T, 2>::Side::clear() {
+  verbs.clear();
+  points.clear();
+  weights.clear();
+}
+
+template <class T>
+inline void Stroker<T, 2>::Side::moveTo(const Vec2<Scalar>& point) {
+  verbs.emplace_back(CommandType::MOVE);
+  points.emplace_back(point);
+}
+
+template <class T>
+inline void Stroker<T, 2>::Side::lineTo(const Vec2<Scalar>& point) {
+  verbs.emplace_back(CommandType::LINE);
+  points.emplace_back(point);
+}
+
+template <class T>
+inline void Stroker<T, 2>::Side::quadraticTo(const Vec2<Scalar>& control,
+                                             const Vec2<Scalar>& point) {
+  verbs.emplace_back(CommandType::QUADRATIC);
+  points.emplace_back(control);
+  points.emplace_back(point);
+}
+
+template <class T>
+inline void Stroker<T, 2>::Side::conicTo(const Vec2<Scalar>& control,
+                                         const Vec2<Scalar>& point,
+                                         Scalar weight) {
+  verbs.emplace_back(CommandType::CONIC);
+  points.emplace_back(control);
+  points.emplace_back(point);
+  weights.emplace_back(weight);
+}
+
+template <class T>
+inline void Stroker<T, 2>::Side::cubicTo(const Vec2<Scalar>& control1,
+                                         const Vec2<Scalar>& control2,
+                                         const Vec2<Scalar>& point) {
+  verbs.emplace_back(CommandType::CUBIC);
+  points.emplace_back(control1);
+  points.emplace_back(control2);
+  points.emplace_back(point);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::Stroker;
+using graphics::Stroker2;
+using graphics::Stroker2i;
+using graphics::Stroker2f;
+using graphics::Stroker2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_STROKER_H_
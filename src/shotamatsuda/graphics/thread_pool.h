@@ -0,0 +1,188 @@
+//
+//  shotamatsuda/graphics/thread_pool.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_THREAD_POOL_H_
+#define SHOTA_GRAPHICS_THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace shotamatsuda {
+namespace graphics {
+
+// Runs batches of independent tasks on a fixed set of threads, which includes
+// the thread that submits the batch. Each thread starts on its own contiguous
+// share of the task indices, so that neighbouring tasks tend to run on the
+// same thread, and steals indices from the other shares once its own runs
+// out. The threads sleep between batches, so a pool can be kept for the
+// lifetime of an application and shared by rasterizers.
+//
+// Batches are run one at a time, and a task must neither throw nor submit
+// another batch to the same pool.
+class ThreadPool final {
+ public:
+  explicit ThreadPool(
+      unsigned int concurrency = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  // Disallow copy semantics
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Attributes
+  unsigned int concurrency() const { return concurrency_; }
+
+  // Running tasks
+  template <class Function>
+  void run(std::size_t count, Function function);
+
+ private:
+  struct Share final {
+    std::atomic<std::size_t> next;
+    std::size_t end;
+
+    // Keeps the counters of different threads on separate cache lines.
+    char padding[64 - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+  };
+
+  void work(unsigned int index);
+  void execute(unsigned int index);
+
+ private:
+  unsigned int concurrency_;
+  std::unique_ptr<Share[]> shares_;
+  std::vector<std::thread> threads_;
+  std::function<void(std::size_t)> task_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable finish_;
+  std::uint64_t generation_;
+  unsigned int busy_;
+  bool stopping_;
+};
+
+#pragma mark -
+
+inline ThreadPool::ThreadPool(unsigned int concurrency)
+    : concurrency_(std::max(concurrency, 1U)),
+      shares_(new Share[concurrency_]),
+      generation_(),
+      busy_(),
+      stopping_() {
+  threads_.reserve(concurrency_ - 1);
+  for (unsigned int i{1}; i < concurrency_; ++i) {
+    threads_.emplace_back(&ThreadPool::work, this, i);
+  }
+}
+
+inline ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  start_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+#pragma mark Running tasks
+
+template <class Function>
+inline void ThreadPool::run(std::size_t count, Function function) {
+  if (concurrency_ < 2 || count < 2) {
+    for (std::size_t index{}; index < count; ++index) {
+      function(index);
+    }
+    return;
+  }
+  task_ = std::ref(function);
+  for (unsigned int i{}; i < concurrency_; ++i) {
+    shares_[i].next.store(count * i / concurrency_, std::memory_order_relaxed);
+    shares_[i].end = count * (i + 1) / concurrency_;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    busy_ = concurrency_ - 1;
+  }
+  start_.notify_all();
+  execute(0);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    finish_.wait(lock, [this]() { return !busy_; });
+  }
+  task_ = nullptr;
+}
+
+inline void ThreadPool::work(unsigned int index) {
+  std::uint64_t generation{};
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [this, generation]() {
+        return stopping_ || generation_ != generation;
+      });
+      if (stopping_) {
+        return;
+      }
+      generation = generation_;
+    }
+    execute(index);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!--busy_) {
+      finish_.notify_one();
+    }
+  }
+}
+
+inline void ThreadPool::execute(unsigned int index) {
+  for (unsigned int i{}; i < concurrency_; ++i) {
+    auto& share = shares_[(index + i) % concurrency_];
+    for (auto task = share.next++; task < share.end; task = share.next++) {
+      task_(task);
+    }
+  }
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::ThreadPool;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_THREAD_POOL_H_
@@ -0,0 +1,517 @@
+//
+//  shotamatsuda/graphics/tiled_rasterizer.h
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+#ifndef SHOTA_GRAPHICS_TILED_RASTERIZER_H_
+#define SHOTA_GRAPHICS_TILED_RASTERIZER_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/coverage.h"
+#include "shotamatsuda/graphics/coverage_spans.h"
+#include "shotamatsuda/graphics/fill_rule.h"
+#include "shotamatsuda/graphics/flattener.h"
+#include "shotamatsuda/graphics/flattening_iterator.h"
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/rasterizer.h"
+#include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/graphics/thread_pool.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+template <class T, int D>
+class TiledRasterizer;
+
+template <class T>
+using TiledRasterizer2 = TiledRasterizer<T, 2>;
+
+// Renders shapes into 8-bit coverage masks like Rasterizer, but splits the
+// mask into square tiles that are rasterized independently, so that large
+// masks can be rendered on a thread pool.
+//
+// Adding geometry bins each flattened line into the tiles it crosses. Paths
+// whose cached bounds miss the mask are skipped without being flattened, as
+// their contours are closed and leave no coverage behind. A tile clips its
+// lines like a mask of its own, which moves the parts to its left onto its
+// left edge. Lines that lie entirely to the left of a tile in the same row of
+// tiles still cover it, so their heights are recorded as a backdrop in the
+// first tile to their right, and summed across each row of tiles before
+// rasterization. Tiles without lines are filled from their backdrop alone.
+//
+// Rasterizing into coverage spans renders one row of tiles at a time into a
+// buffer of that height, and encodes tiles without lines as solid spans
+// without rendering them, so that sparse shapes on huge masks take memory in
+// proportion to their edges rather than the area of the mask.
+template <class T>
+class TiledRasterizer<T, 2> final {
+ public:
+  using Type = T;
+  static constexpr const int dimensions = 2;
+  static constexpr const int default_tile_size = 64;
+
+ public:
+  TiledRasterizer();
+  TiledRasterizer(int width,
+                  int height,
+                  int tile_size = default_tile_size);
+
+  // Copy semantics
+  TiledRasterizer(const TiledRasterizer&) = default;
+  TiledRasterizer& operator=(const TiledRasterizer&) = default;
+
+  // Move semantics
+  TiledRasterizer(TiledRasterizer&&) = default;
+  TiledRasterizer& operator=(TiledRasterizer&&) = default;
+
+  // Mutators
+  void resize(int width, int height, int tile_size = default_tile_size);
+  void reset();
+
+  // Attributes
+  int width() const { return width_; }
+  int height() const { return height_; }
+  int tileSize() const { return tile_size_; }
+  int columns() const { return columns_; }
+  int rows() const { return rows_; }
+
+  // Adding geometry
+  void addLine(const Vec2<T>& p0, const Vec2<T>& p1);
+  void addPath(const Path2<T>& path,
+               const Flattener2<T>& flattener = Flattener2<T>());
+  void addShape(const Shape2<T>& shape,
+                const Flattener2<T>& flattener = Flattener2<T>());
+
+  // Rasterization
+  void rasterize(FillRule rule,
+                 std::uint8_t *mask,
+                 std::ptrdiff_t stride,
+                 ThreadPool *pool = nullptr) const;
+  void rasterize(FillRule rule,
+                 CoverageSpans *spans,
+                 ThreadPool *pool = nullptr) const;
+  std::vector<std::uint8_t> rasterize(FillRule rule,
+                                      ThreadPool *pool = nullptr) const;
+  std::vector<std::uint8_t> rasterize(
+      const Shape2<T>& shape,
+      FillRule rule,
+      ThreadPool *pool = nullptr,
+      const Flattener2<T>& flattener = Flattener2<T>());
+
+ private:
+  struct Line final {
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+  };
+
+  template <class Range>
+  void addCommands(const Range& commands);
+  void binLine(float x0, float y0, float x1, float y1);
+  void binRow(int row, float x0, float y0, float x1, float y1);
+  void accumulateBackdrops(int row, float *backdrops) const;
+  void rasterizeTile(int tile,
+                     FillRule rule,
+                     const float *backdrop,
+                     std::uint8_t *mask,
+                     std::ptrdiff_t stride) const;
+  static std::uint8_t quantize(float area, FillRule rule);
+
+ private:
+  int width_;
+  int height_;
+  int tile_size_;
+  int columns_;
+  int rows_;
+  std::vector<std::vector<Line>> bins_;
+  std::vector<float> backdrops_;
+};
+
+template <class T>
+constexpr const int TiledRasterizer<T, 2>::default_tile_size;
+
+using TiledRasterizer2i = TiledRasterizer2<int>;
+using TiledRasterizer2f = TiledRasterizer2<float>;
+using TiledRasterizer2d = TiledRasterizer2<double>;
+
+#pragma mark -
+
+template <class T>
+inline TiledRasterizer<T, 2>::TiledRasterizer()
+    : width_(),
+      height_(),
+      tile_size_(default_tile_size),
+      columns_(),
+      rows_() {}
+
+template <class T>
+inline TiledRasterizer<T, 2>::TiledRasterizer(int width,
+                                              int height,
+                                              int tile_size)
+    : width_(),
+      height_(),
+      tile_size_(default_tile_size),
+      columns_(),
+      rows_() {
+  resize(width, height, tile_size);
+}
+
+#pragma mark Mutators
+
+template <class T>
+inline void TiledRasterizer<T, 2>::resize(int width,
+                                          int height,
+                                          int tile_size) {
+  assert(width >= 0 && height >= 0 && tile_size > 0);
+  width_ = width;
+  height_ = height;
+  tile_size_ = tile_size;
+  columns_ = (width_ + tile_size_ - 1) / tile_size_;
+  rows_ = (height_ + tile_size_ - 1) / tile_size_;
+  bins_.resize(std::size_t(columns_) * rows_);
+  backdrops_.resize(bins_.size() * tile_size_);
+  reset();
+}
+
+template <class T>
+inline void TiledRasterizer<T, 2>::reset() {
+  for (auto& bin : bins_) {
+    bin.clear();
+  }
+  std::fill(std::begin(backdrops_), std::end(backdrops_), 0);
+}
+
+#pragma mark Adding geometry
+
+template <class T>
+inline void TiledRasterizer<T, 2>::addLine(const Vec2<T>& p0,
+                                           const Vec2<T>& p1) {
+  binLine(static_cast<float>(p0.x), static_cast<float>(p0.y),
+          static_cast<float>(p1.x), static_cast<float>(p1.y));
+}
+
+template <class T>
+inline void TiledRasterizer<T, 2>::addPath(const Path2<T>& path,
+                                           const Flattener2<T>& flattener) {
+  if (path.empty()) {
+    return;
+  }
+  const auto bounds = path.bounds();
+  if (bounds.maxX() <= 0 || bounds.minX() >= width_ ||
+      bounds.maxY() <= 0 || bounds.minY() >= height_) {
+    return;
+  }
+  addCommands(flattened(path, flattener));
+}
+
+template <class T>
+inline void TiledRasterizer<T, 2>::addShape(const Shape2<T>& shape,
+                                            const Flattener2<T>& flattener) {
+  for (const auto& path : shape.paths()) {
+    addPath(path, flattener);
+  }
+}
+
+template <class T>
+template <class Range>
+inline void TiledRasterizer<T, 2>::addCommands(const Range& commands) {
+  Vec2<T> start;
+  Vec2<T> previous;
+  for (const auto& command : commands) {
+    switch (command.type()) {
+      case CommandType::MOVE:
+        addLine(previous, start);
+        start = previous = command.point();
+        break;
+      case CommandType::LINE:
+        addLine(previous, command.point());
+        previous = command.point();
+        break;
+      case CommandType::CLOSE:
+        addLine(previous, start);
+        previous = start;
+        break;
+      default:
+        assert(false);
+        break;
+    }
+  }
+  addLine(previous, start);
+}
+
+// Clips the line to the rows of the mask, and splits it at the boundaries
+// between rows of tiles.
+template <class T>
+inline void TiledRasterizer<T, 2>::binLine(float x0,
+                                           float y0,
+                                           float x1,
+                                           float y1) {
+  if (y0 == y1 || std::min(x0, x1) >= width_ ||
+      !(std::max(y0, y1) > 0 && std::min(y0, y1) < height_)) {
+    return;
+  }
+  const auto dxdy = (x1 - x0) / (y1 - y0);
+  const auto clip = [&](float& x, float& y, float lower, float upper) {
+    const auto clamped = std::min(std::max(y, lower), upper);
+    if (clamped != y) {
+      x += (clamped - y) * dxdy;
+      y = clamped;
+    }
+  };
+  clip(x0, y0, 0, height_);
+  clip(x1, y1, 0, height_);
+  const auto top = std::min(y0, y1);
+  const auto bottom = std::max(y0, y1);
+  const auto first = static_cast<int>(top) / tile_size_;
+  const auto last = std::min(rows_ - 1,
+                             static_cast<int>(bottom) / tile_size_);
+  if (first == last) {
+    binRow(first, x0, y0, x1, y1);
+    return;
+  }
+  for (auto row = first; row <= last; ++row) {
+    auto xa = x0;
+    auto ya = y0;
+    auto xb = x1;
+    auto yb = y1;
+    const float lower = row * tile_size_;
+    const float upper = lower + tile_size_;
+    clip(xa, ya, lower, upper);
+    clip(xb, yb, lower, upper);
+    binRow(row, xa, ya, xb, yb);
+  }
+}
+
+// Adds a line that lies within a row of tiles to the tiles it crosses, and
+// its height to the backdrop of the first tile to its right.
+template <class T>
+inline void TiledRasterizer<T, 2>::binRow(int row,
+                                          float x0,
+                                          float y0,
+                                          float x1,
+                                          float y1) {
+  const auto left = std::min(x0, x1);
+  const auto right = std::max(x0, x1);
+  if (y0 == y1 || left >= width_) {
+    return;
+  }
+  auto column = 0;
+  if (right >= 0) {
+    // Clamp before converting, as x is only clipped in y and may be far
+    // outside the range of int.
+    const auto first = static_cast<int>(std::max(left, 0.f)) / tile_size_;
+    const auto last = std::min(
+        columns_ - 1,
+        static_cast<int>(std::min(right, float(width_))) / tile_size_);
+    for (auto i = first; i <= last; ++i) {
+      bins_[row * columns_ + i].push_back({x0, y0, x1, y1});
+    }
+    column = last + 1;
+  }
+  if (column == columns_) {
+    return;
+  }
+  auto direction = 1.f;
+  if (y0 > y1) {
+    std::swap(y0, y1);
+    direction = -1;
+  }
+  const auto top = row * tile_size_;
+  const auto backdrop = backdrops_.data() +
+      (std::size_t(row) * columns_ + column) * tile_size_ - top;
+  const auto last = std::min(height_, static_cast<int>(std::ceil(y1)));
+  for (auto y = static_cast<int>(y0); y < last; ++y) {
+    backdrop[y] += direction *
+        (std::min(float(y + 1), y1) - std::max(float(y), y0));
+  }
+}
+
+#pragma mark Rasterization
+
+template <class T>
+inline void TiledRasterizer<T, 2>::rasterize(FillRule rule,
+                                             std::uint8_t *mask,
+                                             std::ptrdiff_t stride,
+                                             ThreadPool *pool) const {
+  assert(mask || !width_ || !height_);
+  std::vector<float> backdrops(backdrops_.size());
+  for (auto row = 0; row < rows_; ++row) {
+    accumulateBackdrops(
+        row, backdrops.data() + std::size_t(row) * columns_ * tile_size_);
+  }
+  const auto task = [&](std::size_t index) {
+    const auto tile = static_cast<int>(index);
+    const auto left = tile % columns_ * tile_size_;
+    const auto top = tile / columns_ * tile_size_;
+    rasterizeTile(tile, rule, backdrops.data() + index * tile_size_,
+                  mask + top * stride + left, stride);
+  };
+  if (pool) {
+    pool->run(bins_.size(), task);
+  } else {
+    for (std::size_t tile{}; tile < bins_.size(); ++tile) {
+      task(tile);
+    }
+  }
+}
+
+// Each row of the mask becomes a row of spans, and the tiles of each row of
+// tiles are rendered in parallel before their rows are encoded.
+template <class T>
+inline void TiledRasterizer<T, 2>::rasterize(FillRule rule,
+                                             CoverageSpans *spans,
+                                             ThreadPool *pool) const {
+  assert(spans);
+  spans->clear();
+  std::vector<float> backdrops(std::size_t(columns_) * tile_size_);
+  std::vector<std::uint8_t> buffer(std::size_t(width_) * tile_size_);
+  for (auto row = 0; row < rows_; ++row) {
+    accumulateBackdrops(row, backdrops.data());
+    const auto first = row * columns_;
+    const auto task = [&](std::size_t column) {
+      if (!bins_[first + column].empty()) {
+        rasterizeTile(first + static_cast<int>(column), rule,
+                      backdrops.data() + column * tile_size_,
+                      buffer.data() + column * tile_size_, width_);
+      }
+    };
+    if (pool) {
+      pool->run(columns_, task);
+    } else {
+      for (std::size_t column{}; column < std::size_t(columns_); ++column) {
+        task(column);
+      }
+    }
+    const auto height = std::min(tile_size_, height_ - row * tile_size_);
+    for (auto y = 0; y < height; ++y) {
+      spans->addRow();
+      for (auto column = 0; column < columns_; ++column) {
+        const auto left = column * tile_size_;
+        const auto width = std::min(tile_size_, width_ - left);
+        if (bins_[first + column].empty()) {
+          spans->addSolid(left, width,
+                          quantize(backdrops[column * tile_size_ + y], rule));
+        } else {
+          spans->addCovers(left, buffer.data() + y * width_ + left, width);
+        }
+      }
+    }
+  }
+}
+
+template <class T>
+inline std::vector<std::uint8_t> TiledRasterizer<T, 2>::rasterize(
+    FillRule rule,
+    ThreadPool *pool) const {
+  std::vector<std::uint8_t> result(std::size_t(width_) * height_);
+  rasterize(rule, result.data(), width_, pool);
+  return result;
+}
+
+template <class T>
+inline std::vector<std::uint8_t> TiledRasterizer<T, 2>::rasterize(
+    const Shape2<T>& shape,
+    FillRule rule,
+    ThreadPool *pool,
+    const Flattener2<T>& flattener) {
+  reset();
+  addShape(shape, flattener);
+  return rasterize(rule, pool);
+}
+
+// Sums the backdrops of a row of tiles from the left, so that each tile gets
+// the heights of all lines to its left.
+template <class T>
+inline void TiledRasterizer<T, 2>::accumulateBackdrops(
+    int row,
+    float *backdrops) const {
+  const auto size = std::size_t(columns_) * tile_size_;
+  const auto source = backdrops_.data() + row * size;
+  std::copy(source, source + size, backdrops);
+  for (auto i = std::size_t(tile_size_); i < size; ++i) {
+    backdrops[i] += backdrops[i - tile_size_];
+  }
+}
+
+// Renders a tile into the mask, which points to its top left pixel.
+template <class T>
+inline void TiledRasterizer<T, 2>::rasterizeTile(int tile,
+                                                 FillRule rule,
+                                                 const float *backdrop,
+                                                 std::uint8_t *mask,
+                                                 std::ptrdiff_t stride) const {
+  const auto left = tile % columns_ * tile_size_;
+  const auto top = tile / columns_ * tile_size_;
+  const auto width = std::min(tile_size_, width_ - left);
+  const auto height = std::min(tile_size_, height_ - top);
+  const auto& lines = bins_[tile];
+  if (lines.empty()) {
+    for (auto y = 0; y < height; ++y) {
+      const auto value = quantize(backdrop[y], rule);
+      std::fill(mask + y * stride, mask + y * stride + width, value);
+    }
+    return;
+  }
+  Rasterizer2f rasterizer(width, height);
+  for (const auto& line : lines) {
+    rasterizer.addLine(Vec2<float>(line.x0 - left, line.y0 - top),
+                       Vec2<float>(line.x1 - left, line.y1 - top));
+  }
+  for (auto y = 0; y < height; ++y) {
+    if (backdrop[y]) {
+      rasterizer.addBackdrop(y, backdrop[y]);
+    }
+  }
+  rasterizer.rasterize(rule, mask, stride);
+}
+
+template <class T>
+inline std::uint8_t TiledRasterizer<T, 2>::quantize(float area,
+                                                    FillRule rule) {
+  return static_cast<std::uint8_t>(coverage(area, rule) * 255 + 0.5f);
+}
+
+}  // namespace graphics
+
+namespace gfx = graphics;
+
+using graphics::TiledRasterizer;
+using graphics::TiledRasterizer2;
+using graphics::TiledRasterizer2i;
+using graphics::TiledRasterizer2f;
+using graphics::TiledRasterizer2d;
+
+}  // namespace shotamatsuda
+
+#endif  // SHOTA_GRAPHICS_TILED_RASTERIZER_H_
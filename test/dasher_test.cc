@@ -0,0 +1,219 @@
+//
+//  dasher_test.cc
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/conic.h"
+#include "shotamatsuda/graphics/curve_measure.h"
+#include "shotamatsuda/graphics/dasher.h"
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+namespace {
+
+Shape2d dash(const Path2d& path,
+             const std::vector<double>& intervals,
+             double phase = 0) {
+  Shape2d result;
+  Dasher2d(intervals, phase).dash(path, &result);
+  return result;
+}
+
+Path2d makeLine(double length) {
+  Path2d path;
+  path.moveTo(0, 0);
+  path.lineTo(length, 0);
+  return path;
+}
+
+// A right triangle of perimeter 12, whose sides of 4, 5 and 3 start at the
+// given point on the x-axis.
+Path2d makeTriangle(bool closed, double x = 0) {
+  Path2d path;
+  path.moveTo(x, 0);
+  path.lineTo(x + 4, 0);
+  path.lineTo(x, 3);
+  if (closed) {
+    path.close();
+  }
+  return path;
+}
+
+std::vector<CommandType> verbs(const Path2d& path) {
+  return std::vector<CommandType>(path.verbs().begin(), path.verbs().end());
+}
+
+// Expects the dashes along the x-axis to span the given ranges of x.
+void expectDashes(const Shape2d& shape,
+                  const std::vector<std::pair<double, double>>& ranges) {
+  ASSERT_EQ(shape.size(), ranges.size());
+  auto range = ranges.begin();
+  for (const auto& path : shape.paths()) {
+    EXPECT_EQ(path.points().front(), Vec2d(range->first, 0));
+    EXPECT_EQ(path.points().back(), Vec2d(range->second, 0));
+    ++range;
+  }
+}
+
+}  // namespace
+
+TEST(DasherTest, Phase) {
+  const auto line = makeLine(10);
+  expectDashes(dash(line, {2, 1}), {{0, 2}, {3, 5}, {6, 8}, {9, 10}});
+  expectDashes(dash(line, {2, 1}, 1), {{0, 1}, {2, 4}, {5, 7}, {8, 10}});
+  // The phase wraps around the period in both directions.
+  expectDashes(dash(line, {2, 1}, 4), {{0, 1}, {2, 4}, {5, 7}, {8, 10}});
+  expectDashes(dash(line, {2, 1}, -1), {{1, 3}, {4, 6}, {7, 9}});
+}
+
+TEST(DasherTest, OddPattern) {
+  // A pattern of odd length is repeated, so that its intervals alternate
+  // between on and off.
+  EXPECT_EQ(Dasher2d({3}).intervals(), std::vector<double>({3, 3}));
+  EXPECT_EQ(Dasher2d({1, 2, 3}).intervals(),
+            std::vector<double>({1, 2, 3, 1, 2, 3}));
+  expectDashes(dash(makeLine(10), {3}), {{0, 3}, {6, 9}});
+  expectDashes(dash(makeLine(12), {1, 2, 3}), {{0, 1}, {3, 6}, {7, 9}});
+}
+
+TEST(DasherTest, ZeroLengthIntervals) {
+  // Dashes of zero length are kept, so that they can be capped, except at
+  // the start where the phase skips past them.
+  const auto dots = dash(makeLine(6), {0, 2});
+  expectDashes(dots, {{2, 2}, {4, 4}, {6, 6}});
+  for (const auto& path : dots.paths()) {
+    EXPECT_GT(path.verbs().size(), 1U);
+  }
+  // A pattern without any length leaves the path as it is.
+  const auto line = makeLine(6);
+  const auto unchanged = dash(line, {0, 0});
+  ASSERT_EQ(unchanged.size(), 1U);
+  EXPECT_EQ(unchanged.front(), line);
+}
+
+TEST(DasherTest, ClosedContourJoinsEnds) {
+  // The triangle is on for [0, 2), [4, 7) and [9, 12], and the last dash
+  // meets the first at the start point, where it continues into it.
+  const auto closed = dash(makeTriangle(true), {3, 2}, 1);
+  ASSERT_EQ(closed.size(), 2U);
+  const auto& joined = closed.front();
+  EXPECT_EQ(verbs(joined), std::vector<CommandType>({
+      CommandType::MOVE, CommandType::LINE, CommandType::LINE}));
+  ASSERT_EQ(joined.points().size(), 3U);
+  EXPECT_EQ(joined.points()[0], Vec2d(0, 3));
+  EXPECT_EQ(joined.points()[1], Vec2d(0, 0));
+  EXPECT_EQ(joined.points()[2], Vec2d(2, 0));
+  EXPECT_FALSE(joined.closed());
+  EXPECT_EQ(closed.back().points().front(), Vec2d(4, 0));
+  EXPECT_TRUE(closed.back().points().back().equals(Vec2d(1.6, 1.8), 1e-9));
+
+  // An open contour has ends that are not joined, and neither has a closed
+  // one that is off at its start.
+  const auto open = dash(makeTriangle(false), {3, 2}, 2);
+  ASSERT_EQ(open.size(), 3U);
+  EXPECT_EQ(open.front().points().front(), Vec2d(0, 0));
+  EXPECT_EQ(open.back().points().back(), Vec2d(0, 3));
+  const auto off = dash(makeTriangle(true), {3, 2}, 4);
+  ASSERT_EQ(off.size(), 3U);
+  EXPECT_EQ(off.front().points().front(), Vec2d(1, 0));
+
+  // A dash around the whole contour closes it.
+  const auto whole = dash(makeTriangle(true), {20, 1});
+  ASSERT_EQ(whole.size(), 1U);
+  EXPECT_TRUE(whole.front().closed());
+  EXPECT_EQ(whole.front().points().front(), Vec2d(0, 0));
+
+  // Each contour of a shape is joined in place.
+  Shape2d shape;
+  shape.addPath(makeTriangle(true));
+  shape.addPath(makeTriangle(true, 10));
+  Shape2d result;
+  Dasher2d({3, 2}, 1).dash(shape, &result);
+  ASSERT_EQ(result.size(), 4U);
+  auto path = result.paths().begin();
+  EXPECT_EQ(path->points().front(), Vec2d(0, 3));
+  EXPECT_EQ((++path)->points().front(), Vec2d(4, 0));
+  EXPECT_EQ((++path)->points().front(), Vec2d(10, 3));
+  EXPECT_EQ((++path)->points().front(), Vec2d(14, 0));
+}
+
+TEST(DasherTest, DashAcrossConicAndCubic) {
+  // A quarter of a circle of radius 10 about (0, 10), followed by a cubic,
+  // with a dash of 4 centered on the point where they meet.
+  const Conic2d conic(Vec2d(0, 0), Vec2d(10, 0), Vec2d(10, 10),
+                      std::sqrt(0.5));
+  const Vec2d cubic[] = {
+      Vec2d(10, 10), Vec2d(10, 15), Vec2d(15, 20), Vec2d(20, 20)};
+  Path2d path;
+  path.moveTo(conic.a);
+  path.conicTo(conic.b, conic.c, conic.weight);
+  path.cubicTo(cubic[1], cubic[2], cubic[3]);
+  CurveMeasure2d conic_measure;
+  conic_measure.setConic(conic);
+  CurveMeasure2d cubic_measure;
+  cubic_measure.setCubic(cubic[0], cubic[1], cubic[2], cubic[3]);
+  const auto joint = conic_measure.length();
+  const auto shape = dash(path, {4, 100}, 2 - joint);
+  ASSERT_EQ(shape.size(), 1U);
+  const auto& result = shape.front();
+  ASSERT_EQ(verbs(result), std::vector<CommandType>({
+      CommandType::MOVE, CommandType::CONIC, CommandType::CUBIC}));
+  const auto& points = result.points();
+  EXPECT_TRUE(points[0].equals(
+      conic_measure.point(conic_measure.parameter(joint - 2)), 1e-9));
+  EXPECT_TRUE(points[2].equals(Vec2d(10, 10), 1e-9));
+  EXPECT_TRUE(points[5].equals(
+      cubic_measure.point(cubic_measure.parameter(2)), 1e-9));
+
+  // The part of the conic is still an arc of the circle, of 2 over a radius
+  // of 10, whose weight is the cosine of half its angle.
+  const auto weight = result.weights().front();
+  EXPECT_NEAR(weight, std::cos(0.1), 1e-3);
+  const auto middle = CurveMeasure2d::point(CommandType::CONIC,
+                                            points.data(), weight, 0.5);
+  EXPECT_NEAR((middle - Vec2d(0, 10)).length(), 10, 1e-9);
+
+  // The dash is 4 long, within the accuracy of mapping distances to
+  // parameters at the default tolerance.
+  CurveMeasure2d measure(0.001);
+  measure.setConic(Conic2d(points[0], points[1], points[2], weight));
+  auto length = measure.length();
+  measure.setCubic(points[2], points[3], points[4], points[5]);
+  length += measure.length();
+  EXPECT_NEAR(length, 4, 0.1);
+}
+
+}  // namespace graphics
+}  // namespace shotamatsuda
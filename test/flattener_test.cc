@@ -0,0 +1,170 @@
+//
+//  flattener_test.cc
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#include "shotamatsuda/graphics/command_type.h"
+#include "shotamatsuda/graphics/curve_measure.h"
+#include "shotamatsuda/graphics/flattener.h"
+#include "shotamatsuda/graphics/flattening_iterator.h"
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/polylines.h"
+#include "shotamatsuda/graphics/shape.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+namespace {
+
+double distanceToSegment(const Vec2d& point, const Vec2d& a, const Vec2d& b) {
+  const auto ab = b - a;
+  const auto length = ab.lengthSquared();
+  auto t = length ? (point - a).dot(ab) / length : 0;
+  t = std::min(std::max(t, 0.0), 1.0);
+  return (point - (a + ab * t)).length();
+}
+
+// Largest distance from points sampled along the curve to the polyline.
+double deviation(CommandType type,
+                 const Vec2d *points,
+                 double weight,
+                 const Polylines2d& polylines) {
+  const auto contour = polylines.contour(0);
+  const auto size = polylines.contourSize(0);
+  double result{};
+  for (int i{}; i <= 1000; ++i) {
+    const auto point = CurveMeasure2d::point(type, points, weight, i / 1000.0);
+    auto distance = std::numeric_limits<double>::infinity();
+    for (std::size_t j{1}; j < size; ++j) {
+      distance = std::min(distance, distanceToSegment(
+          point, contour[j - 1], contour[j]));
+    }
+    result = std::max(result, distance);
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(FlattenerTest, DeviationWithinTolerance) {
+  struct Curve {
+    CommandType type;
+    Vec2d points[4];
+    double weight;
+  };
+  const Curve curves[] = {
+    {CommandType::QUADRATIC, {{0, 0}, {50, 100}, {100, 0}}, 0},
+    {CommandType::QUADRATIC, {{0, 0}, {200, 10}, {10, 5}}, 0},
+    {CommandType::CUBIC, {{0, 0}, {0, 100}, {100, -100}, {100, 0}}, 0},
+    {CommandType::CUBIC, {{0, 0}, {150, 80}, {-50, 80}, {100, 0}}, 0},
+    {CommandType::CONIC, {{100, 0}, {100, 100}, {0, 100}}, 0.5},
+    {CommandType::CONIC, {{100, 0}, {100, 100}, {0, 100}}, std::sqrt(0.5)},
+    {CommandType::CONIC, {{100, 0}, {100, 100}, {0, 100}}, 2},
+  };
+  for (const auto tolerance : {1.0, 0.25, 0.01}) {
+    const Flattener2d flattener(tolerance);
+    for (const auto& curve : curves) {
+      Path2d path;
+      path.moveTo(curve.points[0]);
+      switch (curve.type) {
+        case CommandType::QUADRATIC:
+          path.quadraticTo(curve.points[1], curve.points[2]);
+          break;
+        case CommandType::CONIC:
+          path.conicTo(curve.points[1], curve.points[2], curve.weight);
+          break;
+        case CommandType::CUBIC:
+          path.cubicTo(curve.points[1], curve.points[2], curve.points[3]);
+          break;
+        default:
+          break;
+      }
+      Polylines2d polylines;
+      flattener.flatten(path, &polylines);
+      ASSERT_EQ(polylines.size(), 1U);
+      const auto size = polylines.contourSize(0);
+      EXPECT_GT(size, 2U);
+      EXPECT_EQ(polylines.contour(0)[0], curve.points[0]);
+      EXPECT_EQ(polylines.contour(0)[size - 1],
+                curve.points[pointCount(curve.type)]);
+      EXPECT_LE(deviation(curve.type, curve.points, curve.weight, polylines),
+                tolerance * (1 + 1e-9))
+          << "tolerance " << tolerance << ", type " << curve.type;
+    }
+  }
+}
+
+TEST(FlattenerTest, IteratorMatchesFlatten) {
+  Shape2f shape;
+  shape.moveTo(0, 0);
+  shape.quadraticTo(40, 80, 80, 0);
+  shape.conicTo(120, 0, 120, 40, 0.7071f);
+  shape.conicTo(120, 90, 60, 90, 3.5f);
+  shape.cubicTo(30, 120, -20, 20, 10, 60);
+  shape.close();
+  shape.lineTo(-30, -10);
+  shape.conicTo(-60, 40, -10, 70, 0.2f);
+  shape.moveTo(200, 200);
+  shape.cubicTo(260, 140, 140, 140, 200, 260);
+  shape.lineTo(230, 210);
+  shape.close();
+  for (const auto tolerance : {2.f, 0.25f, 0.01f}) {
+    const Flattener2f flattener(tolerance);
+    Polylines2f expected;
+    flattener.flatten(shape, &expected);
+    Polylines2f actual;
+    for (const auto& command : flattened(shape, flattener)) {
+      switch (command.type()) {
+        case CommandType::MOVE:
+          actual.moveTo(command.point());
+          break;
+        case CommandType::LINE:
+          actual.lineTo(command.point());
+          break;
+        case CommandType::CLOSE:
+          actual.close();
+          break;
+        default:
+          ADD_FAILURE() << "unexpected " << command.type();
+          break;
+      }
+    }
+    ASSERT_EQ(actual.size(), expected.size());
+    EXPECT_EQ(actual.offsets(), expected.offsets());
+    EXPECT_EQ(actual.points(), expected.points());
+    for (std::size_t i{}; i < expected.size(); ++i) {
+      EXPECT_EQ(actual.closed(i), expected.closed(i));
+    }
+  }
+}
+
+}  // namespace graphics
+}  // namespace shotamatsuda
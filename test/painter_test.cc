@@ -0,0 +1,211 @@
+//
+//  painter_test.cc
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "shotamatsuda/graphics/color4.h"
+#include "shotamatsuda/graphics/fill_rule.h"
+#include "shotamatsuda/graphics/linear_gradient.h"
+#include "shotamatsuda/graphics/painter.h"
+#include "shotamatsuda/graphics/rasterizer.h"
+#include "shotamatsuda/graphics/shape.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+namespace {
+
+void addBox(float x0, float y0, float x1, float y1, Shape2f *shape) {
+  shape->moveTo(x0, y0);
+  shape->lineTo(x1, y0);
+  shape->lineTo(x1, y1);
+  shape->lineTo(x0, y1);
+  shape->close();
+}
+
+// Expects each pixel to be the premultiplied source composited over the
+// original pixel with the coverage the rasterizer gives the shape, within one
+// level of rounding.
+void expectComposited(const std::vector<Color4u>& original,
+                      const std::vector<Color4u>& painted,
+                      const Shape2f& shape,
+                      const Color4u& source,
+                      int width,
+                      int height,
+                      int stride) {
+  Rasterizer2f rasterizer(width, height);
+  const auto coverage = rasterizer.rasterize(shape, FillRule::NON_ZERO);
+  for (auto y = 0; y < height; ++y) {
+    for (auto x = 0; x < width; ++x) {
+      const auto& before = original[y * stride + x];
+      const auto& after = painted[y * stride + x];
+      const auto alpha = coverage[y * width + x] / 255.0;
+      const auto inverse = 1 - source.a / 255.0 * alpha;
+      for (auto channel = 0; channel < 4; ++channel) {
+        const auto expected =
+            source[channel] * alpha + before[channel] * inverse;
+        EXPECT_LE(std::abs(after[channel] - expected), 1)
+            << "at (" << x << ", " << y << ") in channel " << channel;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(PainterTest, OpaqueFill) {
+  std::vector<Color4u> pixels(8 * 8, Color4u(0, 0, 255, 255));
+  Painter2f painter(pixels.data(), 8, 8, 8);
+  Shape2f shape;
+  addBox(2, 2, 6, 6, &shape);
+  painter.fill(shape, Color4f(1, 0, 0, 1));
+  for (auto y = 0; y < 8; ++y) {
+    for (auto x = 0; x < 8; ++x) {
+      const auto inside = x >= 2 && x < 6 && y >= 2 && y < 6;
+      EXPECT_EQ(pixels[y * 8 + x],
+                inside ? Color4u(255, 0, 0, 255) : Color4u(0, 0, 255, 255));
+    }
+  }
+}
+
+TEST(PainterTest, PartialCoverage) {
+  Shape2f shape;
+  addBox(0.5, 1.25, 6.75, 5.5, &shape);
+  shape.moveTo(3.2, 0.3);
+  shape.lineTo(7.7, 7.1);
+  shape.lineTo(0.4, 6.6);
+  shape.close();
+  for (const auto& background : {Color4u(255, 255, 255, 255),
+                                 Color4u(0, 64, 32, 128),
+                                 Color4u(0, 0, 0, 0)}) {
+    std::vector<Color4u> pixels(8 * 8, background);
+    const auto original = pixels;
+    Painter2f painter(pixels.data(), 8, 8, 8);
+    painter.fill(shape, Color4f(1, 0.5, 0, 0.5));
+    expectComposited(original, pixels, shape, Color4u(128, 64, 0, 128),
+                     8, 8, 8);
+  }
+}
+
+TEST(PainterTest, PremultipliedOutput) {
+  // Over a transparent buffer, the pixels are the premultiplied source scaled
+  // by coverage, so no channel exceeds alpha.
+  std::vector<Color4u> pixels(8 * 8);
+  Painter2f painter(pixels.data(), 8, 8, 8);
+  Shape2f shape;
+  addBox(0, 0, 8, 8, &shape);
+  painter.fill(shape, Color4f(1, 1, 0.5, 0.25));
+  for (const auto& pixel : pixels) {
+    EXPECT_EQ(pixel, Color4u(64, 64, 32, 64));
+  }
+  shape.reset();
+  addBox(1.5, 1.25, 6.75, 6.5, &shape);
+  painter.fill(shape, Color4f(0, 1, 1, 0.5));
+  for (const auto& pixel : pixels) {
+    EXPECT_LE(pixel.r, pixel.a);
+    EXPECT_LE(pixel.g, pixel.a);
+    EXPECT_LE(pixel.b, pixel.a);
+  }
+}
+
+TEST(PainterTest, GradientRamp) {
+  std::vector<Color4u> pixels(256);
+  Painter2f painter(pixels.data(), 256, 1, 256);
+  Shape2f shape;
+  addBox(0, 0, 256, 1, &shape);
+  LinearGradient2f gradient(Vec2f(0, 0), Vec2f(256, 0));
+  gradient.addStop(0, Color4f(0, 0, 0, 1));
+  gradient.addStop(1, Color4f(1, 1, 1, 1));
+  painter.fill(shape, gradient);
+  for (auto x = 0; x < 256; ++x) {
+    // Evaluated at the center of the pixel, and looked up in the ramp.
+    const auto expected = std::round((x + 0.5) / 256 * 255);
+    EXPECT_LE(std::abs(pixels[x].r - expected), 1) << "at " << x;
+    EXPECT_EQ(pixels[x].r, pixels[x].g);
+    EXPECT_EQ(pixels[x].r, pixels[x].b);
+    EXPECT_EQ(pixels[x].a, 255);
+  }
+
+  // Offsets beyond the end points take the colors of the first and last
+  // stops, and the ramp is premultiplied.
+  gradient.set(Vec2f(64, 0), Vec2f(192, 0));
+  gradient.clearStops();
+  gradient.addStop(0, Color4f(1, 0, 0, 1));
+  gradient.addStop(1, Color4f(1, 0, 0, 0));
+  std::fill(pixels.begin(), pixels.end(), Color4u());
+  painter.fill(shape, gradient);
+  for (auto x = 0; x < 256; ++x) {
+    if (x < 64) {
+      EXPECT_EQ(pixels[x], Color4u(255, 0, 0, 255)) << "at " << x;
+    } else if (x >= 192) {
+      EXPECT_EQ(pixels[x], Color4u(0, 0, 0, 0)) << "at " << x;
+    } else {
+      EXPECT_EQ(pixels[x].r, pixels[x].a) << "at " << x;
+      EXPECT_LE(pixels[x].a, pixels[x - 1].a) << "at " << x;
+    }
+  }
+}
+
+TEST(PainterTest, ClipsToBuffer) {
+  // Shapes reaching outside the buffer are clipped to it, leaving the padding
+  // of each row untouched.
+  const Color4u background(10, 20, 30, 255);
+  std::vector<Color4u> pixels(20 * 16, background);
+  const auto original = pixels;
+  Painter2f painter(pixels.data(), 16, 16, 20);
+  Shape2f shape;
+  addBox(-10.5, -10.25, 5.5, 6.75, &shape);
+  addBox(12.25, 9.5, 40, 40, &shape);
+  shape.moveTo(-20, 14.5);
+  shape.lineTo(8.5, 10);
+  shape.lineTo(10, 30);
+  shape.close();
+  painter.fill(shape, Color4f(0, 1, 0, 1));
+  expectComposited(original, pixels, shape, Color4u(0, 255, 0, 255),
+                   16, 16, 20);
+  for (auto y = 0; y < 16; ++y) {
+    for (auto x = 16; x < 20; ++x) {
+      EXPECT_EQ(pixels[y * 20 + x], background);
+    }
+  }
+
+  // Shapes missing the buffer leave it untouched.
+  const auto painted = pixels;
+  shape.reset();
+  addBox(-30, 2, -10, 12, &shape);
+  addBox(3, 16, 12, 30, &shape);
+  painter.fill(shape, Color4f(1, 0, 0, 1));
+  EXPECT_EQ(pixels, painted);
+}
+
+}  // namespace graphics
+}  // namespace shotamatsuda
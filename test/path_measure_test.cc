@@ -0,0 +1,200 @@
+//
+//  path_measure_test.cc
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/path_measure.h"
+#include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+namespace {
+
+const auto pi = std::acos(-1.0);
+
+// A rectangle of 4 by 3 at the origin, of perimeter 14.
+Path2d makeRectangle() {
+  Path2d path;
+  path.moveTo(0, 0);
+  path.lineTo(4, 0);
+  path.lineTo(4, 3);
+  path.lineTo(0, 3);
+  path.close();
+  return path;
+}
+
+// A circle of radius 10 about the origin, made of four conics.
+Path2d makeCircle() {
+  const auto weight = std::sqrt(0.5);
+  Path2d path;
+  path.moveTo(10, 0);
+  path.conicTo(10, 10, 0, 10, weight);
+  path.conicTo(-10, 10, -10, 0, weight);
+  path.conicTo(-10, -10, 0, -10, weight);
+  path.conicTo(10, -10, 10, 0, weight);
+  return path;
+}
+
+void expectSample(const PathMeasure2d& measure,
+                  double distance,
+                  const Vec2d& position,
+                  const Vec2d& tangent) {
+  const auto sample = measure.sample(distance);
+  EXPECT_TRUE(sample.first.equals(position, 1e-9))
+      << sample.first << " at " << distance;
+  EXPECT_TRUE(sample.second.equals(tangent, 1e-9))
+      << sample.second << " at " << distance;
+  EXPECT_EQ(measure.position(distance), sample.first);
+  EXPECT_EQ(measure.tangent(distance), sample.second);
+}
+
+void expectBatchMatches(const PathMeasure2d& measure,
+                        const std::vector<double>& distances) {
+  std::vector<PathMeasure2d::Sample> samples;
+  measure.sample(distances.begin(), distances.end(),
+                 std::back_inserter(samples));
+  ASSERT_EQ(samples.size(), distances.size());
+  for (std::size_t i{}; i < distances.size(); ++i) {
+    const auto expected = measure.sample(distances[i]);
+    EXPECT_EQ(samples[i].first, expected.first) << "at " << distances[i];
+    EXPECT_EQ(samples[i].second, expected.second) << "at " << distances[i];
+  }
+}
+
+}  // namespace
+
+TEST(PathMeasureTest, Length) {
+  EXPECT_DOUBLE_EQ(PathMeasure2d(makeRectangle()).length(), 14);
+
+  // Chords that deviate from an arc of radius r by at most h fall short of
+  // its length by about h / 3r of it.
+  const auto circle = makeCircle();
+  for (const auto tolerance : {0.25, 0.05, 0.01}) {
+    const auto length = PathMeasure2d(circle, tolerance).length();
+    EXPECT_LE(length, 20 * pi);
+    EXPECT_GE(length, 20 * pi * (1 - tolerance / 30)) << tolerance;
+  }
+
+  // A cubic whose control points are evenly spaced along a line moves at a
+  // constant speed.
+  Path2d cubic;
+  cubic.moveTo(1, 1);
+  cubic.cubicTo(4, 5, 7, 9, 10, 13);
+  EXPECT_DOUBLE_EQ(PathMeasure2d(cubic).length(), 15);
+
+  // Contours of a shape add up, and the moves between them add nothing.
+  Shape2d shape;
+  shape.addPath(makeRectangle());
+  shape.moveTo(100, 0);
+  shape.lineTo(100, 5);
+  const PathMeasure2d measure(shape);
+  EXPECT_DOUBLE_EQ(measure.length(), 19);
+  EXPECT_EQ(measure.size(), 5U);
+}
+
+TEST(PathMeasureTest, SegmentEnds) {
+  // A distance at the end of a segment belongs to the next one, and the end
+  // of the path to the last one.
+  const PathMeasure2d rectangle(makeRectangle());
+  expectSample(rectangle, 0, Vec2d(0, 0), Vec2d(1, 0));
+  expectSample(rectangle, 4, Vec2d(4, 0), Vec2d(0, 1));
+  expectSample(rectangle, 7, Vec2d(4, 3), Vec2d(-1, 0));
+  expectSample(rectangle, 11, Vec2d(0, 3), Vec2d(0, -1));
+  expectSample(rectangle, 14, Vec2d(0, 0), Vec2d(0, -1));
+  expectSample(rectangle, 5.5, Vec2d(4, 1.5), Vec2d(0, 1));
+
+  // The ends of curves are evaluated exactly, and the joint of a conic and a
+  // line lies at the length of the conic.
+  Path2d path;
+  path.moveTo(10, 0);
+  path.conicTo(10, 10, 0, 10, std::sqrt(0.5));
+  const auto joint = PathMeasure2d(path).length();
+  path.lineTo(-10, 10);
+  path.cubicTo(-20, 10, -20, 20, -30, 30);
+  const PathMeasure2d curves(path);
+  expectSample(curves, 0, Vec2d(10, 0), Vec2d(0, 1));
+  expectSample(curves, joint, Vec2d(0, 10), Vec2d(-1, 0));
+  expectSample(curves, joint + 10, Vec2d(-10, 10), Vec2d(-1, 0));
+  expectSample(curves, curves.length(), Vec2d(-30, 30),
+               Vec2d(-1, 1) / std::sqrt(2.0));
+}
+
+TEST(PathMeasureTest, Clamping) {
+  const PathMeasure2d measure(makeRectangle());
+  expectSample(measure, -1, Vec2d(0, 0), Vec2d(1, 0));
+  expectSample(measure, -1e9, Vec2d(0, 0), Vec2d(1, 0));
+  expectSample(measure, 15, Vec2d(0, 0), Vec2d(0, -1));
+  expectSample(measure, 1e9, Vec2d(0, 0), Vec2d(0, -1));
+
+  // A path without segments has no length, and samples to zero.
+  Path2d point;
+  point.moveTo(5, 5);
+  const PathMeasure2d empty(point);
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(empty.length(), 0);
+  expectSample(empty, 1, Vec2d(), Vec2d());
+}
+
+TEST(PathMeasureTest, BatchMatchesSingle) {
+  Shape2d shape;
+  shape.addPath(makeCircle());
+  shape.moveTo(20, 0);
+  shape.lineTo(30, 0);
+  shape.lineTo(30, 0);
+  shape.quadraticTo(40, 0, 40, 10);
+  shape.cubicTo(40, 20, 30, 30, 20, 20);
+  shape.close();
+  const PathMeasure2d measure(shape);
+  std::vector<double> distances;
+  for (auto i = -10; i <= 1010; ++i) {
+    distances.emplace_back(measure.length() * i / 1000);
+  }
+  expectBatchMatches(measure, distances);
+
+  // Distances at the ends of segments, repeated or not, belong to the same
+  // segments as they do singly.
+  expectBatchMatches(PathMeasure2d(makeRectangle()),
+                     {-1, 0, 2, 4, 4, 7, 11, 11, 14, 14, 20});
+
+  // An empty measure samples to zero in a batch too.
+  const PathMeasure2d empty;
+  std::vector<PathMeasure2d::Sample> samples;
+  empty.sample(distances.begin(), distances.begin() + 3,
+               std::back_inserter(samples));
+  ASSERT_EQ(samples.size(), 3U);
+  EXPECT_EQ(samples.front(), PathMeasure2d::Sample());
+}
+
+}  // namespace graphics
+}  // namespace shotamatsuda
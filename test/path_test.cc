@@ -26,10 +26,166 @@
 
 #include "gtest/gtest.h"
 
+#include <cmath>
+
+#include "shotamatsuda/graphics/arena_resource.h"
+#include "shotamatsuda/graphics/fill_rule.h"
 #include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/segment_index.h"
 
 namespace shotamatsuda {
 namespace graphics {
 
+namespace {
+
+Path2d makeTriangle() {
+  Path2d path;
+  path.moveTo(0, 0);
+  path.lineTo(10, 0);
+  path.lineTo(0, 10);
+  path.close();
+  return path;
+}
+
+}  // namespace
+
+TEST(PathTest, CopySharesStorage) {
+  const auto path = makeTriangle();
+  EXPECT_FALSE(path.shared());
+  const auto copy = path;
+  EXPECT_TRUE(path.shared());
+  EXPECT_TRUE(copy.shared());
+  EXPECT_EQ(path.points().data(), copy.points().data());
+  EXPECT_EQ(path, copy);
+}
+
+TEST(PathTest, MutationDetaches) {
+  const auto path = makeTriangle();
+  auto copy = path;
+  copy.lineTo(20, 20);
+  EXPECT_FALSE(path.shared());
+  EXPECT_FALSE(copy.shared());
+  EXPECT_NE(path.points().data(), copy.points().data());
+  EXPECT_EQ(path, makeTriangle());
+  EXPECT_EQ(path.points().size(), 3U);
+  EXPECT_EQ(copy.points().size(), 4U);
+}
+
+TEST(PathTest, AssignmentSharesStorage) {
+  const auto path = makeTriangle();
+  Path2d other;
+  other.moveTo(5, 5);
+  const auto generation = other.generation();
+  other = path;
+  EXPECT_TRUE(path.shared());
+  EXPECT_EQ(path.points().data(), other.points().data());
+  EXPECT_NE(other.generation(), generation);
+}
+
+TEST(PathTest, CachesResetPerCopy) {
+  const auto path = makeTriangle();
+  const auto bounds = path.bounds();
+  const auto hash = path.hash();
+  auto copy = path;
+  EXPECT_EQ(copy.bounds(), bounds);
+  EXPECT_EQ(copy.hash(), hash);
+  const auto generation = copy.generation();
+  copy.setPoint(1, Vec2d(30, 0));
+  EXPECT_NE(copy.generation(), generation);
+  EXPECT_EQ(copy.bounds().maxX(), 30);
+  EXPECT_NE(copy.hash(), hash);
+  EXPECT_EQ(path.bounds(), bounds);
+  EXPECT_EQ(path.bounds().maxX(), 10);
+  EXPECT_EQ(path.hash(), hash);
+}
+
+TEST(PathTest, CopyToOtherResourceDoesNotShare) {
+  ArenaResource resource;
+  const auto path = makeTriangle();
+  const Path2d copy(path, Path2d::allocator_type(&resource));
+  EXPECT_FALSE(path.shared());
+  EXPECT_FALSE(copy.shared());
+  EXPECT_NE(path.points().data(), copy.points().data());
+  EXPECT_EQ(path, copy);
+}
+
+TEST(PathTest, SetCommand) {
+  Path2d path;
+  path.moveTo(0, 0);
+  path.lineTo(10, 0);
+  path.conicTo(10, 10, 0, 10, 0.5);
+  path.lineTo(5, 5);
+  path.setCommand(1, Command2d(CommandType::CUBIC,
+                               Vec2d(1, 1), Vec2d(2, 2), Vec2d(20, 0)));
+  path.setCommand(2, Command2d(CommandType::LINE, Vec2d(0, 10)));
+  path.setCommand(3, Command2d(CommandType::CONIC,
+                               Vec2d(3, 3), Vec2d(6, 6), 0.25));
+  path.setPoint(0, Vec2d(-1, -1));
+  Path2d expected;
+  expected.moveTo(-1, -1);
+  expected.cubicTo(1, 1, 2, 2, 20, 0);
+  expected.lineTo(0, 10);
+  expected.conicTo(3, 3, 6, 6, 0.25);
+  EXPECT_EQ(path, expected);
+  EXPECT_EQ(path.points().size(), expected.points().size());
+  EXPECT_EQ(path.weights().size(), 1U);
+}
+
+TEST(PathTest, ContainsCircle) {
+  // A circle of radius 40 made of four conics
+  const auto weight = std::sqrt(2.0) / 2;
+  Path2d path;
+  path.moveTo(90, 50);
+  path.conicTo(90, 90, 50, 90, weight);
+  path.conicTo(10, 90, 10, 50, weight);
+  path.conicTo(10, 10, 50, 10, weight);
+  path.conicTo(90, 10, 90, 50, weight);
+  const SegmentIndex2<double> index(path.verbs(), path.points(),
+                                    path.weights());
+  for (double y{0.5}; y < 100; y += 1.25) {
+    for (double x{0.5}; x < 100; x += 1.25) {
+      const auto distance = std::hypot(x - 50, y - 50);
+      if (std::abs(distance - 40) < 1e-3) {
+        continue;
+      }
+      const Vec2d point(x, y);
+      EXPECT_EQ(path.contains(point), distance < 40) << x << ", " << y;
+      EXPECT_EQ(std::abs(path.winding(point)), distance < 40 ? 1 : 0);
+      EXPECT_EQ(index.winding(point), path.winding(point));
+    }
+  }
+}
+
+TEST(PathTest, WindingOnJointRows) {
+  // Rows through vertices must count each crossing once, whether the
+  // contour passes through the vertex or turns back at it.
+  Path2d diamond;
+  diamond.moveTo(0, 5);
+  diamond.lineTo(5, 0);
+  diamond.lineTo(10, 5);
+  diamond.lineTo(5, 10);
+  diamond.close();
+  EXPECT_EQ(std::abs(diamond.winding(Vec2d(5, 5))), 1);
+  EXPECT_EQ(diamond.winding(Vec2d(-1, 5)), 0);
+  EXPECT_EQ(diamond.winding(Vec2d(11, 5)), 0);
+  EXPECT_EQ(diamond.winding(Vec2d(3, 0)), 0);
+  EXPECT_EQ(diamond.winding(Vec2d(5, 11)), 0);
+
+  Path2d zigzag;
+  zigzag.moveTo(0, 0);
+  zigzag.lineTo(4, 4);
+  zigzag.lineTo(8, 0);
+  zigzag.lineTo(12, 4);
+  zigzag.lineTo(12, 8);
+  zigzag.lineTo(0, 8);
+  zigzag.close();
+  EXPECT_EQ(zigzag.winding(Vec2d(-1, 4)), 0);
+  EXPECT_EQ(std::abs(zigzag.winding(Vec2d(2, 4))), 1);
+  EXPECT_EQ(std::abs(zigzag.winding(Vec2d(6, 4))), 1);
+  EXPECT_EQ(zigzag.winding(Vec2d(4, 2)), 0);
+  EXPECT_EQ(zigzag.winding(Vec2d(-1, 0)), 0);
+  EXPECT_TRUE(zigzag.contains(Vec2d(8, 2), FillRule::EVEN_ODD));
+}
+
 }  // namespace graphics
 }  // namespace shotamatsuda
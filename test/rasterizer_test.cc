@@ -0,0 +1,237 @@
+//
+//  rasterizer_test.cc
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "shotamatsuda/graphics/fill_rule.h"
+#include "shotamatsuda/graphics/rasterizer.h"
+#include "shotamatsuda/graphics/shape.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+namespace {
+
+struct Box {
+  double x0;
+  double y0;
+  double x1;
+  double y1;
+};
+
+void addBox(const Box& box, Shape2f *shape) {
+  shape->moveTo(box.x0, box.y0);
+  shape->lineTo(box.x1, box.y0);
+  shape->lineTo(box.x1, box.y1);
+  shape->lineTo(box.x0, box.y1);
+  shape->close();
+}
+
+double overlap(double a0, double a1, double b0, double b1) {
+  return std::max(0.0, std::min(a1, b1) - std::max(a0, b0));
+}
+
+// Exact coverage of boxes of the same direction, following the fill rule in
+// the way the rasterizer folds accumulated area.
+std::vector<std::uint8_t> expectedCoverage(const std::vector<Box>& boxes,
+                                           FillRule rule,
+                                           int width,
+                                           int height) {
+  std::vector<std::uint8_t> result;
+  for (int y{}; y < height; ++y) {
+    for (int x{}; x < width; ++x) {
+      double area{};
+      for (const auto& box : boxes) {
+        area += (overlap(x, x + 1, box.x0, box.x1) *
+                 overlap(y, y + 1, box.y0, box.y1));
+      }
+      if (rule == FillRule::EVEN_ODD) {
+        area = 1 - std::abs(1 - std::fmod(area, 2));
+      } else {
+        area = std::min(area, 1.0);
+      }
+      result.emplace_back(static_cast<std::uint8_t>(area * 255 + 0.5));
+    }
+  }
+  return result;
+}
+
+// Area of a convex polygon inside the pixel at the given coordinates, found
+// by clipping the polygon to each edge of the pixel in turn.
+double pixelArea(std::vector<Vec2d> polygon, int x, int y) {
+  const auto clip = [&polygon](int axis, double bound, double sign) {
+    std::vector<Vec2d> result;
+    for (std::size_t i{}; i < polygon.size(); ++i) {
+      const auto& a = polygon[i];
+      const auto& b = polygon[(i + 1) % polygon.size()];
+      const auto da = (a[axis] - bound) * sign;
+      const auto db = (b[axis] - bound) * sign;
+      if (da >= 0) {
+        result.emplace_back(a);
+      }
+      if ((da < 0) != (db < 0)) {
+        result.emplace_back(a + (b - a) * (da / (da - db)));
+      }
+    }
+    polygon.swap(result);
+  };
+  clip(0, x, 1);
+  clip(0, x + 1, -1);
+  clip(1, y, 1);
+  clip(1, y + 1, -1);
+  double area{};
+  for (std::size_t i{}; i < polygon.size(); ++i) {
+    area += polygon[i].cross(polygon[(i + 1) % polygon.size()]);
+  }
+  return std::abs(area) / 2;
+}
+
+int maxDifference(const std::vector<std::uint8_t>& lhs,
+                  const std::vector<std::uint8_t>& rhs) {
+  EXPECT_EQ(lhs.size(), rhs.size());
+  int result{};
+  for (std::size_t i{}; i < std::min(lhs.size(), rhs.size()); ++i) {
+    result = std::max(result, std::abs(lhs[i] - rhs[i]));
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(RasterizerTest, FractionalRectangle) {
+  const std::vector<Box> boxes{{2.25, 1.5, 13.75, 6.125}};
+  Shape2f shape;
+  addBox(boxes.front(), &shape);
+  Rasterizer2f rasterizer(19, 9);
+  for (const auto rule : {FillRule::NON_ZERO, FillRule::EVEN_ODD}) {
+    EXPECT_LE(maxDifference(rasterizer.rasterize(shape, rule),
+                            expectedCoverage(boxes, rule, 19, 9)), 1);
+  }
+}
+
+TEST(RasterizerTest, OverlappingRectangles) {
+  const std::vector<Box> boxes{
+    {1.5, 1.25, 12.5, 7.75},
+    {6.75, 3.5, 17.25, 10.5},
+  };
+  Shape2f shape;
+  for (const auto& box : boxes) {
+    addBox(box, &shape);
+  }
+  Rasterizer2f rasterizer(19, 12);
+  for (const auto rule : {FillRule::NON_ZERO, FillRule::EVEN_ODD}) {
+    EXPECT_LE(maxDifference(rasterizer.rasterize(shape, rule),
+                            expectedCoverage(boxes, rule, 19, 12)), 1);
+  }
+  const auto even_odd = rasterizer.rasterize(FillRule::EVEN_ODD);
+  EXPECT_EQ(even_odd[5 * 19 + 10], 0);
+  EXPECT_EQ(even_odd[2 * 19 + 3], 255);
+}
+
+TEST(RasterizerTest, ClipsToMask) {
+  // Parts to the left of the mask still cover it, while parts above, below
+  // and to the right of it are dropped.
+  const std::vector<Box> boxes{{-5.5, -3.25, 25.75, 4.5}};
+  Shape2f shape;
+  addBox(boxes.front(), &shape);
+  Rasterizer2f rasterizer(21, 7);
+  for (const auto rule : {FillRule::NON_ZERO, FillRule::EVEN_ODD}) {
+    EXPECT_LE(maxDifference(rasterizer.rasterize(shape, rule),
+                            expectedCoverage(boxes, rule, 21, 7)), 1);
+  }
+}
+
+TEST(RasterizerTest, SlantedTriangle) {
+  // Edges that cross several pixels per row, in both directions
+  const std::vector<Vec2d> triangle{{1.3, 0.7}, {23.6, 5.2}, {6.1, 17.9}};
+  Shape2f shape;
+  shape.moveTo(triangle[0].x, triangle[0].y);
+  shape.lineTo(triangle[1].x, triangle[1].y);
+  shape.lineTo(triangle[2].x, triangle[2].y);
+  shape.close();
+  Rasterizer2f rasterizer(25, 19);
+  std::vector<std::uint8_t> expected;
+  for (int y{}; y < 19; ++y) {
+    for (int x{}; x < 25; ++x) {
+      expected.emplace_back(static_cast<std::uint8_t>(
+          pixelArea(triangle, x, y) * 255 + 0.5));
+    }
+  }
+  for (const auto rule : {FillRule::NON_ZERO, FillRule::EVEN_ODD}) {
+    EXPECT_LE(maxDifference(rasterizer.rasterize(shape, rule), expected), 1);
+  }
+}
+
+TEST(RasterizerTest, CircleArea) {
+  const auto weight = std::sqrt(0.5f);
+  const auto radius = 28.f;
+  Shape2f shape;
+  shape.moveTo(32 + radius, 32);
+  shape.conicTo(32 + radius, 32 + radius, 32, 32 + radius, weight);
+  shape.conicTo(32 - radius, 32 + radius, 32 - radius, 32, weight);
+  shape.conicTo(32 - radius, 32 - radius, 32, 32 - radius, weight);
+  shape.conicTo(32 + radius, 32 - radius, 32 + radius, 32, weight);
+  Rasterizer2f rasterizer(64, 64);
+  const auto mask = rasterizer.rasterize(shape, FillRule::NON_ZERO,
+                                         Flattener2f(0.01f));
+  double area{};
+  for (const auto coverage : mask) {
+    area += coverage / 255.0;
+  }
+  EXPECT_NEAR(area, std::acos(-1.0) * radius * radius, 1);
+}
+
+TEST(RasterizerTest, OffCanvasVertices) {
+  // Nearly horizontal edges that reach far outside the mask. Splitting them
+  // at the edges of the mask by their y would lose the x of the split.
+  const std::vector<Box> boxes{
+    {10, 10, 1e12, 30},
+    {-1e12, 40, 50, 60},
+  };
+  Shape2d shape;
+  shape.moveTo(10, 10);
+  shape.lineTo(5e9, 20);
+  shape.lineTo(10, 30);
+  shape.close();
+  shape.moveTo(50, 40);
+  shape.lineTo(-5e9, 45);
+  shape.lineTo(50, 60);
+  shape.close();
+  Rasterizer2d rasterizer(64, 64);
+  for (const auto rule : {FillRule::NON_ZERO, FillRule::EVEN_ODD}) {
+    EXPECT_LE(maxDifference(rasterizer.rasterize(shape, rule),
+                            expectedCoverage(boxes, rule, 64, 64)), 1);
+  }
+}
+
+}  // namespace graphics
+}  // namespace shotamatsuda
@@ -26,10 +26,133 @@
 
 #include "gtest/gtest.h"
 
+#include <list>
+#include <random>
+
+#include "shotamatsuda/graphics/fill_rule.h"
 #include "shotamatsuda/graphics/shape.h"
 
 namespace shotamatsuda {
 namespace graphics {
 
+TEST(ShapeTest, HashFollowsMutation) {
+  Shape2d shape;
+  shape.moveTo(0, 0);
+  shape.lineTo(10, 0);
+  shape.lineTo(0, 10);
+  shape.close();
+  const auto first = shape.hash();
+  EXPECT_EQ(shape.hash(), first);
+  shape.moveTo(20, 20);
+  shape.lineTo(30, 20);
+  const auto second = shape.hash();
+  EXPECT_NE(second, first);
+  shape.lineTo(30, 30);
+  const auto third = shape.hash();
+  EXPECT_NE(third, second);
+  shape.front().setPoint(1, Vec2d(15, 0));
+  EXPECT_NE(shape.hash(), third);
+  Shape2d copy(std::list<Path2d>(std::begin(shape.paths()),
+                                 std::end(shape.paths())));
+  EXPECT_EQ(copy.hash(), shape.hash());
+  EXPECT_EQ(std::hash<Shape2d>()(copy), shape.hash());
+}
+
+namespace {
+
+// Builds paths whose commands land within the threshold of 0.01 from the
+// previous point at random, and adds each path twice when sharing, so that
+// the copy shares storage with the original.
+Shape2d makeNoisyShape(int paths, bool sharing) {
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<double> coordinate(0, 100);
+  std::uniform_real_distribution<double> jitter(0, 0.02);
+  std::bernoulli_distribution duplicate(0.3);
+  Shape2d shape;
+  for (int i{}; i < paths; ++i) {
+    auto& path = shape.addPath(Path2d());
+    Vec2d point(coordinate(engine), coordinate(engine));
+    path.moveTo(point);
+    for (int j{}; j < 16; ++j) {
+      if (duplicate(engine)) {
+        point = point + Vec2d(jitter(engine), jitter(engine));
+      } else {
+        point = Vec2d(coordinate(engine), coordinate(engine));
+      }
+      if (j % 3) {
+        path.lineTo(point);
+      } else {
+        path.quadraticTo(Vec2d(coordinate(engine), coordinate(engine)),
+                         point);
+      }
+    }
+    path.close();
+    if (sharing) {
+      shape.addPath(Path2d(shape.back()));
+    }
+  }
+  return shape;
+}
+
+}  // namespace
+
+TEST(ShapeTest, ConcurrentRemoveDuplicates) {
+  const auto shape = makeNoisyShape(1000, false);
+  ASSERT_EQ(shape.size(), 1000U);
+  auto expected = makeNoisyShape(1000, false);
+  auto actual = makeNoisyShape(1000, false);
+  EXPECT_FALSE(actual.front().shared());
+  EXPECT_TRUE(expected.removeDuplicates(0.01));
+  EXPECT_TRUE(actual.removeDuplicates(0.01, 4));
+  EXPECT_EQ(actual, expected);
+  EXPECT_NE(actual, shape);
+  EXPECT_FALSE(actual.removeDuplicates(0.01, 4));
+}
+
+TEST(ShapeTest, ConcurrentRemoveDuplicatesFromSharedPaths) {
+  auto expected = makeNoisyShape(500, true);
+  auto actual = makeNoisyShape(500, true);
+  ASSERT_EQ(actual.size(), 1000U);
+  EXPECT_TRUE(actual.front().shared());
+  EXPECT_TRUE(expected.removeDuplicates(0.01));
+  EXPECT_TRUE(actual.removeDuplicates(0.01, 4));
+  EXPECT_EQ(actual, expected);
+  EXPECT_EQ(actual.front(), *std::next(std::begin(actual.paths())));
+}
+
+TEST(ShapeTest, ContainsHole) {
+  Shape2d shape;
+  shape.moveTo(0, 0);
+  shape.lineTo(30, 0);
+  shape.lineTo(30, 30);
+  shape.lineTo(0, 30);
+  shape.close();
+  auto& hole = shape.addPath(Path2d());
+  hole.moveTo(10, 10);
+  hole.lineTo(20, 10);
+  hole.lineTo(20, 20);
+  hole.lineTo(10, 20);
+  hole.close();
+  const Vec2d ring(5, 15);
+  const Vec2d inside(15, 15);
+  const Vec2d outside(35, 15);
+
+  // Contours of the same direction add up
+  EXPECT_EQ(std::abs(shape.winding(inside)), 2);
+  EXPECT_EQ(std::abs(shape.winding(ring)), 1);
+  EXPECT_EQ(shape.winding(outside), 0);
+  EXPECT_TRUE(shape.contains(inside, FillRule::NON_ZERO));
+  EXPECT_FALSE(shape.contains(inside, FillRule::EVEN_ODD));
+  EXPECT_TRUE(shape.contains(ring, FillRule::EVEN_ODD));
+  EXPECT_FALSE(shape.contains(outside, FillRule::NON_ZERO));
+
+  // Reversing the inner contour cuts a hole for either rule
+  shape.back().reverse();
+  EXPECT_EQ(shape.winding(inside), 0);
+  EXPECT_FALSE(shape.contains(inside, FillRule::NON_ZERO));
+  EXPECT_FALSE(shape.contains(inside, FillRule::EVEN_ODD));
+  EXPECT_TRUE(shape.contains(ring, FillRule::NON_ZERO));
+}
+
 }  // namespace graphics
 }  // namespace shotamatsuda
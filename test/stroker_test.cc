@@ -0,0 +1,205 @@
+//
+//  stroker_test.cc
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <numeric>
+
+#include "shotamatsuda/graphics/fill_rule.h"
+#include "shotamatsuda/graphics/flattener.h"
+#include "shotamatsuda/graphics/path.h"
+#include "shotamatsuda/graphics/path_direction.h"
+#include "shotamatsuda/graphics/rasterizer.h"
+#include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/graphics/stroke_cap.h"
+#include "shotamatsuda/graphics/stroke_join.h"
+#include "shotamatsuda/graphics/stroker.h"
+#include "shotamatsuda/math/vector.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+namespace {
+
+const auto pi = std::acos(-1.0);
+
+// Returns the area the shape covers under the nonzero rule, which is the
+// area of the union of its overlapping pieces. Curves are flattened finely
+// enough for arcs to lose little of their area.
+double coveredArea(const Shape2d& shape) {
+  Rasterizer2d rasterizer(64, 64);
+  const auto coverage = rasterizer.rasterize(shape, FillRule::NON_ZERO,
+                                             Flattener2d(0.01));
+  return std::accumulate(coverage.begin(), coverage.end(), 0.0) / 255;
+}
+
+// A path of two legs of 30, turning by a right angle at (40, 10), whose
+// stroke has an outer corner at (45, 5).
+Path2d makeCorner() {
+  Path2d path;
+  path.moveTo(10, 10);
+  path.lineTo(40, 10);
+  path.lineTo(40, 40);
+  return path;
+}
+
+Shape2d stroke(const Path2d& path, const Stroker2d& stroker) {
+  Shape2d result;
+  Stroker2d(stroker).stroke(path, &result);
+  return result;
+}
+
+bool contains(const Shape2d& shape, double x, double y) {
+  return shape.contains(Vec2d(x, y), FillRule::NON_ZERO);
+}
+
+}  // namespace
+
+TEST(StrokerTest, Joins) {
+  const auto path = makeCorner();
+  // The legs cover 575 together, and the joins add a square of 25, a quarter
+  // of a circle of radius 5, and half of the square.
+  const auto legs = 575.0;
+  const auto miter = stroke(path, Stroker2d(10, StrokeJoin::MITER));
+  EXPECT_NEAR(coveredArea(miter), legs + 25, 0.1);
+  EXPECT_TRUE(contains(miter, 44.5, 5.5));
+  const auto round = stroke(path, Stroker2d(10, StrokeJoin::ROUND));
+  EXPECT_NEAR(coveredArea(round), legs + pi * 25 / 4, 0.1);
+  EXPECT_TRUE(contains(round, 43, 7));
+  EXPECT_FALSE(contains(round, 44, 6));
+  const auto bevel = stroke(path, Stroker2d(10, StrokeJoin::BEVEL));
+  EXPECT_NEAR(coveredArea(bevel), legs + 12.5, 0.1);
+  EXPECT_TRUE(contains(bevel, 41.5, 7.5));
+  EXPECT_FALSE(contains(bevel, 43, 7));
+  for (const auto& shape : {miter, round, bevel}) {
+    EXPECT_EQ(shape.size(), 1U);
+    EXPECT_TRUE(contains(shape, 25, 10));
+    EXPECT_TRUE(contains(shape, 40, 25));
+    EXPECT_FALSE(contains(shape, 25, 20));
+    EXPECT_FALSE(contains(shape, 46, 10));
+  }
+}
+
+TEST(StrokerTest, MiterLimit) {
+  // A right angle extends the miter by the square root of 2 times the radius,
+  // falling back to a bevel under a lower limit.
+  const auto path = makeCorner();
+  const auto miter = stroke(
+      path, Stroker2d(10, StrokeJoin::MITER, StrokeCap::BUTT, 1.42));
+  EXPECT_NEAR(coveredArea(miter), 600, 0.1);
+  EXPECT_TRUE(contains(miter, 44.5, 5.5));
+  const auto bevel = stroke(
+      path, Stroker2d(10, StrokeJoin::MITER, StrokeCap::BUTT, 1.41));
+  EXPECT_NEAR(coveredArea(bevel), 587.5, 0.1);
+  EXPECT_FALSE(contains(bevel, 44.5, 5.5));
+}
+
+TEST(StrokerTest, Caps) {
+  Path2d path;
+  path.moveTo(10, 20);
+  path.lineTo(50, 20);
+  Stroker2d stroker(10);
+  stroker.setCap(StrokeCap::BUTT);
+  const auto butt = stroke(path, stroker);
+  EXPECT_NEAR(coveredArea(butt), 400, 0.1);
+  EXPECT_TRUE(contains(butt, 11, 24));
+  EXPECT_FALSE(contains(butt, 9, 20));
+  EXPECT_FALSE(contains(butt, 51, 20));
+  stroker.setCap(StrokeCap::SQUARE);
+  const auto square = stroke(path, stroker);
+  EXPECT_NEAR(coveredArea(square), 500, 0.1);
+  EXPECT_TRUE(contains(square, 6, 24));
+  EXPECT_TRUE(contains(square, 54, 16));
+  EXPECT_FALSE(contains(square, 56, 20));
+  stroker.setCap(StrokeCap::ROUND);
+  const auto round = stroke(path, stroker);
+  EXPECT_NEAR(coveredArea(round), 400 + pi * 25, 0.1);
+  EXPECT_TRUE(contains(round, 6, 20));
+  EXPECT_TRUE(contains(round, 53, 23));
+  EXPECT_FALSE(contains(round, 6, 24));
+  EXPECT_FALSE(contains(round, 54, 16));
+  for (const auto& shape : {butt, square, round}) {
+    EXPECT_EQ(shape.size(), 1U);
+  }
+}
+
+TEST(StrokerTest, ClosedContour) {
+  // A closed contour has no caps, and becomes a ring of two paths wound in
+  // opposite directions, leaving the inside unfilled.
+  Path2d path;
+  path.moveTo(10, 10);
+  path.lineTo(50, 10);
+  path.lineTo(50, 50);
+  path.lineTo(10, 50);
+  path.close();
+  Stroker2d stroker(4, StrokeJoin::MITER, StrokeCap::ROUND);
+  const auto shape = stroke(path, stroker);
+  ASSERT_EQ(shape.size(), 2U);
+  const auto outer = shape.front().direction();
+  const auto inner = shape.back().direction();
+  EXPECT_NE(outer, PathDirection::UNDEFINED);
+  EXPECT_NE(inner, PathDirection::UNDEFINED);
+  EXPECT_NE(outer, inner);
+  EXPECT_NEAR(coveredArea(shape), 44 * 44 - 36 * 36, 0.1);
+  EXPECT_TRUE(contains(shape, 8.5, 8.5));
+  EXPECT_TRUE(contains(shape, 10, 30));
+  EXPECT_TRUE(contains(shape, 51.5, 51.5));
+  EXPECT_FALSE(contains(shape, 30, 30));
+  EXPECT_FALSE(contains(shape, 12.5, 12.5));
+  EXPECT_FALSE(contains(shape, 7, 30));
+}
+
+TEST(StrokerTest, ZeroLengthDot) {
+  // A contour of zero length is drawn as its caps alone, and nothing with
+  // butt caps.
+  Path2d path;
+  path.moveTo(20, 20);
+  path.lineTo(20, 20);
+  Stroker2d stroker(10);
+  stroker.setCap(StrokeCap::ROUND);
+  const auto round = stroke(path, stroker);
+  ASSERT_EQ(round.size(), 1U);
+  EXPECT_NEAR(coveredArea(round), pi * 25, 0.1);
+  EXPECT_TRUE(contains(round, 23, 23));
+  EXPECT_FALSE(contains(round, 24, 24));
+  stroker.setCap(StrokeCap::SQUARE);
+  const auto square = stroke(path, stroker);
+  ASSERT_EQ(square.size(), 1U);
+  EXPECT_NEAR(coveredArea(square), 100, 0.1);
+  EXPECT_TRUE(contains(square, 24, 24));
+  stroker.setCap(StrokeCap::BUTT);
+  EXPECT_TRUE(stroke(path, stroker).empty());
+
+  // A lone move is not a contour of zero length.
+  Path2d point;
+  point.moveTo(20, 20);
+  stroker.setCap(StrokeCap::ROUND);
+  EXPECT_TRUE(stroke(point, stroker).empty());
+}
+
+}  // namespace graphics
+}  // namespace shotamatsuda
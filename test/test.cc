@@ -31,12 +31,36 @@
 namespace shotamatsuda {
 namespace graphics {
 
+template class Cache<float>;
 template class Color<float, 3>;
 template class Color<float, 4>;
 template class Shape<float, 2>;
 template class Path<float, 2>;
+template class PathIterator<float, 2>;
+template class PathMeasure<float, 2>;
+template class PathPool<float, 2>;
+template class Polylines<float, 2>;
+template class ReversedPathIterator<float, 2>;
+template class ReversedPathView<float, 2>;
+template class CommandView<float, 2>;
 template class Command<float, 2>;
 template class Conic<float, 2>;
+template class ConicPacket<float, 2>;
+template class ConicSubdivider<float, 2>;
+template class CurveBounds<float, 2>;
+template class CurveMeasure<float, 2>;
+template class CurveStepper<float, 2>;
+template class Dasher<float, 2>;
+template class Flattener<float, 2>;
+template class FlatteningIterator<Path2<float>::ConstIterator>;
+template class FlatteningView<Path2<float>::ConstIterator>;
+template class LinearGradient<float, 2>;
+template class Painter<float, 2>;
+template class PolymorphicAllocator<float>;
+template class Rasterizer<float, 2>;
+template class SegmentIndex<float, 2>;
+template class Stroker<float, 2>;
+template class TiledRasterizer<float, 2>;
 
 }  // namespace graphics
 }  // namespace shotamatsuda
@@ -0,0 +1,169 @@
+//
+//  tiled_rasterizer_test.cc
+//
+//  The MIT License
+//
+//  Copyright (C) 2013-2017 Shota Matsuda
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "shotamatsuda/graphics/coverage_spans.h"
+#include "shotamatsuda/graphics/fill_rule.h"
+#include "shotamatsuda/graphics/rasterizer.h"
+#include "shotamatsuda/graphics/shape.h"
+#include "shotamatsuda/graphics/thread_pool.h"
+#include "shotamatsuda/graphics/tiled_rasterizer.h"
+
+namespace shotamatsuda {
+namespace graphics {
+
+namespace {
+
+void addBox(float x0, float y0, float x1, float y1, Shape2f *shape) {
+  shape->moveTo(x0, y0);
+  shape->lineTo(x1, y0);
+  shape->lineTo(x1, y1);
+  shape->lineTo(x0, y1);
+  shape->close();
+}
+
+int maxDifference(const std::vector<std::uint8_t>& lhs,
+                  const std::vector<std::uint8_t>& rhs) {
+  EXPECT_EQ(lhs.size(), rhs.size());
+  int result{};
+  for (std::size_t i{}; i < std::min(lhs.size(), rhs.size()); ++i) {
+    result = std::max(result, std::abs(lhs[i] - rhs[i]));
+  }
+  return result;
+}
+
+// Renders the shape with both rasterizers under both fill rules, and expects
+// the tiles to agree with a single mask within one level, and rendering on a
+// thread pool to agree with rendering serially exactly.
+template <class T>
+void expectMatchesRasterizer(const Shape2<T>& shape,
+                             int width,
+                             int height,
+                             int tile_size) {
+  Rasterizer2<T> rasterizer(width, height);
+  TiledRasterizer2<T> tiled(width, height, tile_size);
+  tiled.addShape(shape);
+  ThreadPool pool(4);
+  for (const auto rule : {FillRule::NON_ZERO, FillRule::EVEN_ODD}) {
+    const auto expected = rasterizer.rasterize(shape, rule);
+    const auto serial = tiled.rasterize(rule);
+    EXPECT_LE(maxDifference(serial, expected), 1);
+    EXPECT_EQ(tiled.rasterize(rule, &pool), serial);
+  }
+}
+
+}  // namespace
+
+TEST(TiledRasterizerTest, MatchesRasterizer) {
+  Shape2f shape;
+  addBox(-3.5, 2.25, 30.75, 9.5, &shape);
+  addBox(10.25, -4.5, 14.5, 40.25, &shape);
+  addBox(20.125, 20.375, 37.875, 33.625, &shape);
+  shape.moveTo(3.3, 12.1);
+  shape.lineTo(17.8, 30.6);
+  shape.conicTo(2, 34, 1.2, 20, 0.6);
+  shape.close();
+  expectMatchesRasterizer(shape, 37, 35, 8);
+}
+
+TEST(TiledRasterizerTest, BackdropFillsEmptyTiles) {
+  // Tiles inside the outer box and inside the hole have no lines, and are
+  // filled from the edges to their left alone.
+  Shape2f shape;
+  addBox(2.5, 3.25, 250, 120.75, &shape);
+  addBox(60.5, 40.25, 200.5, 90.75, &shape);
+  shape.back().reverse();
+  TiledRasterizer2f tiled(256, 128, 16);
+  tiled.addShape(shape);
+  for (const auto rule : {FillRule::NON_ZERO, FillRule::EVEN_ODD}) {
+    const auto mask = tiled.rasterize(rule);
+    EXPECT_EQ(mask[20 * 256 + 100], 255);
+    EXPECT_EQ(mask[100 * 256 + 230], 255);
+    EXPECT_EQ(mask[64 * 256 + 40], 255);
+    EXPECT_EQ(mask[64 * 256 + 130], 0);
+    EXPECT_EQ(mask[64 * 256 + 253], 0);
+  }
+  expectMatchesRasterizer(shape, 256, 128, 16);
+}
+
+TEST(TiledRasterizerTest, OffCanvasVertices) {
+  // Coordinates far outside the range of int must neither crash nor leave
+  // coverage behind in the wrong tiles. Double precision keeps the bounds of
+  // the paths exact at this scale.
+  Shape2d shape;
+  shape.moveTo(10, 10);
+  shape.lineTo(5e9, 20);
+  shape.lineTo(10, 30);
+  shape.close();
+  shape.moveTo(50, 40);
+  shape.lineTo(-5e9, 45);
+  shape.lineTo(50, 60);
+  shape.close();
+  TiledRasterizer2d tiled(64, 64, 16);
+  tiled.addShape(shape);
+  const auto mask = tiled.rasterize(FillRule::NON_ZERO);
+  EXPECT_EQ(mask[20 * 64 + 40], 255);
+  EXPECT_EQ(mask[20 * 64 + 63], 255);
+  EXPECT_EQ(mask[50 * 64 + 0], 255);
+  EXPECT_EQ(mask[50 * 64 + 30], 255);
+  EXPECT_EQ(mask[5 * 64 + 40], 0);
+  EXPECT_EQ(mask[50 * 64 + 60], 0);
+  expectMatchesRasterizer(shape, 64, 64, 16);
+}
+
+TEST(TiledRasterizerTest, SpansMatchMask) {
+  Shape2f shape;
+  addBox(2.5, 3.25, 250, 120.75, &shape);
+  addBox(60.5, 40.25, 200.5, 90.75, &shape);
+  shape.back().reverse();
+  shape.moveTo(130.3, 10.1);
+  shape.lineTo(170.8, 110.6);
+  shape.conicTo(20, 124, 10.2, 20, 0.6);
+  shape.close();
+  TiledRasterizer2f tiled(256, 128, 16);
+  tiled.addShape(shape);
+  ThreadPool pool(4);
+  CoverageSpans spans;
+  for (const auto rule : {FillRule::NON_ZERO, FillRule::EVEN_ODD}) {
+    tiled.rasterize(rule, &spans, &pool);
+    ASSERT_EQ(spans.size(), 128U);
+    // Tiles without lines are encoded as runs, not as a cover per pixel.
+    EXPECT_LT(spans.covers().size(), 256U * 128U);
+    std::vector<std::uint8_t> decoded(256 * 128);
+    spans.fill(decoded.data(), 256);
+    EXPECT_EQ(decoded, tiled.rasterize(rule));
+  }
+}
+
+}  // namespace graphics
+}  // namespace shotamatsuda